@@ -423,5 +423,15 @@ if ((CMAKE_SYSTEM_NAME MATCHES "Android") AND LLVM_BUILD_STATIC AND
   add_definitions(-DANDROID_USE_ACCEPT_WORKAROUND)
 endif()
 
+# Compressed core files are inflated with zlib.  Use it whenever LLVM was
+# configured to.
+if (LLVM_ENABLE_ZLIB)
+  find_package(ZLIB)
+  if (ZLIB_FOUND)
+    add_definitions( -DHAVE_LIBZ=1 )
+    include_directories(${ZLIB_INCLUDE_DIRS})
+  endif()
+endif()
+
 find_package(Backtrace)
 include(LLDBGenerateConfig)
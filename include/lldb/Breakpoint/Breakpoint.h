@@ -751,7 +751,7 @@ protected:
 
   bool IgnoreCountShouldStop();
 
-  void IncrementHitCount() { m_hit_count++; }
+  void IncrementHitCount(uint32_t count = 1) { m_hit_count += count; }
 
   void DecrementHitCount() {
     assert(m_hit_count > 0);
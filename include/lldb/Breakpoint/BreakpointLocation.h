@@ -135,6 +135,18 @@ public:
   //------------------------------------------------------------------
   void SetIgnoreCount(uint32_t n);
 
+  //------------------------------------------------------------------
+  /// Account for hits that the process handled without stopping, e.g.
+  /// because a remote stub applied the ignore count itself.
+  ///
+  /// @param[in] hit_count
+  ///     The number of hits to add to this location and its breakpoint.
+  ///
+  /// @param[in] ignored_count
+  ///     How many of those hits used up an ignore count.
+  //------------------------------------------------------------------
+  void AddSkippedHits(uint32_t hit_count, uint32_t ignored_count);
+
   //------------------------------------------------------------------
   /// Set the callback action invoked when the breakpoint is hit.
   ///
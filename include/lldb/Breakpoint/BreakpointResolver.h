@@ -239,6 +239,26 @@ protected:
   void SetSCMatchesByLine(SearchFilter &, SymbolContextList &, bool,
                           const char *) = delete;
 
+  //------------------------------------------------------------------
+  /// Resolvers that search module by module can do the expensive part of
+  /// that search for many modules at once.  Before the filter drives the
+  /// search, PrefetchModule is called from several threads for every
+  /// module the filter passes, and ClearPrefetchedModules is called once
+  /// the search is done.  The locations are still added from
+  /// SearchCallback, in the filter's order, so the result doesn't depend
+  /// on which module finished first.
+  ///
+  /// PrefetchModule must not change the breakpoint.
+  //------------------------------------------------------------------
+  virtual bool CanPrefetchModules() { return false; }
+
+  virtual void PrefetchModule(SearchFilter &filter,
+                              const lldb::ModuleSP &module_sp) {}
+
+  virtual void ClearPrefetchedModules() {}
+
+  void PrefetchModules(SearchFilter &filter, const ModuleList &modules);
+
   lldb::BreakpointLocationSP AddLocation(Address loc_addr,
                                          bool *new_location = NULL);
 
@@ -12,9 +12,13 @@
 
 // C Includes
 // C++ Includes
+#include <map>
+#include <mutex>
+
 // Other libraries and framework includes
 // Project includes
 #include "lldb/Breakpoint/BreakpointResolver.h"
+#include "lldb/Symbol/SymbolContext.h"
 
 namespace lldb_private {
 
@@ -65,6 +69,18 @@ public:
 protected:
   void FilterContexts(SymbolContextList &sc_list);
 
+  // Find the line table matches in the compile units of module_sp that
+  // pass the filter.
+  void FindMatches(SearchFilter &filter, const lldb::ModuleSP &module_sp,
+                   SymbolContextList &sc_list);
+
+  bool CanPrefetchModules() override;
+
+  void PrefetchModule(SearchFilter &filter,
+                      const lldb::ModuleSP &module_sp) override;
+
+  void ClearPrefetchedModules() override;
+
   friend class Breakpoint;
   FileSpec m_file_spec;   // This is the file spec we are looking for.
   uint32_t m_line_number; // This is the line number that we are looking for.
@@ -72,6 +88,9 @@ protected:
                   // functions or not.
   bool m_skip_prologue;
   bool m_exact_match;
+  // What FindMatches found for each module PrefetchModule was called for.
+  std::mutex m_prefetched_mutex;
+  std::map<Module *, SymbolContextList> m_prefetched_matches;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(BreakpointResolverFileLine);
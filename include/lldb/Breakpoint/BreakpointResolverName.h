@@ -12,6 +12,8 @@
 
 // C Includes
 // C++ Includes
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -19,6 +21,7 @@
 // Project includes
 #include "lldb/Breakpoint/BreakpointResolver.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Symbol/SymbolContext.h"
 
 namespace lldb_private {
 
@@ -92,6 +95,21 @@ protected:
   bool m_skip_prologue;
 
   void AddNameLookup(const ConstString &name, uint32_t name_type_mask);
+
+  // Find the functions in module_sp that pass the filter and our language.
+  void FindFunctions(SearchFilter &filter, const lldb::ModuleSP &module_sp,
+                     SymbolContextList &func_list);
+
+  bool CanPrefetchModules() override;
+
+  void PrefetchModule(SearchFilter &filter,
+                      const lldb::ModuleSP &module_sp) override;
+
+  void ClearPrefetchedModules() override;
+
+  // What FindFunctions found for each module PrefetchModule was called for.
+  std::mutex m_prefetched_mutex;
+  std::map<Module *, SymbolContextList> m_prefetched_functions;
 };
 
 } // namespace lldb_private
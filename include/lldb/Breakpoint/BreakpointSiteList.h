@@ -14,7 +14,9 @@
 // C++ Includes
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 // Other libraries and framework includes
 // Project includes
@@ -157,6 +159,17 @@ public:
   bool FindInRange(lldb::addr_t lower_bound, lldb::addr_t upper_bound,
                    BreakpointSiteList &bp_site_list) const;
 
+  //------------------------------------------------------------------
+  /// Call \a callback for each breakpoint site that overlaps the range
+  /// [\a lower_bound, \a upper_bound), in address order.
+  ///
+  /// Unlike FindInRange this doesn't make a new list, so it is cheap
+  /// enough to do on every memory read and write.
+  //------------------------------------------------------------------
+  void ForEachInRange(lldb::addr_t lower_bound, lldb::addr_t upper_bound,
+                      std::function<void(BreakpointSite *)> const &callback)
+      const;
+
   typedef void (*BreakpointSiteSPMapFunc)(lldb::BreakpointSiteSP &bp,
                                           void *baton);
 
@@ -194,12 +207,27 @@ public:
 protected:
   typedef std::map<lldb::addr_t, lldb::BreakpointSiteSP> collection;
 
+  // The sites sorted by address in flat arrays, which lookups by address
+  // binary search without taking m_mutex.  A snapshot is never changed once
+  // it is made, changes to the list make the next lookup build a new one.
+  struct Snapshot {
+    std::vector<lldb::addr_t> addrs;
+    std::vector<lldb::BreakpointSiteSP> sites;
+  };
+  typedef std::shared_ptr<const Snapshot> SnapshotSP;
+
   collection::iterator GetIDIterator(lldb::break_id_t breakID);
 
   collection::const_iterator GetIDConstIterator(lldb::break_id_t breakID) const;
 
+  SnapshotSP GetSnapshot() const;
+
+  void InvalidateSnapshot();
+
   mutable std::recursive_mutex m_mutex;
   collection m_bp_site_list; // The breakpoint site list.
+  // Only accessed with std::atomic_load and std::atomic_store.
+  mutable SnapshotSP m_snapshot_sp;
 };
 
 } // namespace lldb_private
@@ -84,7 +84,7 @@ protected:
 
   // If you override this, be sure to call the base class to increment the
   // internal counter.
-  void IncrementHitCount() { ++m_hit_count; }
+  void IncrementHitCount(uint32_t count = 1) { m_hit_count += count; }
 
   void DecrementHitCount();
 
@@ -30,11 +30,13 @@
 #include "llvm/Support/Chrono.h"
 
 #include <atomic>
+#include <map>
 #include <memory> // for enable_shared_from_this
 #include <mutex>
 #include <stddef.h> // for size_t
 #include <stdint.h> // for uint32_t, uint64_t
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace lldb_private {
@@ -666,6 +668,49 @@ public:
 
   lldb::CompUnitSP GetCompileUnitAtIndex(size_t idx);
 
+  //------------------------------------------------------------------
+  /// Check whether any compile unit in this module might have line
+  /// table entries for \a file_spec, without resolving any lines.
+  ///
+  /// The file names of the support files of every compile unit are
+  /// gathered into a set the first time this is called.
+  ///
+  /// @return
+  ///     False if no support file of any compile unit has the file
+  ///     name of \a file_spec, true otherwise.
+  //------------------------------------------------------------------
+  bool MightContainSourceFile(const FileSpec &file_spec);
+
+  //------------------------------------------------------------------
+  /// Find or remember the disassembly of a range of this module's code.
+  ///
+  /// Instructions decoded from the object file contents can't change
+  /// for the lifetime of the module, so clients that disassemble the
+  /// same ranges over and over (the stepping thread plans do this on
+  /// every stop) can share the decoded instructions.
+  ///
+  /// @param[in] file_addr
+  ///     The file address of the start of the range.
+  ///
+  /// @param[in] byte_size
+  ///     The size in bytes of the range.
+  ///
+  /// @param[in] key
+  ///     A string identifying the architecture, flavor and plug-in
+  ///     the range was disassembled with.
+  ///
+  /// @return
+  ///     The cached disassembler, or an empty shared pointer if the
+  ///     range hasn't been cached.
+  //------------------------------------------------------------------
+  lldb::DisassemblerSP GetCachedDisassembly(lldb::addr_t file_addr,
+                                            lldb::addr_t byte_size,
+                                            llvm::StringRef key);
+
+  void CacheDisassembly(lldb::addr_t file_addr, lldb::addr_t byte_size,
+                        llvm::StringRef key,
+                        const lldb::DisassemblerSP &disasm_sp);
+
   const ConstString &GetObjectName() const;
 
   uint64_t GetObjectOffset() const { return m_object_offset; }
@@ -1170,6 +1215,15 @@ protected:
   std::atomic<bool> m_did_load_objfile{false};
   std::atomic<bool> m_did_load_symbol_vendor{false};
   std::atomic<bool> m_did_parse_uuid{false};
+  bool m_did_index_source_files = false;
+  llvm::DenseSet<const char *>
+      m_source_file_names; ///< The file names of the support files of all
+                           ///compile units, see MightContainSourceFile.
+  typedef std::tuple<lldb::addr_t, lldb::addr_t, std::string>
+      DisassemblyCacheKey;
+  std::mutex m_disassembly_cache_mutex;
+  std::map<DisassemblyCacheKey, lldb::DisassemblerSP>
+      m_disassembly_cache; ///< See GetCachedDisassembly.
   mutable bool m_file_has_changed : 1,
       m_first_file_changed_log : 1; /// See if the module was modified after it
                                     /// was initially opened.
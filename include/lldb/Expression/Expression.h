@@ -102,6 +102,12 @@ public:
   //------------------------------------------------------------------
   virtual bool NeedsVariableResolution() = 0;
 
+  //------------------------------------------------------------------
+  /// Return true if the expression is one of LLDB's own helpers, whose
+  /// compiled code is worth keeping across sessions.
+  //------------------------------------------------------------------
+  virtual bool CanCacheCompiledCode() { return false; }
+
   virtual EvaluateExpressionOptions *GetOptions() { return nullptr; };
 
   //------------------------------------------------------------------
@@ -333,6 +333,11 @@ public:
   //------------------------------------------------------------------
   bool NeedsVariableResolution() override { return false; }
 
+  //------------------------------------------------------------------
+  /// Return true if the compiled code can be cached across sessions.
+  //------------------------------------------------------------------
+  bool CanCacheCompiledCode() override { return true; }
+
   ValueList GetArgumentValues() const { return m_arg_values; }
 
 protected:
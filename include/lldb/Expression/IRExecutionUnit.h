@@ -90,6 +90,16 @@ public:
   void GetRunnableInfo(Status &error, lldb::addr_t &func_addr,
                        lldb::addr_t &func_end);
 
+  //------------------------------------------------------------------
+  /// Look up and store the compiled object code in LLDB's on-disk cache.
+  /// The cache is keyed by the IR of the module, so this is only worth
+  /// turning on for code that is compiled the same way in every session.
+  /// Must be called before GetRunnableInfo().
+  //------------------------------------------------------------------
+  void SetUseObjectCache(bool use_object_cache) {
+    m_use_object_cache = use_object_cache;
+  }
+
   //------------------------------------------------------------------
   /// Accessors for IRForTarget and other clients that may want binary
   /// data placed on their behalf.  The binary data is owned by the
@@ -433,6 +443,7 @@ private:
   std::vector<ConstString> m_failed_lookups;
 
   std::atomic<bool> m_did_jit;
+  bool m_use_object_cache; ///< True if the on-disk object cache is used
 
   lldb::addr_t m_function_load_addr;
   lldb::addr_t m_function_end_load_addr;
@@ -74,6 +74,19 @@ public:
   void GetMemoryData(DataExtractor &extractor, lldb::addr_t process_address,
                      size_t size, Status &error);
 
+  //------------------------------------------------------------------
+  /// Batch the process side of accesses to mirrored allocations.
+  ///
+  /// Between BeginBatch() and EndBatch(), writes to a mirrored allocation
+  /// only update its host copy, and the written range is sent to the
+  /// process in one transfer when the batch ends.  The first read from a
+  /// mirrored allocation brings the whole allocation into the host copy,
+  /// and later reads are served from there.  The process must not run
+  /// while a batch is open.
+  //------------------------------------------------------------------
+  void BeginBatch();
+  void EndBatch(Status &error);
+
   lldb::ByteOrder GetByteOrder();
   uint32_t GetAddressByteSize();
 
@@ -105,6 +118,13 @@ private:
     AllocationPolicy m_policy;
     bool m_leak;
 
+    size_t m_dirty_start; ///< The start of the host data that has not been
+                          ///written to the process yet
+    size_t m_dirty_end;   ///< The end of that data, equal to m_dirty_start if
+                          ///there is none
+    bool m_host_current;  ///< True if the host copy matches the process for
+                          ///the rest of the current batch
+
   public:
     Allocation(lldb::addr_t process_alloc, lldb::addr_t process_start,
                size_t size, uint32_t permissions, uint8_t alignment,
@@ -114,13 +134,24 @@ private:
         : m_process_alloc(LLDB_INVALID_ADDRESS),
           m_process_start(LLDB_INVALID_ADDRESS), m_size(0), m_permissions(0),
           m_alignment(0), m_data(), m_policy(eAllocationPolicyInvalid),
-          m_leak(false) {}
+          m_leak(false), m_dirty_start(0), m_dirty_end(0),
+          m_host_current(false) {}
   };
 
   lldb::ProcessWP m_process_wp;
   lldb::TargetWP m_target_wp;
   typedef std::map<lldb::addr_t, Allocation> AllocationMap;
   AllocationMap m_allocations;
+  bool m_batching;
+
+  // Writes the host data of a mirrored allocation that the process hasn't
+  // seen yet.
+  void FlushAllocation(Allocation &allocation, Status &error);
+
+  // Brings the host copy of a mirrored allocation up to date for the rest of
+  // the current batch.  Returns false if the allocation should be read from
+  // the process directly instead.
+  bool SyncAllocationForBatch(Allocation &allocation, Status &error);
 
   lldb::addr_t FindSpace(size_t size);
   bool ContainsHostOnlyAllocations();
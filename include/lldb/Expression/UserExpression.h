@@ -101,7 +101,7 @@ public:
 
   virtual bool CanInterpret() = 0;
 
-  bool MatchesContext(ExecutionContext &exe_ctx);
+  virtual bool MatchesContext(ExecutionContext &exe_ctx);
 
   //------------------------------------------------------------------
   /// Execute the parsed expression by callinng the derived class's
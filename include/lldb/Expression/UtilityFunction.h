@@ -116,6 +116,11 @@ public:
   //------------------------------------------------------------------
   bool NeedsVariableResolution() override { return false; }
 
+  //------------------------------------------------------------------
+  /// Return true if the compiled code can be cached across sessions.
+  //------------------------------------------------------------------
+  bool CanCacheCompiledCode() override { return true; }
+
   // This makes the function caller function.
   // Pass in the ThreadSP if you have one available, compilation can end up
   // calling code (e.g. to look up indirect
@@ -30,6 +30,8 @@ struct ResumeAction {
                          // eStateRunning, and eStateStepping.
   int signal; // When resuming this thread, resume it with this signal if this
               // value is > 0
+  lldb::addr_t range_start; // When stepping, keep stepping while the pc is in
+  lldb::addr_t range_end;   // [range_start, range_end). Empty for one step.
 };
 
 //------------------------------------------------------------------
@@ -10,8 +10,11 @@
 #ifndef liblldb_NativeBreakpoint_h_
 #define liblldb_NativeBreakpoint_h_
 
+#include "lldb/Utility/AgentExpression.h"
 #include "lldb/lldb-types.h"
 
+#include <vector>
+
 namespace lldb_private {
 class NativeBreakpointList;
 
@@ -34,9 +37,39 @@ public:
 
   virtual bool IsSoftwareBreakpoint() const = 0;
 
+  // The breakpoint only needs to be reported to the client if one of these
+  // evaluates to non-zero.  An empty list means always report it.
+  const std::vector<AgentExpression> &GetConditions() const {
+    return m_conditions;
+  }
+
+  void SetConditions(std::vector<AgentExpression> conditions) {
+    m_conditions = std::move(conditions);
+  }
+
+  // The number of hits to skip before the breakpoint is reported.
+  uint32_t GetIgnoreCount() const { return m_ignore_count; }
+
+  void SetIgnoreCount(uint32_t ignore_count) { m_ignore_count = ignore_count; }
+
+  // Auto-continue breakpoints only count their hits and are never reported.
+  bool IsAutoContinue() const { return m_auto_continue; }
+
+  void SetAutoContinue(bool auto_continue) { m_auto_continue = auto_continue; }
+
+  // The number of hits the client would have counted but that were skipped
+  // instead of being reported.
+  uint64_t GetSkippedHitCount() const { return m_skipped_hit_count; }
+
+  void IncrementSkippedHitCount() { ++m_skipped_hit_count; }
+
 protected:
   const lldb::addr_t m_addr;
   int32_t m_ref_count;
+  std::vector<AgentExpression> m_conditions;
+  uint32_t m_ignore_count = 0;
+  bool m_auto_continue = false;
+  uint64_t m_skipped_hit_count = 0;
 
   virtual Status DoEnable() = 0;
 
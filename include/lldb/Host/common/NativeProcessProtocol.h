@@ -12,6 +12,7 @@
 
 #include "lldb/Host/Host.h"
 #include "lldb/Host/MainLoop.h"
+#include "lldb/Utility/AgentExpression.h"
 #include "lldb/Utility/Status.h"
 #include "lldb/Utility/TraceOptions.h"
 #include "lldb/lldb-private-forward.h"
@@ -41,6 +42,12 @@ public:
 
   virtual Status Resume(const ResumeActionList &resume_actions) = 0;
 
+  //------------------------------------------------------------------
+  /// Whether Resume() honors the step range of a ResumeAction, stepping
+  /// the thread until its pc leaves the range before reporting a stop.
+  //------------------------------------------------------------------
+  virtual bool SupportsRangeStepping() const { return false; }
+
   virtual Status Halt() = 0;
 
   virtual Status Detach() = 0;
@@ -110,10 +117,74 @@ public:
 
   virtual Status RemoveBreakpoint(lldb::addr_t addr, bool hardware = false);
 
+  //------------------------------------------------------------------
+  /// Set a breakpoint at each of \a addrs, as SetBreakpoint would.
+  ///
+  /// @param[out] errors
+  ///     The result of setting the breakpoint at the matching address.
+  //------------------------------------------------------------------
+  virtual void SetBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs,
+                              uint32_t size_hint, bool hardware,
+                              std::vector<Status> &errors);
+
+  //------------------------------------------------------------------
+  /// Remove the breakpoint at each of \a addrs, as RemoveBreakpoint
+  /// would.
+  //------------------------------------------------------------------
+  void RemoveBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs, bool hardware,
+                         std::vector<Status> &errors);
+
   virtual Status EnableBreakpoint(lldb::addr_t addr);
 
   virtual Status DisableBreakpoint(lldb::addr_t addr);
 
+  //------------------------------------------------------------------
+  /// Replace the options that decide which hits of the software
+  /// breakpoint at \a addr are reported.
+  ///
+  /// @param[in] conditions
+  ///     GDB agent expressions, a hit only needs to be reported if one of
+  ///     them evaluates to non-zero.
+  ///
+  /// @param[in] ignore_count
+  ///     The number of hits to skip before any is reported.
+  ///
+  /// @param[in] auto_continue
+  ///     If true, hits are only counted and never reported.
+  //------------------------------------------------------------------
+  Status SetBreakpointStopOptions(lldb::addr_t addr,
+                                  std::vector<AgentExpression> conditions,
+                                  uint32_t ignore_count, bool auto_continue);
+
+  //------------------------------------------------------------------
+  /// Get the number of hits of the breakpoint at \a addr that were
+  /// skipped but count as hits for the client, and how many hits are
+  /// still to be ignored.
+  //------------------------------------------------------------------
+  Status GetBreakpointHitCounts(lldb::addr_t addr, uint64_t &skipped_hits,
+                                uint32_t &ignore_count);
+
+  //------------------------------------------------------------------
+  /// Decide whether \a thread hitting the software breakpoint at \a addr
+  /// needs to be reported.
+  ///
+  /// This doesn't change the breakpoint, call SkipBreakpointHit once the
+  /// hit has actually been skipped.
+  ///
+  /// @param[out] count_hit
+  ///     Set to true if a skipped hit still counts as a hit, which is
+  ///     the case for ignored hits and hits of auto-continue breakpoints.
+  ///
+  /// @return
+  ///     True if the hit must be reported.  A condition that fails to
+  ///     evaluate reports the hit, so that the client gets to report the
+  ///     problem.
+  //------------------------------------------------------------------
+  bool BreakpointHitShouldStop(NativeThreadProtocol &thread,
+                               lldb::addr_t addr, bool &count_hit);
+
+  void SkipBreakpointHit(lldb::addr_t addr, bool count_hit);
+
   //----------------------------------------------------------------------
   // Hardware Breakpoint functions
   //----------------------------------------------------------------------
@@ -448,6 +519,11 @@ protected:
   // -----------------------------------------------------------
   Status SetSoftwareBreakpoint(lldb::addr_t addr, uint32_t size_hint);
 
+  // New software breakpoints that share a memory page are written together,
+  // with one read and one write of the memory they span.
+  void SetSoftwareBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs,
+                              uint32_t size_hint, std::vector<Status> &errors);
+
   virtual Status
   GetSoftwareBreakpointTrapOpcode(size_t trap_opcode_size_hint,
                                   size_t &actual_opcode_size,
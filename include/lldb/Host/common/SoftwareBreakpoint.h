@@ -13,6 +13,10 @@
 #include "NativeBreakpoint.h"
 #include "lldb/lldb-private-forward.h"
 
+#include "llvm/ADT/ArrayRef.h"
+
+#include <vector>
+
 namespace lldb_private {
 class SoftwareBreakpoint : public NativeBreakpoint {
   friend class NativeBreakpointList;
@@ -22,6 +26,16 @@ public:
                                          lldb::addr_t addr, size_t size_hint,
                                          NativeBreakpointSP &breakpoint_spn);
 
+  // Set a software breakpoint at each of \a addrs, which must be sorted
+  // and far enough apart that the traps don't overlap, with a single read,
+  // write and verification of the memory they span.  Either all of the
+  // breakpoints are set or none are.
+  static Status
+  CreateSoftwareBreakpoints(NativeProcessProtocol &process,
+                            llvm::ArrayRef<lldb::addr_t> addrs,
+                            size_t size_hint,
+                            std::vector<NativeBreakpointSP> &breakpoints);
+
   SoftwareBreakpoint(NativeProcessProtocol &process, lldb::addr_t addr,
                      const uint8_t *saved_opcodes, const uint8_t *trap_opcodes,
                      size_t opcode_size);
@@ -42,6 +56,11 @@ private:
   uint8_t m_trap_opcodes[MAX_TRAP_OPCODE_SIZE];
   const size_t m_opcode_size;
 
+  static Status GetTrapOpcode(NativeProcessProtocol &process,
+                              lldb::addr_t addr, size_t size_hint,
+                              size_t &bp_opcode_size,
+                              const uint8_t *&bp_opcode_bytes);
+
   static Status EnableSoftwareBreakpoint(NativeProcessProtocol &process,
                                          lldb::addr_t addr,
                                          size_t bp_opcode_size,
@@ -68,6 +68,15 @@ public:
     ++local_counters.m_record_layout_count;
   }
 
+  // The local counters cover the expression being parsed.
+  static uint64_t GetLocalClangImportCount() {
+    return local_counters.m_clang_import_count;
+  }
+
+  static uint64_t GetLocalDeclCompletionCount() {
+    return local_counters.m_decls_completed_count;
+  }
+
 private:
   struct Counters {
     uint64_t m_visible_query_count;
@@ -38,6 +38,14 @@ public:
 
   DWARFCallFrameInfo(ObjectFile &objfile, lldb::SectionSP &section, Type type);
 
+  // Provide the .eh_frame_hdr section that accompanies an EH section.  When
+  // the header carries a sorted binary search table, single address lookups
+  // are answered from that table and never need to scan every FDE in the
+  // section.
+  void SetEHFrameHdrSection(const lldb::SectionSP &section_sp) {
+    m_eh_frame_hdr_sp = section_sp;
+  }
+
   ~DWARFCallFrameInfo() = default;
 
   // Locate an AddressRange that includes the provided Address in this
@@ -125,6 +133,21 @@ private:
 
   void GetFDEIndex();
 
+  // Look up the FDE covering file_addr through the .eh_frame_hdr binary
+  // search table.  Returns false if there is no usable table or no FDE
+  // covers the address.
+  bool GetFDEEntryFromEHFrameHdr(lldb::addr_t file_addr,
+                                 FDEEntryMap::Entry &fde_entry);
+
+  // Returns true if the .eh_frame_hdr has a binary search table we can use.
+  bool HasEHFrameHdrTable();
+
+  // Decode the initial location and address range of the FDE at
+  // fde_offset.  Returns false if the entry is not a valid FDE.
+  bool ParseFDEAddressRange(dw_offset_t fde_offset,
+                            bool clear_address_zeroth_bit,
+                            FDEEntryMap::Entry &fde_entry);
+
   bool FDEToUnwindPlan(uint32_t offset, Address startaddr,
                        UnwindPlan &unwind_plan);
 
@@ -152,6 +175,13 @@ private:
   FDEEntryMap m_fde_index;
   bool m_fde_index_initialized = false; // only scan the section for FDEs once
   std::mutex m_fde_index_mutex; // and isolate the thread that does it
+  std::mutex m_cie_map_mutex;   // CIEs may be parsed lazily from any thread
+
+  lldb::SectionSP m_eh_frame_hdr_sp;
+  DataExtractor m_eh_frame_hdr_data;
+  lldb::offset_t m_eh_frame_hdr_table_offset = 0; // start of the search table
+  uint32_t m_eh_frame_hdr_fde_count = 0; // 0 if there is no usable table
+  bool m_eh_frame_hdr_initialized = false;
 
   Type m_type;
 
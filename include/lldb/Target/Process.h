@@ -18,6 +18,7 @@
 // C++ Includes
 #include <chrono>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -101,6 +102,8 @@ public:
 
   bool GetStopOnExec() const;
 
+  bool GetDisplacedStepping() const;
+
 protected:
   static void OptionValueChangedCallback(void *baton,
                                          OptionValue *option_value);
@@ -2018,6 +2021,42 @@ public:
   lldb::addr_t CallocateMemory(size_t size, uint32_t permissions,
                                Status &error);
 
+  //------------------------------------------------------------------
+  /// Make a copy of the instruction at a breakpoint site that a thread
+  /// can step instead of the original.
+  ///
+  /// Stepping the copy leaves the breakpoint trap in place, so the other
+  /// threads can keep running while a thread steps over it.  Copies are
+  /// made once per breakpoint site and reused until the site is removed.
+  ///
+  /// The first copy allocates memory for them, which may run code in the
+  /// process, so call this while the process is stopped and not while
+  /// it is being resumed.
+  ///
+  /// @param[in] addr
+  ///     The address of the instruction.
+  //------------------------------------------------------------------
+  void PrepareDisplacedStepCopy(lldb::addr_t addr);
+
+  //------------------------------------------------------------------
+  /// Get the copy of the instruction at a breakpoint site made by
+  /// PrepareDisplacedStepCopy.
+  ///
+  /// @param[in] addr
+  ///     The address of the instruction.
+  ///
+  /// @param[out] size
+  ///     The size of the instruction.  After stepping the copy the
+  ///     thread's pc has to be moved back to the original by the same
+  ///     distance it moved in the copy.
+  ///
+  /// @return
+  ///     The address of the copy, or LLDB_INVALID_ADDRESS if displaced
+  ///     stepping is turned off, no copy was made, or the instruction's
+  ///     behavior depends on its address.
+  //------------------------------------------------------------------
+  lldb::addr_t GetDisplacedStepCopy(lldb::addr_t addr, uint32_t &size) const;
+
   //------------------------------------------------------------------
   /// Resolve dynamically loaded indirect functions.
   ///
@@ -2334,6 +2373,25 @@ public:
     return error;
   }
 
+  //------------------------------------------------------------------
+  /// Enable all of \a bp_sites, as EnableBreakpointSite would.
+  ///
+  /// Plug-ins that can enable many sites for less than the cost of
+  /// enabling them one at a time should override this.
+  ///
+  /// @param[out] errors
+  ///     The result of enabling the site at the matching index.
+  //------------------------------------------------------------------
+  virtual void EnableBreakpointSites(llvm::ArrayRef<BreakpointSite *> bp_sites,
+                                     std::vector<Status> &errors);
+
+  //------------------------------------------------------------------
+  /// Disable all of \a bp_sites, as DisableBreakpointSite would.
+  //------------------------------------------------------------------
+  virtual void
+  DisableBreakpointSites(llvm::ArrayRef<BreakpointSite *> bp_sites,
+                         std::vector<Status> &errors);
+
   // This is implemented completely using the lldb::Process API. Subclasses
   // don't need to implement this function unless the standard flow of
   // read existing opcode, write breakpoint opcode, verify breakpoint opcode
@@ -2357,6 +2415,13 @@ public:
   lldb::break_id_t CreateBreakpointSite(const lldb::BreakpointLocationSP &owner,
                                         bool use_hardware);
 
+  //------------------------------------------------------------------
+  /// Resolve the breakpoint site of each of \a owners, as
+  /// CreateBreakpointSite would, enabling all the new sites with one
+  /// call to EnableBreakpointSites.
+  //------------------------------------------------------------------
+  void CreateBreakpointSites(llvm::ArrayRef<lldb::BreakpointLocationSP> owners);
+
   Status DisableBreakpointSiteByID(lldb::user_id_t break_id);
 
   Status EnableBreakpointSiteByID(lldb::user_id_t break_id);
@@ -2367,6 +2432,12 @@ public:
                                      lldb::user_id_t owner_loc_id,
                                      lldb::BreakpointSiteSP &bp_site_sp);
 
+  // Remove each of the locations in owners from its breakpoint site, and
+  // disable the sites left without owners with one call to
+  // DisableBreakpointSites.
+  void RemoveOwnersFromBreakpointSites(
+      llvm::ArrayRef<lldb::BreakpointLocationSP> owners);
+
   //----------------------------------------------------------------------
   // Process Watchpoints (optional)
   //----------------------------------------------------------------------
@@ -3124,6 +3195,15 @@ protected:
   Predicate<uint32_t> m_iohandler_sync;
   MemoryCache m_memory_cache;
   AllocatedMemoryCache m_allocated_memory_cache;
+  struct DisplacedStepCopy {
+    lldb::addr_t addr; ///< LLDB_INVALID_ADDRESS if it can't be displaced
+    uint32_t size;
+  };
+  /// Copies of instructions at breakpoint sites, by the sites' addresses.
+  std::map<lldb::addr_t, DisplacedStepCopy> m_displaced_step_copies;
+  /// Unused slots for copies, see PrepareDisplacedStepCopy().
+  std::vector<lldb::addr_t> m_displaced_step_free_slots;
+  bool m_displaced_step_memory_allocated;
   bool m_should_detach; /// Should we detach if the process object goes away
                         /// with an explicit call to Kill or Detach?
   LanguageRuntimeCollection m_language_runtimes;
@@ -3248,6 +3328,17 @@ protected:
 
   void LoadOperatingSystemPlugin(bool flush);
 
+  void ReleaseDisplacedStepCopy(lldb::addr_t addr);
+
+  // Whether failing to set a breakpoint site is worth a warning in the
+  // current state.
+  bool ShouldReportBreakpointSiteErrors();
+
+  // The address to put owner's breakpoint site at, or LLDB_INVALID_ADDRESS.
+  lldb::addr_t
+  GetBreakpointSiteLoadAddress(const lldb::BreakpointLocationSP &owner,
+                               bool show_error);
+
 private:
   //------------------------------------------------------------------
   /// This is the part of the event handling that for a process event.
@@ -339,6 +339,10 @@ public:
 
   bool IsInLibraryNegativeCache(const char *library_name);
 
+  void AddToLinkedModuleCache(llvm::StringRef module_name);
+
+  bool IsInLinkedModuleCache(llvm::StringRef module_name);
+
   // Swift uses a few known-unused bits in ObjC pointers
   // to record useful-for-bridging information
   // This API's task is to return such pointer+info aggregates
@@ -440,6 +444,9 @@ protected:
                                                             // hand,
   std::mutex m_negative_cache_mutex; // but if they are missing, we shouldn't
                                      // keep trying.
+  std::unordered_set<std::string> m_linked_module_cache; // Swift modules whose
+                                                         // link libraries are
+                                                         // all loaded.
 
   llvm::Optional<lldb::addr_t> m_SwiftNativeNSErrorISA;
 
@@ -15,6 +15,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -156,6 +157,8 @@ public:
 
   bool GetEnableSaveObjects() const;
 
+  bool GetEnableCacheObjects() const;
+
   bool GetEnableSyntheticValue() const;
 
   uint32_t GetMaximumNumberOfChildrenToDisplay() const;
@@ -216,6 +219,10 @@ public:
 
   void SetInjectLocalVariables(ExecutionContext *exe_ctx, bool b);
 
+  bool GetLazyTypeImport(ExecutionContext *exe_ctx) const;
+
+  bool GetParallelSwiftModuleLoad(ExecutionContext *exe_ctx) const;
+
 private:
   //------------------------------------------------------------------
   // Callbacks for m_launch_info.
@@ -1101,6 +1108,32 @@ public:
       Expression::ResultType desired_type,
       const EvaluateExpressionOptions &options, Status &error);
 
+  //------------------------------------------------------------------
+  /// Take a previously parsed expression out of the expression cache.
+  ///
+  /// Expressions are cached under a key built from their text and the
+  /// options that affect parsing by UserExpression::Evaluate.  An
+  /// expression is only handed out if it can run in \a exe_ctx, and
+  /// it is removed from the cache while in use, so the same expression
+  /// is never materialized twice at once.
+  ///
+  /// @return
+  ///     The cached expression, or an empty shared pointer if there is
+  ///     none that matches \a exe_ctx.
+  //------------------------------------------------------------------
+  lldb::UserExpressionSP GetCachedUserExpression(llvm::StringRef key,
+                                                 ExecutionContext &exe_ctx);
+
+  void CacheUserExpression(llvm::StringRef key,
+                           const lldb::UserExpressionSP &user_expression_sp);
+
+  //------------------------------------------------------------------
+  /// Drop all cached expressions.  This is done whenever modules come
+  /// or go, the process changes, or top level expressions add types,
+  /// since any of those can change the result of parsing.
+  //------------------------------------------------------------------
+  void ClearUserExpressionCache();
+
   // Creates a FunctionCaller for the given language, the rest of the parameters
   // have the
   // same meaning as for the FunctionCaller constructor.  Since a FunctionCaller
@@ -1208,6 +1241,18 @@ public:
   lldb::addr_t FindLoadAddrForNameInSymbolsAndPersistentVariables(
       ConstString name_const_str, lldb::SymbolType symbol_type);
 
+  //------------------------------------------------------------------
+  /// Evaluate \a expr without the expression parser if it is just a path
+  /// through a frame variable's members, like "a.b->c[3]" or "*p".
+  ///
+  /// @return
+  ///     A persistent result variable holding the value, or an empty
+  ///     shared pointer if \a expr needs the expression parser.
+  //------------------------------------------------------------------
+  lldb::ValueObjectSP
+  EvaluateVariablePath(llvm::StringRef expr, ExecutionContext &exe_ctx,
+                       const EvaluateExpressionOptions &options);
+
   lldb::ExpressionVariableSP GetPersistentVariable(const ConstString &name);
 
   lldb::addr_t GetPersistentSymbol(const ConstString &name);
@@ -1382,6 +1427,12 @@ protected:
   typedef std::map<lldb::LanguageType, lldb::REPLSP> REPLMap;
   REPLMap m_repl_map;
 
+  typedef std::multimap<std::string, lldb::UserExpressionSP>
+      UserExpressionCache;
+  std::mutex m_user_expression_cache_mutex;
+  UserExpressionCache m_user_expression_cache; ///< See
+                                               ///GetCachedUserExpression.
+
   lldb::ClangASTImporterSP m_ast_importer_sp;
   lldb::ClangModulesDeclVendorUP m_clang_modules_decl_vendor_ap;
 
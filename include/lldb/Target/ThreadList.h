@@ -131,6 +131,26 @@ public:
 
   void DiscardThreadPlans();
 
+  //------------------------------------------------------------------
+  /// Unwind the stacks of a set of threads concurrently on the task pool.
+  ///
+  /// Unwinding a stopped thread only reads memory and registers, and the
+  /// threads are independent of each other, so for processes with many
+  /// threads it pays to compute the frames up front in parallel.  Later
+  /// calls to Thread::GetStackFrameAtIndex are then served from each
+  /// thread's cached StackFrameList.  Does nothing unless the process is
+  /// stopped.
+  ///
+  /// @param[in] tids
+  ///     The threads whose stacks should be computed.
+  ///
+  /// @param[in] end_idx
+  ///     Unwind each thread up to and including this frame index, or
+  ///     UINT32_MAX to unwind the whole stack.
+  //------------------------------------------------------------------
+  void ComputeStackFrames(const std::vector<lldb::tid_t> &tids,
+                          uint32_t end_idx);
+
   uint32_t GetStopID() const;
 
   void SetStopID(uint32_t stop_id);
@@ -552,6 +552,14 @@ public:
 
   virtual bool IsVirtualStep() { return false; }
 
+  // If this plan is about to single step and would keep stepping for as long
+  // as the pc stays in [start, end), return that range.  A remote stub that
+  // can step through a range itself then only reports the step that leaves
+  // it.
+  virtual bool GetStepRange(lldb::addr_t &start, lldb::addr_t &end) {
+    return false;
+  }
+
   virtual bool SetIterationCount(size_t count) {
     if (m_takes_iteration_count) {
       // Don't tell me to do something 0 times...
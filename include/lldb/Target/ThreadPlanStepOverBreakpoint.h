@@ -45,11 +45,19 @@ protected:
 
   void ReenableBreakpointSite();
 
+  bool GetDisplacedStepCopy(lldb::addr_t &copy_addr, uint32_t &copy_size);
+
+  void MoveOutOfDisplacedStepCopy();
+
 private:
   lldb::addr_t m_breakpoint_addr;
   lldb::user_id_t m_breakpoint_site_id;
   bool m_auto_continue;
   bool m_reenabled_breakpoint_site;
+  // When the thread's pc has been moved into a copy of the instruction at
+  // the breakpoint (see Process::GetDisplacedStepCopy), where the copy is.
+  lldb::addr_t m_displaced_addr;
+  uint32_t m_displaced_size;
 
   DISALLOW_COPY_AND_ASSIGN(ThreadPlanStepOverBreakpoint);
 };
@@ -0,0 +1,187 @@
+//===-- AgentExpression.h ---------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_AgentExpression_h_
+#define liblldb_AgentExpression_h_
+
+#include "lldb/Utility/Status.h"
+#include "lldb/lldb-types.h"
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace lldb_private {
+
+//----------------------------------------------------------------------
+/// @class AgentExpression AgentExpression.h "lldb/Utility/AgentExpression.h"
+/// @brief A GDB remote protocol agent expression.
+///
+/// Agent expressions are the stack machine bytecode that the GDB remote
+/// protocol uses to let a stub evaluate things like breakpoint conditions
+/// without a round trip to the debugger (see "Agent Expressions" in the GDB
+/// manual).  The debugger builds them with the Append functions and the
+/// stub runs them with Evaluate.
+///
+/// Only the integer subset of the bytecode is supported.  The tracing
+/// opcodes are accepted and do nothing, since there is no trace buffer to
+/// collect into.
+//----------------------------------------------------------------------
+class AgentExpression {
+public:
+  enum Opcode : uint8_t {
+    eOpAdd = 0x02,
+    eOpSub = 0x03,
+    eOpMul = 0x04,
+    eOpDivSigned = 0x05,
+    eOpDivUnsigned = 0x06,
+    eOpRemSigned = 0x07,
+    eOpRemUnsigned = 0x08,
+    eOpLsh = 0x09,
+    eOpRshSigned = 0x0a,
+    eOpRshUnsigned = 0x0b,
+    eOpTrace = 0x0c,
+    eOpTraceQuick = 0x0d,
+    eOpLogNot = 0x0e,
+    eOpBitAnd = 0x0f,
+    eOpBitOr = 0x10,
+    eOpBitXor = 0x11,
+    eOpBitNot = 0x12,
+    eOpEqual = 0x13,
+    eOpLessSigned = 0x14,
+    eOpLessUnsigned = 0x15,
+    eOpExt = 0x16,
+    eOpRef8 = 0x17,
+    eOpRef16 = 0x18,
+    eOpRef32 = 0x19,
+    eOpRef64 = 0x1a,
+    eOpIfGoto = 0x20,
+    eOpGoto = 0x21,
+    eOpConst8 = 0x22,
+    eOpConst16 = 0x23,
+    eOpConst32 = 0x24,
+    eOpConst64 = 0x25,
+    eOpReg = 0x26,
+    eOpEnd = 0x27,
+    eOpDup = 0x28,
+    eOpPop = 0x29,
+    eOpZeroExt = 0x2a,
+    eOpSwap = 0x2b,
+    eOpTraceNZ = 0x2f,
+    eOpTrace16 = 0x30,
+    eOpPick = 0x32,
+    eOpRot = 0x33
+  };
+
+  //------------------------------------------------------------------
+  /// Read the register numbered \a reg_num in the remote protocol's
+  /// numbering.  Returns false if the register can't be read.
+  //------------------------------------------------------------------
+  typedef std::function<bool(uint32_t reg_num, uint64_t &value)>
+      ReadRegisterCallback;
+
+  //------------------------------------------------------------------
+  /// Read a \a size byte unsigned integer, in target byte order, from
+  /// \a addr.  Returns false if the memory can't be read.
+  //------------------------------------------------------------------
+  typedef std::function<bool(lldb::addr_t addr, size_t size, uint64_t &value)>
+      ReadMemoryCallback;
+
+  AgentExpression() = default;
+
+  AgentExpression(llvm::ArrayRef<uint8_t> bytes)
+      : m_bytes(bytes.begin(), bytes.end()) {}
+
+  llvm::ArrayRef<uint8_t> GetBytes() const { return m_bytes; }
+
+  size_t GetSize() const { return m_bytes.size(); }
+
+  bool IsEmpty() const { return m_bytes.empty(); }
+
+  bool operator==(const AgentExpression &rhs) const {
+    return m_bytes == rhs.m_bytes;
+  }
+
+  bool operator!=(const AgentExpression &rhs) const { return !(*this == rhs); }
+
+  //------------------------------------------------------------------
+  // Building expressions
+  //------------------------------------------------------------------
+  void AppendOpcode(Opcode op) { m_bytes.push_back(op); }
+
+  //------------------------------------------------------------------
+  /// Push \a value using the smallest constN opcode that holds it.
+  //------------------------------------------------------------------
+  void AppendConstant(uint64_t value);
+
+  void AppendRegister(uint16_t reg_num);
+
+  //------------------------------------------------------------------
+  /// Pop an address and push the \a byte_size byte value stored there.
+  ///
+  /// @return
+  ///     False if \a byte_size isn't 1, 2, 4 or 8.
+  //------------------------------------------------------------------
+  bool AppendReference(size_t byte_size);
+
+  //------------------------------------------------------------------
+  /// Sign extend (ext) or zero extend (zero_ext) the top of the stack
+  /// from \a bits bits.
+  //------------------------------------------------------------------
+  void AppendExtend(uint8_t bits, bool is_signed);
+
+  //------------------------------------------------------------------
+  /// Append an if_goto or goto whose target isn't known yet.
+  ///
+  /// @return
+  ///     The offset to pass to PatchGoto once the target is known.
+  //------------------------------------------------------------------
+  size_t AppendGoto(Opcode op);
+
+  void PatchGoto(size_t patch_offset, size_t target);
+
+  //------------------------------------------------------------------
+  /// Check that every opcode is supported, every operand is complete and
+  /// every jump lands inside the expression.
+  //------------------------------------------------------------------
+  Status Validate() const;
+
+  //------------------------------------------------------------------
+  /// Run the expression.
+  ///
+  /// @param[in] read_register
+  ///     Called for each reg opcode.
+  ///
+  /// @param[in] read_memory
+  ///     Called for each refN opcode.
+  ///
+  /// @param[out] result
+  ///     The value on top of the stack when the end opcode is reached.
+  ///
+  /// @return
+  ///     An error if the expression is malformed, uses an unsupported
+  ///     opcode, divides by zero, runs for too long or one of the
+  ///     callbacks fails.
+  //------------------------------------------------------------------
+  Status Evaluate(const ReadRegisterCallback &read_register,
+                  const ReadMemoryCallback &read_memory,
+                  uint64_t &result) const;
+
+private:
+  void AppendBigEndian(uint64_t value, size_t byte_size);
+
+  std::vector<uint8_t> m_bytes;
+};
+
+} // namespace lldb_private
+
+#endif // liblldb_AgentExpression_h_
@@ -0,0 +1,56 @@
+"""
+Test that LLDB reuses the cached object code of its helper functions
+"""
+
+from __future__ import print_function
+
+import os
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class CacheJITObjectsTestCase(TestBase):
+    mydir = TestBase.compute_mydir(__file__)
+
+    def count_cache_hits(self, log_file):
+        if not os.path.exists(log_file):
+            return 0
+        with open(log_file, "r") as f:
+            return f.read().count("Loaded JIT object code for")
+
+    @expectedFailureAll(oslist=["windows"])
+    def test_second_compile_hits_cache(self):
+        """Test that a helper function compiled again is loaded from the cache."""
+        self.build()
+        src_file_spec = lldb.SBFileSpec("main.c")
+
+        log_file = os.path.join(os.getcwd(), "cache-jit-objects.log")
+        if os.path.exists(log_file):
+            os.remove(log_file)
+        self.runCmd("log enable -f '%s' lldb expr" % log_file)
+        self.runCmd("settings set target.cache-jit-objects true")
+        self.addTearDownHook(lambda: self.runCmd(
+            "settings clear target.cache-jit-objects"))
+
+        # The first JIT compiled expression in a process installs the
+        # dynamic checker utility functions, which opt in to the cache.
+        (target, process, thread, bkpt) = lldbutil.run_to_source_breakpoint(
+            self, "break", src_file_spec)
+        value = thread.frames[0].EvaluateExpression("(void*)malloc(0x1)")
+        self.assertTrue(value.GetError().Success())
+        process.Kill()
+        hits_before = self.count_cache_hits(log_file)
+
+        # A new process compiles the same utility functions again.  This
+        # time they have to come from the cache.
+        (target, process, thread, bkpt) = lldbutil.run_to_source_breakpoint(
+            self, "break", src_file_spec)
+        value = thread.frames[0].EvaluateExpression("(void*)malloc(0x1)")
+        self.assertTrue(value.GetError().Success())
+        process.Kill()
+        self.runCmd("log disable lldb expr")
+
+        self.assertTrue(self.count_cache_hits(log_file) > hits_before,
+                        "The second compile was loaded from the cache")
@@ -0,0 +1,41 @@
+"""
+Test that reusing a parsed expression at later stops sees the new values.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class ExpressionCacheTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def test_expression_cache(self):
+        """Test that cached expressions are rematerialized at each stop."""
+        self.build()
+
+        self.runCmd("file a.out", CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_source_regexp(
+            self, "Set breakpoint here")
+        lldbutil.run_break_set_by_source_regexp(
+            self, "Set second breakpoint here")
+
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        # The same expressions evaluated at every stop, the way a watch
+        # window would, must see the current values of the variables.
+        for i in range(3):
+            self.expect("expression i + total", substrs=[str(i * i)])
+            self.expect("expression twice(i)", substrs=[str(2 * i)])
+            self.runCmd("continue")
+
+        # A different block of the function has different variables in
+        # scope, so the expression has to be parsed again there.
+        self.expect("expression other", substrs=["7"])
+        self.expect("expression i + total", error=True)
@@ -0,0 +1,21 @@
+//===-- main.c --------------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+int twice(int value) { return value * 2; }
+
+int main (int argc, char const *argv[])
+{
+    int total = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        total += twice(i); // Set breakpoint here
+    }
+    int other = total + 1;
+    return other; // Set second breakpoint here
+}
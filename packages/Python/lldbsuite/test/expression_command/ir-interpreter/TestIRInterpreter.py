@@ -85,3 +85,67 @@ class IRInterpreterTestCase(TestBase):
                 jit_result,
                 "While evaluating " +
                 expression)
+
+    @add_test_categories(['pyapi'])
+    # getpid() is POSIX, among other problems, see bug
+    @expectedFailureAll(
+        oslist=['windows'],
+        bugnumber="http://llvm.org/pr21765")
+    def test_ir_interpreter_floating_point(self):
+        self.build_and_run()
+
+        options = lldb.SBExpressionOptions()
+        options.SetLanguage(lldb.eLanguageTypeC_plus_plus)
+
+        set_up_expressions = ["double $d = 7.5",
+                              "double $e = -2.25",
+                              "float $f = 1.5f",
+                              "int $n = -4"]
+
+        expressions = ["$d + $e",
+                       "$d - $e",
+                       "$d * $e",
+                       "$d / $e",
+                       "$f * 3.0f",
+                       "(double)$f + $d",
+                       "(float)$d",
+                       "(int)$e",
+                       "(unsigned)$d",
+                       "(double)$n",
+                       "$d > $e",
+                       "$d <= $e",
+                       "$d == 7.5",
+                       "$d > $e ? $d : $e",
+                       "$n < 0 ? -$n : $n",
+                       "__builtin_fabs($e)",
+                       "__builtin_floor($d)",
+                       "__builtin_sqrt($d * $d)"]
+
+        for expression in set_up_expressions:
+            self.frame().EvaluateExpression(expression, options)
+
+        for expression in expressions:
+            interp_expression = expression
+            jit_expression = "(int)getpid(); " + expression
+
+            interp_result = self.frame().EvaluateExpression(
+                interp_expression, options)
+            jit_result = self.frame().EvaluateExpression(
+                jit_expression, options)
+
+            self.assertTrue(interp_result.GetError().Success(),
+                            "While evaluating " + expression)
+            self.assertEqual(
+                interp_result.GetValue(),
+                jit_result.GetValue(),
+                "While evaluating " +
+                expression)
+
+        # Converting a NaN or out of range value is undefined, so the
+        # interpreter refuses instead of making up a result.
+        for expression in ["(int)($d * 1e300)",
+                           "(unsigned)$e",
+                           "(long long)($d * 0.0 / 0.0)"]:
+            result = self.frame().EvaluateExpression(expression, options)
+            self.assertTrue(result.GetError().Fail(),
+                            "While evaluating " + expression)
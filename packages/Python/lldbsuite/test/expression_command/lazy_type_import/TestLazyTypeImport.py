@@ -0,0 +1,57 @@
+"""
+Test that expressions give the same results whether the types they use are
+imported lazily or completed up front.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class LazyTypeImportTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def setUp(self):
+        TestBase.setUp(self)
+        self.addTearDownHook(
+            lambda: self.runCmd(
+                "settings clear target.experimental.lazy-type-import"))
+
+    def check_expressions(self):
+        frame = self.frame()
+        expressions = [("outer.holder.value + 1", 21),
+                       ("outer.holder.Twice()", 40),
+                       ("outer.holder.Add(2)", 22),
+                       ("outer.holder.GetBaseValue()", 1),
+                       ("outer.other->Get() + outer.holder.Get()", 27),
+                       ("sizeof(outer)", frame.FindVariable("outer")
+                        .GetByteSize()),
+                       ("(long)&outer.holder == (long)&outer", 1)]
+
+        for expression, expected in expressions:
+            value = frame.EvaluateExpression(expression)
+            self.assertTrue(value.GetError().Success(),
+                            "While evaluating " + expression)
+            self.assertEqual(value.GetValueAsSigned(), expected,
+                             "While evaluating " + expression)
+
+    def test_lazy_type_import(self):
+        """Test expressions with lazy type import on and off."""
+        self.build()
+
+        self.runCmd("file a.out", CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_source_regexp(self, "Set breakpoint here")
+
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        self.runCmd("settings set target.experimental.lazy-type-import true")
+        self.check_expressions()
+
+        self.runCmd("settings set target.experimental.lazy-type-import false")
+        self.check_expressions()
@@ -0,0 +1,24 @@
+struct Base {
+  int base_value = 1;
+  int GetBaseValue() const { return base_value; }
+};
+
+template <typename T> struct Holder : Base {
+  T value;
+  Holder(T v) : value(v) {}
+  T Get() const { return value; }
+  T Twice() const { return value * 2; }
+  T Add(T other) const { return value + other; }
+};
+
+struct Outer {
+  Holder<int> holder{20};
+  Holder<long> *other = nullptr;
+};
+
+int main() {
+  Holder<long> other(7);
+  Outer outer;
+  outer.other = &other;
+  return outer.holder.Get() + (int)other.Get(); // Set breakpoint here
+}
@@ -0,0 +1,63 @@
+"""
+Test expressions that are evaluated as variable paths without the
+expression parser.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class VariablePathExpressionsTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def test_variable_path_expressions(self):
+        """Test that variable path expressions give the parser's results."""
+        self.build()
+
+        self.runCmd("file a.out", CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_source_regexp(self, "Set breakpoint here")
+
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        self.expect("expression o.inner.values[1]",
+                    startstr="(int) $0 = 2")
+        self.expect("expression o.inner_ptr->values[3]",
+                    startstr="(int) $1 = 40")
+        self.expect("expression *p", startstr="(int) $2 = 3")
+        # Bit-fields are left to the expression parser.
+        self.expect("expression  o.bits ", substrs=["$3 = 3"])
+
+        # The results are persistent variables like any other.
+        self.expect("expression $1 + $2", startstr="(int) $4 = 43")
+
+        # Anything else still goes through the expression parser.
+        self.expect("expression o.inner.values[1] + 1",
+                    startstr="(int) $5 = 3")
+        self.expect("expression o.inner_ptr.values[0]", error=True)
+        self.expect("expression no_such_variable", error=True)
+
+        frame = self.frame()
+        value = frame.EvaluateExpression("o.inner_ptr->values[0]")
+        self.assertTrue(value.GetError().Success())
+        self.assertEqual(value.GetValueAsSigned(), 10)
+
+    def test_member_shadows_global(self):
+        """Test that a member wins over a global of the same name."""
+        self.build()
+
+        self.runCmd("file a.out", CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_source_regexp(
+            self, "Set member breakpoint here")
+
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        self.expect("expression shadowed", startstr="(int) $0 = 2")
+        self.expect("expression file_shadowed", startstr="(int) $1 = 3")
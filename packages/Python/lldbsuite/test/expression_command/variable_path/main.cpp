@@ -0,0 +1,44 @@
+//===-- main.cpp ------------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+struct inner
+{
+    int values[4];
+};
+
+struct outer
+{
+    struct inner inner;
+    struct inner *inner_ptr;
+    int bits : 3;
+};
+
+int shadowed = 1;
+static int file_shadowed = 1;
+
+struct shadower
+{
+    int shadowed;
+    int file_shadowed;
+
+    int sum ()
+    {
+        return shadowed + file_shadowed; // Set member breakpoint here
+    }
+};
+
+int main (int argc, char const *argv[])
+{
+    struct shadower s = { 2, 3 };
+    s.sum ();
+    struct inner i = { { 10, 20, 30, 40 } };
+    struct outer o = { { { 1, 2, 3, 4 } }, &i, 3 };
+    int *p = &o.inner.values[2];
+    return 0; // Set breakpoint here
+}
@@ -0,0 +1,79 @@
+"""
+Test that threads stepping over a breakpoint run the instruction under it
+exactly once, whether they step a copy of it or the original.
+"""
+
+from __future__ import print_function
+
+
+import os
+import lldb
+import lldbsuite.test.lldbutil as lldbutil
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+
+
+class DisplacedSteppingTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    NO_DEBUG_INFO_TESTCASE = True
+
+    @skipIfWindows
+    def test_displaced_stepping(self):
+        """Step over a breakpoint hit by many threads using copies."""
+        self.build()
+        self.step_over_breakpoint(True)
+
+    @skipIfWindows
+    def test_in_place_stepping(self):
+        """Step over a breakpoint hit by many threads in place."""
+        self.build()
+        self.step_over_breakpoint(False)
+
+    def step_over_breakpoint(self, displaced):
+        self.runCmd("settings set target.process.displaced-stepping %s" %
+                    ("true" if displaced else "false"))
+        self.addTearDownHook(lambda: self.runCmd(
+            "settings clear target.process.displaced-stepping"))
+
+        # The step log says when a thread was moved into a copy.
+        log_file = os.path.join(os.getcwd(), "displaced-stepping.log")
+        if os.path.exists(log_file):
+            os.remove(log_file)
+        self.runCmd("log enable -f '%s' lldb step" % log_file)
+        self.addTearDownHook(lambda: self.runCmd("log disable lldb step"))
+
+        exe = os.path.join(os.getcwd(), "a.out")
+        target = self.dbg.CreateTarget(exe)
+        self.assertTrue(target.IsValid(), VALID_TARGET)
+
+        # The command keeps lldb-server from counting the hits by itself, so
+        # every hit stops and has to be stepped over.
+        bpno = lldbutil.run_break_set_by_source_regexp(
+            self, "Set a breakpoint here",
+            extra_options="--auto-continue 1 -C 'frame variable value'",
+            num_expected_locations=1)
+
+        error = lldb.SBError()
+        launch_info = lldb.SBLaunchInfo(None)
+        launch_info.SetWorkingDirectory(self.get_process_working_directory())
+        process = target.Launch(launch_info, error)
+        self.assertTrue(error.Success(), "Launch failed.")
+
+        self.assertEqual(process.GetState(), lldb.eStateExited)
+        # 4 threads each add one 20 times.
+        self.assertEqual(process.GetExitStatus(), 80)
+        bkpt = target.FindBreakpointByID(bpno)
+        self.assertEqual(bkpt.GetHitCount(), 80)
+
+        self.runCmd("log disable lldb step")
+        with open(log_file) as f:
+            num_displaced = f.read().count("using the copy at")
+        os.remove(log_file)
+        if displaced:
+            self.assertGreater(num_displaced, 0,
+                               "The breakpoint was never stepped over using "
+                               "a copy.")
+        else:
+            self.assertEqual(num_displaced, 0)
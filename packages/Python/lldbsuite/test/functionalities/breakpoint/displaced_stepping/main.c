@@ -0,0 +1,40 @@
+//===-- main.c --------------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <pthread.h>
+#include <stddef.h>
+
+#define NUM_THREADS 4
+#define NUM_CALLS 20
+
+int add_one(int value) {
+  return value + 1; // Set a breakpoint here
+}
+
+void *thread_func(void *arg) {
+  int *count = (int *)arg;
+  int i;
+  for (i = 0; i < NUM_CALLS; i++)
+    *count = add_one(*count);
+  return NULL;
+}
+
+int main(int argc, char const *argv[]) {
+  pthread_t threads[NUM_THREADS];
+  int counts[NUM_THREADS] = {0};
+  int total = 0;
+  int i;
+
+  for (i = 0; i < NUM_THREADS; i++)
+    pthread_create(&threads[i], NULL, thread_func, &counts[i]);
+  for (i = 0; i < NUM_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+    total += counts[i];
+  }
+  return total;
+}
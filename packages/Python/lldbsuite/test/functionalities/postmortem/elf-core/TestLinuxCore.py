@@ -6,6 +6,7 @@ from __future__ import print_function
 
 import shutil
 import struct
+import zlib
 
 import lldb
 from lldbsuite.test.decorators import *
@@ -97,6 +98,41 @@ class LinuxCoreTestCase(TestBase):
             self.RemoveTempFile("linux-x86_64-pid.out")
             self.RemoveTempFile("linux-x86_64-pid.core")
 
+    @skipIf(oslist=['windows'])
+    @skipIf(triple='^mips')
+    def test_x86_64_compressed(self):
+        """Test that lldb can read a BGZF compressed x86_64 linux core file."""
+        try:
+            shutil.copyfile("linux-x86_64.out", "linux-x86_64-bgzf.out")
+            self.write_bgzf("linux-x86_64.core", "linux-x86_64-bgzf.core")
+            self.do_test("linux-x86_64-bgzf", self._x86_64_pid,
+                         self._x86_64_regions)
+        finally:
+            self.RemoveTempFile("linux-x86_64-bgzf.out")
+            self.RemoveTempFile("linux-x86_64-bgzf.core")
+
+    def write_bgzf(self, src, dst):
+        """Compress src into dst the way bgzip does, in small blocks so that
+        reads cross block boundaries."""
+        with open(src, "rb") as f:
+            data = f.read()
+        block_size = 0x1000
+        chunks = [data[i:i + block_size]
+                  for i in range(0, len(data), block_size)]
+        # bgzip ends the file with an empty block.
+        chunks.append(b"")
+        with open(dst, "wb") as out:
+            for chunk in chunks:
+                compressor = zlib.compressobj(6, zlib.DEFLATED, -15)
+                deflated = compressor.compress(chunk) + compressor.flush()
+                block_size_field = 18 + len(deflated) + 8 - 1
+                out.write(struct.pack("<BBBBIBBHBBHH", 0x1f, 0x8b, 8, 4, 0, 0,
+                                      0xff, 6, ord("B"), ord("C"), 2,
+                                      block_size_field))
+                out.write(deflated)
+                out.write(struct.pack("<II", zlib.crc32(chunk) & 0xffffffff,
+                                      len(chunk)))
+
     @skipIf(oslist=['windows'])
     @skipIf(triple='^mips')
     def test_two_cores_same_pid(self):
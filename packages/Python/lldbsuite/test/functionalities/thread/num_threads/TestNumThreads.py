@@ -121,3 +121,45 @@ class NumberOfThreadsTestCase(TestBase):
                     "Backtrace with unique stack shown correctly",
                     substrs=[expect_string,
                         "main.cpp:%d"%self.thread3_before_lock_line])
+
+    @decorators.skipIfDarwin
+    def test_backtrace_all(self):
+        """Test backtrace all with several threads stopped in thread3."""
+        self.build()
+        exe = os.path.join(os.getcwd(), "a.out")
+        self.runCmd("file " + exe, CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_file_and_line(
+            self, "main.cpp", self.thread3_before_lock_line, num_expected_locations=1)
+
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        self.expect("thread list", STOPPED_DUE_TO_BREAKPOINT,
+                    substrs=["stop reason = breakpoint 1."])
+
+        # The stacks of all threads are unwound together before any of them
+        # is printed, and each one must come out the same as when it's
+        # backtraced on its own.
+        self.runCmd("thread backtrace all")
+        all_output = self.res.GetOutput()
+
+        process = self.process()
+        num_threads = process.GetNumThreads()
+        self.assertTrue(
+            num_threads >= 10,
+            'Number of expected threads and actual threads do not match.')
+        for i in range(num_threads):
+            thread = process.GetThreadAtIndex(i)
+            self.runCmd("thread backtrace %d" % thread.GetIndexID())
+            for line in self.res.GetOutput().splitlines():
+                if line.strip().startswith("frame #"):
+                    self.assertTrue(line.strip() in all_output,
+                                    "'%s' in thread backtrace all" % line)
+
+        # Limiting the count only unwinds that many frames of each thread.
+        self.expect("thread backtrace all -c 1",
+                    substrs=["thread #%d" % process.GetThreadAtIndex(
+                        num_threads - 1).GetIndexID(), "frame #0"],
+                    matching=True)
+        self.expect("thread backtrace all -c 1", substrs=["frame #1"],
+                    matching=False)
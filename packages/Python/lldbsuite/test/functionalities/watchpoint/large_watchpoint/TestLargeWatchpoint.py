@@ -0,0 +1,81 @@
+"""
+Test watching a buffer too large for the debug registers.
+"""
+
+from __future__ import print_function
+
+
+import os
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class LargeWatchpointTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+    NO_DEBUG_INFO_TESTCASE = True
+
+    # Page protection watchpoints are implemented by lldb-server on x86 Linux.
+    @skipUnlessPlatform(["linux"])
+    @skipIf(archs=no_match(["i386", "i686", "x86_64"]))
+    def test_large_watchpoint(self):
+        """Test that a write at the end of a multi-page buffer is caught."""
+        self.build()
+        self.watch_large_buffer([])
+
+    @skipUnlessPlatform(["linux"])
+    @skipIf(archs=no_match(["i386", "i686", "x86_64"]))
+    def test_fork(self):
+        """Test that a forked child doesn't crash on the watched pages."""
+        self.build()
+        self.watch_large_buffer(["fork"])
+
+    @skipUnlessPlatform(["linux"])
+    @skipIf(archs=no_match(["i386", "i686", "x86_64"]))
+    def test_vfork(self):
+        """Test that a vforked child doesn't crash on the watched pages."""
+        self.build()
+        self.watch_large_buffer(["vfork"])
+
+    def watch_large_buffer(self, args):
+        exe = os.path.join(os.getcwd(), "a.out")
+        target = self.dbg.CreateTarget(exe)
+        self.assertTrue(target and target.IsValid(), VALID_TARGET)
+
+        lldbutil.run_break_set_by_file_and_line(
+            self, "main.c",
+            line_number("main.c", "// Set break point at this line."),
+            num_expected_locations=1)
+
+        process = target.LaunchSimple(args, None,
+                self.get_process_working_directory())
+        self.assertEqual(process.GetState(), lldb.eStateStopped)
+
+        thread = lldbutil.get_stopped_thread(process,
+                                             lldb.eStopReasonBreakpoint)
+        self.assertIsNotNone(thread)
+
+        frame = thread.GetFrameAtIndex(0)
+        buf = frame.FindValue("buffer", lldb.eValueTypeVariableGlobal)
+        self.assertTrue(buf and buf.IsValid(), "buffer is valid")
+
+        error = lldb.SBError()
+        watch = buf.Watch(True, False, True, error)
+        self.assertTrue(error.Success() and watch.IsValid(), error.GetCString())
+        self.assertEqual(watch.GetWatchSize(), 3 * 4096)
+
+        # The write to "unwatched" may fault if it shares a page with the
+        # buffer, and a child's write is not seen, so only the write to the
+        # buffer's last byte may stop.
+        process.Continue()
+        self.assertEqual(process.GetState(), lldb.eStateStopped)
+        self.assertEqual(thread.GetStopReason(), lldb.eStopReasonWatchpoint)
+        self.assertEqual(thread.GetStopReasonDataAtIndex(0), watch.GetID())
+
+        self.assertTrue(target.DeleteWatchpoint(watch.GetID()))
+        process.Continue()
+        self.assertEqual(process.GetState(), lldb.eStateExited)
+        # The child, if any, exited normally.
+        self.assertEqual(process.GetExitStatus(), 0)
@@ -0,0 +1,41 @@
+//===-- main.c --------------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Larger than the debug registers can watch, and spanning several pages.
+char buffer[3 * 4096];
+int unwatched;
+
+// Write to the buffer from a child made with fork or vfork, which must not
+// crash on the pages protected for the watchpoint.
+int write_in_child(const char *how) {
+  pid_t pid = strcmp(how, "vfork") == 0 ? vfork() : fork();
+  if (pid == 0) {
+    buffer[0] = 'c';
+    _exit(0);
+  }
+  int status = 0;
+  if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+    return 1;
+  return WEXITSTATUS(status);
+}
+
+int main(int argc, char const *argv[]) {
+  int result = 0;
+  unwatched = 1; // Set break point at this line.
+  if (argc > 1)
+    result = write_in_child(argv[1]);
+  buffer[sizeof(buffer) - 1] = 'x';
+  printf("%c %d\n", buffer[sizeof(buffer) - 1], unwatched);
+  return result;
+}
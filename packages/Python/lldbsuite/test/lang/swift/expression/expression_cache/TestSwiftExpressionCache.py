@@ -0,0 +1,61 @@
+# TestSwiftExpressionCache.py
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2018 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See https://swift.org/LICENSE.txt for license information
+# See https://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ------------------------------------------------------------------------------
+"""
+Test that Swift expressions reused at later stops see the new values
+"""
+import lldb
+from lldbsuite.test.lldbtest import *
+import lldbsuite.test.decorators as decorators
+import lldbsuite.test.lldbutil as lldbutil
+
+
+class TestSwiftExpressionCache(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    @decorators.swiftTest
+    def test_swift_expression_cache(self):
+        """Test that cached Swift expressions are rematerialized"""
+        self.build()
+        lldbutil.run_to_source_breakpoint(
+            self, "Set breakpoint here", lldb.SBFileSpec("main.swift"))
+        lldbutil.run_break_set_by_source_regexp(
+            self, "Set generic breakpoint here")
+        lldbutil.run_break_set_by_source_regexp(
+            self, "Set method breakpoint here")
+
+        # The same expressions evaluated at every stop must see the current
+        # values of the variables.
+        for i in range(3):
+            self.expect("expression i + total", substrs=[str(i * i)])
+            self.expect("expression twice(i)", substrs=[str(2 * i)])
+            self.runCmd("continue")
+
+        # Expressions in generic functions depend on the bindings of the
+        # frame they were parsed in, so they must not be reused for a
+        # different T.
+        self.expect("expression value", substrs=["6"])
+        self.runCmd("continue")
+        self.expect("expression value", substrs=['"done"'])
+        self.runCmd("continue")
+
+        # Expressions in methods are compiled for the dynamic type of self.
+        # One parsed while self was a Derived must not be reused when self
+        # is a Base.
+        self.expect("expression self",
+                    substrs=["Derived", "derived_value = 2"])
+        self.expect("expression base_value", substrs=["1"])
+        self.runCmd("continue")
+        self.expect("expression self", substrs=["Base", "base_value = 1"])
+        self.expect("expression self", matching=False,
+                    substrs=["derived_value"])
+        self.expect("expression base_value", substrs=["1"])
@@ -0,0 +1,44 @@
+// main.swift
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2018 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+// -----------------------------------------------------------------------------
+
+func twice(_ value: Int) -> Int {
+  return value * 2
+}
+
+func describe<T>(_ value: T) -> String {
+  return "\(value)" // Set generic breakpoint here
+}
+
+class Base {
+  var base_value = 1
+
+  func show() -> Int {
+    return base_value // Set method breakpoint here
+  }
+}
+
+class Derived : Base {
+  var derived_value = 2
+}
+
+func main() {
+  var total = 0
+  for i in 0..<3 {
+    total += twice(i) // Set breakpoint here
+  }
+  print(describe(total))
+  print(describe("done"))
+  print(Derived().show())
+  print(Base().show())
+}
+
+main()
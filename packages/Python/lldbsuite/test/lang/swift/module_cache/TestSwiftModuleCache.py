@@ -0,0 +1,50 @@
+# TestSwiftModuleCache.py
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2018 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See https://swift.org/LICENSE.txt for license information
+# See https://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ------------------------------------------------------------------------------
+"""
+Tests that the Clang modules built for Swift go to target.module-cache-path
+"""
+
+import lldb
+from lldbsuite.test.lldbtest import *
+import lldbsuite.test.decorators as decorators
+import lldbsuite.test.lldbutil as lldbutil
+import os
+import shutil
+
+
+class TestSwiftModuleCache(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    @decorators.swiftTest
+    def test_swift_module_cache(self):
+        """Test that the module cache directory is created and populated"""
+        self.build()
+
+        module_cache = os.path.join(os.getcwd(), "module-cache")
+        shutil.rmtree(module_cache, ignore_errors=True)
+        self.addTearDownHook(
+            lambda: shutil.rmtree(module_cache, ignore_errors=True))
+
+        # The directory doesn't exist yet, LLDB has to create it.
+        self.runCmd("settings set target.module-cache-path " + module_cache)
+        self.addTearDownHook(
+            lambda: self.runCmd("settings clear target.module-cache-path"))
+
+        lldbutil.run_to_source_breakpoint(
+            self, "break here", lldb.SBFileSpec("main.swift"))
+        self.expect("expression value + 1", substrs=["43"])
+
+        self.assertTrue(os.path.isdir(module_cache),
+                        "module cache directory was created")
+        self.assertTrue(len(os.listdir(module_cache)) > 0,
+                        "module cache directory was populated")
@@ -1,6 +1,7 @@
 from __future__ import print_function
 
 import gdbremote_testcase
+import lldbgdbserverutils
 from lldbsuite.test.decorators import *
 from lldbsuite.test.lldbtest import *
 from lldbsuite.test import lldbutil
@@ -39,6 +40,77 @@ class TestGdbRemote_vCont(gdbremote_testcase.GdbRemoteTestCaseBase):
     def vCont_supports_S(self):
         self.vCont_supports_mode("S")
 
+    def range_step_stops_on_leaving_range(self):
+        # Start up the inferior and stop it before it calls swap_chars.
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=[
+                "get-code-address-hex:swap_chars",
+                "sleep:1",
+                "call-function:swap_chars",
+                "sleep:5"])
+        self.add_register_info_collection_packets()
+        self.add_process_info_collection_packets()
+        self.add_vCont_query_packets()
+        self.test_sequence.add_log_lines(
+            [  # Start running after initial stop.
+                "read packet: $c#63",
+                {"type": "output_match", "regex": r"^code address: 0x([0-9a-fA-F]+)\r\n$",
+                 "capture": {1: "function_address"}},
+                # Now stop the inferior.
+                "read packet: {}".format(chr(3)),
+                {"direction": "send", "regex": r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture": {1: "stop_signo", 2: "stop_thread_id"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        supported_vCont_modes = self.parse_vCont_query_response(context)
+        if "r" not in supported_vCont_modes:
+            self.skipTest("the stub does not support range stepping")
+
+        endian = self.parse_process_info_response(context).get("endian")
+        self.assertIsNotNone(endian)
+        reg_infos = self.parse_register_info_packets(context)
+        (pc_lldb_reg_index, pc_reg_info) = self.find_pc_reg_info(reg_infos)
+        self.assertIsNotNone(pc_lldb_reg_index)
+
+        main_thread_id = int(context.get("stop_thread_id"), 16)
+        function_address = int(context.get("function_address"), 16)
+
+        # Run to the start of swap_chars.
+        self.reset_test_sequence()
+        self.add_set_breakpoint_packets(function_address, do_continue=True)
+        self.assertIsNotNone(self.expect_gdbremote_sequence())
+        self.reset_test_sequence()
+        self.add_remove_breakpoint_packets(function_address)
+        self.assertIsNotNone(self.expect_gdbremote_sequence())
+
+        # Step through the first few bytes of the function.  The stub should
+        # report a single trace stop, once the pc has left the range.
+        range_start = function_address
+        range_end = function_address + 8
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $vCont;r{0:x},{1:x}:{2:x}#00".format(
+                range_start, range_end, main_thread_id),
+             {"direction": "send",
+              "regex": r"^\$T([0-9a-fA-F]{2})([^#]+)#[0-9a-fA-F]{2}$",
+              "capture": {1: "stop_signo", 2: "key_vals_text"}},
+             "read packet: $p{0:x}#00".format(pc_lldb_reg_index),
+             {"direction": "send", "regex": r"^\$([0-9a-fA-F]+)#",
+              "capture": {1: "p_response"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        key_vals = self.parse_key_val_dict(context.get("key_vals_text"))
+        self.assertEqual(key_vals.get("reason"), "trace")
+        self.assertEqual(int(key_vals.get("thread"), 16), main_thread_id)
+
+        pc = lldbgdbserverutils.unpack_register_hex_unsigned(
+            endian, context.get("p_response"))
+        self.assertFalse(range_start <= pc < range_end,
+                         "pc 0x{:x} is still inside the stepped range".format(pc))
+
     @expectedFailureAll(oslist=["ios", "tvos", "watchos", "bridgeos"], bugnumber="rdar://27005337")
     @debugserver_test
     def test_vCont_supports_c_debugserver(self):
@@ -157,3 +229,12 @@ class TestGdbRemote_vCont(gdbremote_testcase.GdbRemoteTestCaseBase):
         self.set_inferior_startup_launch()
         self.single_step_only_steps_one_instruction(
             use_Hc_packet=False, step_instruction="vCont;s:{thread}")
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    @skipIf(archs=no_match(['i386', 'x86_64']))
+    def test_vCont_r_stops_on_leaving_range_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.range_step_stops_on_leaving_range()
@@ -9,6 +9,8 @@
 
 // C Includes
 // C++ Includes
+#include <algorithm>
+
 // Other libraries and framework includes
 // Project includes
 #include "lldb/Breakpoint/BreakpointLocation.h"
@@ -349,6 +351,23 @@ void BreakpointLocation::SetIgnoreCount(uint32_t n) {
   SendBreakpointLocationChangedEvent(eBreakpointEventTypeIgnoreChanged);
 }
 
+void BreakpointLocation::AddSkippedHits(uint32_t hit_count,
+                                        uint32_t ignored_count) {
+  // Each ignored hit decrements the location's own ignore count, if it has
+  // one, and the breakpoint's, just like IgnoreCountShouldStop.
+  if (m_options_ap.get() != nullptr) {
+    const uint32_t loc_ignore = m_options_ap->GetIgnoreCount();
+    m_options_ap->SetIgnoreCount(loc_ignore -
+                                 std::min(loc_ignore, ignored_count));
+  }
+  const uint32_t bp_ignore = m_owner.GetIgnoreCount();
+  m_owner.GetOptions()->SetIgnoreCount(bp_ignore -
+                                       std::min(bp_ignore, ignored_count));
+
+  IncrementHitCount(hit_count);
+  m_owner.IncrementHitCount(hit_count);
+}
+
 void BreakpointLocation::DecrementIgnoreCount() {
   if (m_options_ap.get() != nullptr) {
     uint32_t loc_ignore = m_options_ap->GetIgnoreCount();
@@ -18,6 +18,7 @@
 #include "lldb/Core/ArchSpec.h"
 #include "lldb/Core/Module.h"
 #include "lldb/Core/Section.h"
+#include "lldb/Target/Process.h"
 #include "lldb/Target/SectionLoadList.h"
 #include "lldb/Target/Target.h"
 
@@ -158,6 +159,13 @@ const BreakpointLocationSP BreakpointLocationList::GetByIndex(size_t i) const {
 
 void BreakpointLocationList::ClearAllBreakpointSites() {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  // Let the process remove all the sites at once.
+  ProcessSP process_sp(m_owner.GetTarget().GetProcessSP());
+  if (process_sp) {
+    process_sp->RemoveOwnersFromBreakpointSites(m_locations);
+    return;
+  }
+
   collection::iterator pos, end = m_locations.end();
   for (pos = m_locations.begin(); pos != end; ++pos)
     (*pos)->ClearBreakpointSite();
@@ -165,12 +173,18 @@ void BreakpointLocationList::ClearAllBreakpointSites() {
 
 void BreakpointLocationList::ResolveAllBreakpointSites() {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
-  collection::iterator pos, end = m_locations.end();
+  Process *process = m_owner.GetTarget().GetProcessSP().get();
+  if (process == nullptr)
+    return;
 
+  // Let the process enable all the new sites at once.
+  collection unresolved_locations;
+  collection::iterator pos, end = m_locations.end();
   for (pos = m_locations.begin(); pos != end; ++pos) {
-    if ((*pos)->IsEnabled())
-      (*pos)->ResolveBreakpointSite();
+    if ((*pos)->IsEnabled() && !(*pos)->IsResolved())
+      unresolved_locations.push_back(*pos);
   }
+  process->CreateBreakpointSites(unresolved_locations);
 }
 
 uint32_t BreakpointLocationList::GetHitCount() const {
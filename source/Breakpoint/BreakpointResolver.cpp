@@ -11,6 +11,9 @@
 
 // C Includes
 // C++ Includes
+#include <atomic>
+#include <thread>
+
 // Other libraries and framework includes
 // Project includes
 #include "lldb/Breakpoint/Breakpoint.h"
@@ -169,11 +172,52 @@ void BreakpointResolver::SetBreakpoint(Breakpoint *bkpt) {
 
 void BreakpointResolver::ResolveBreakpointInModules(SearchFilter &filter,
                                                     ModuleList &modules) {
+  PrefetchModules(filter, modules);
   filter.SearchInModuleList(*this, modules);
+  ClearPrefetchedModules();
 }
 
 void BreakpointResolver::ResolveBreakpoint(SearchFilter &filter) {
+  if (m_breakpoint)
+    PrefetchModules(filter, m_breakpoint->GetTarget().GetImages());
   filter.Search(*this);
+  ClearPrefetchedModules();
+}
+
+void BreakpointResolver::PrefetchModules(SearchFilter &filter,
+                                         const ModuleList &modules) {
+  if (!CanPrefetchModules() || GetDepth() != Searcher::eDepthModule)
+    return;
+
+  std::vector<ModuleSP> module_sps;
+  {
+    std::lock_guard<std::recursive_mutex> guard(modules.GetMutex());
+    const size_t num_modules = modules.GetSize();
+    for (size_t i = 0; i < num_modules; ++i) {
+      ModuleSP module_sp(modules.GetModuleAtIndexUnlocked(i));
+      if (module_sp && filter.ModulePasses(module_sp))
+        module_sps.push_back(module_sp);
+    }
+  }
+  if (module_sps.size() < 2)
+    return;
+
+  // Use threads of our own rather than the task pool: looking up names can
+  // index a module's debug info, which waits on tasks of its own in the
+  // pool, and would never see them run if we held all of its threads.
+  const size_t num_threads = std::min<size_t>(
+      module_sps.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::atomic<size_t> next_module(0);
+  auto worker = [&]() {
+    for (size_t i = next_module++; i < module_sps.size(); i = next_module++)
+      PrefetchModule(filter, module_sps[i]);
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_threads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread &thread : threads)
+    thread.join();
 }
 
 void BreakpointResolver::SetSCMatchesByLine(SearchFilter &filter,
@@ -195,18 +195,19 @@ BreakpointResolverFileLine::SearchCallback(SearchFilter &filter,
   // through the match list and pull out the sets that have the same file spec
   // in their line_entry and treat each set separately.
 
-  const size_t num_comp_units = context.module_sp->GetNumCompileUnits();
-  const bool force_check_inlines =
-      context.module_sp->GetSymbolVendor()->ForceInlineSourceFileCheck();
-  for (size_t i = 0; i < num_comp_units; i++) {
-    CompUnitSP cu_sp(context.module_sp->GetCompileUnitAtIndex(i));
-    if (cu_sp) {
-      if (filter.CompUnitPasses(*cu_sp))
-        cu_sp->ResolveSymbolContext(
-            m_file_spec, m_line_number, m_inlines | force_check_inlines,
-            m_exact_match, eSymbolContextEverything, sc_list);
+  // Use the matches PrefetchModule already found, if it saw this module.
+  bool prefetched = false;
+  {
+    std::lock_guard<std::mutex> guard(m_prefetched_mutex);
+    auto pos = m_prefetched_matches.find(context.module_sp.get());
+    if (pos != m_prefetched_matches.end()) {
+      sc_list = pos->second;
+      m_prefetched_matches.erase(pos);
+      prefetched = true;
     }
   }
+  if (!prefetched)
+    FindMatches(filter, context.module_sp, sc_list);
 
   FilterContexts(sc_list);
 
@@ -219,6 +220,42 @@ BreakpointResolverFileLine::SearchCallback(SearchFilter &filter,
   return Searcher::eCallbackReturnContinue;
 }
 
+void BreakpointResolverFileLine::FindMatches(SearchFilter &filter,
+                                             const ModuleSP &module_sp,
+                                             SymbolContextList &sc_list) {
+  // Don't walk the compile units of modules that can't have the file.
+  if (!module_sp->MightContainSourceFile(m_file_spec))
+    return;
+
+  const size_t num_comp_units = module_sp->GetNumCompileUnits();
+  const bool force_check_inlines =
+      module_sp->GetSymbolVendor()->ForceInlineSourceFileCheck();
+  for (size_t i = 0; i < num_comp_units; i++) {
+    CompUnitSP cu_sp(module_sp->GetCompileUnitAtIndex(i));
+    if (cu_sp) {
+      if (filter.CompUnitPasses(*cu_sp))
+        cu_sp->ResolveSymbolContext(
+            m_file_spec, m_line_number, m_inlines | force_check_inlines,
+            m_exact_match, eSymbolContextEverything, sc_list);
+    }
+  }
+}
+
+bool BreakpointResolverFileLine::CanPrefetchModules() { return true; }
+
+void BreakpointResolverFileLine::PrefetchModule(SearchFilter &filter,
+                                                const ModuleSP &module_sp) {
+  SymbolContextList sc_list;
+  FindMatches(filter, module_sp, sc_list);
+  std::lock_guard<std::mutex> guard(m_prefetched_mutex);
+  m_prefetched_matches[module_sp.get()] = sc_list;
+}
+
+void BreakpointResolverFileLine::ClearPrefetchedModules() {
+  std::lock_guard<std::mutex> guard(m_prefetched_mutex);
+  m_prefetched_matches.clear();
+}
+
 Searcher::Depth BreakpointResolverFileLine::GetDepth() {
   return Searcher::eDepthModule;
 }
@@ -256,32 +256,11 @@ void BreakpointResolverName::AddNameLookup(const ConstString &name,
   }
 }
 
-// FIXME: Right now we look at the module level, and call the module's
-// "FindFunctions".
-// Greg says he will add function tables, maybe at the CompileUnit level to
-// accelerate function
-// lookup.  At that point, we should switch the depth to CompileUnit, and look
-// in these tables.
-
-Searcher::CallbackReturn
-BreakpointResolverName::SearchCallback(SearchFilter &filter,
-                                       SymbolContext &context, Address *addr,
-                                       bool containing) {
-  SymbolContextList func_list;
-  // SymbolContextList sym_list;
-
-  uint32_t i;
-  bool new_location;
-  Address break_addr;
-  assert(m_breakpoint != nullptr);
-
+void BreakpointResolverName::FindFunctions(SearchFilter &filter,
+                                           const ModuleSP &module_sp,
+                                           SymbolContextList &func_list) {
   Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
 
-  if (m_class_name) {
-    if (log)
-      log->Warning("Class/method function specification not supported yet.\n");
-    return Searcher::eCallbackReturnStop;
-  }
   bool filter_by_cu =
       (filter.GetFilterRequiredItems() & eSymbolContextCompUnit) != 0;
   bool filter_by_language = (m_language != eLanguageTypeUnknown);
@@ -291,10 +270,10 @@ BreakpointResolverName::SearchCallback(SearchFilter &filter,
 
   switch (m_match_type) {
   case Breakpoint::Exact:
-    if (context.module_sp) {
+    if (module_sp) {
       for (const auto &lookup : m_lookups) {
         const size_t start_func_idx = func_list.GetSize();
-        context.module_sp->FindFunctions(
+        module_sp->FindFunctions(
             lookup.GetLookupName(), nullptr, lookup.GetNameTypeMask(),
             include_symbols, include_inlines, append, func_list);
 
@@ -306,8 +285,8 @@ BreakpointResolverName::SearchCallback(SearchFilter &filter,
     }
     break;
   case Breakpoint::Regexp:
-    if (context.module_sp) {
-      context.module_sp->FindFunctions(
+    if (module_sp) {
+      module_sp->FindFunctions(
           m_regex,
           !filter_by_cu, // include symbols only if we aren't filtering by CU
           include_inlines, append, func_list);
@@ -349,6 +328,65 @@ BreakpointResolverName::SearchCallback(SearchFilter &filter,
       }
     }
   }
+}
+
+bool BreakpointResolverName::CanPrefetchModules() {
+  return !m_class_name && m_match_type != Breakpoint::Glob;
+}
+
+void BreakpointResolverName::PrefetchModule(SearchFilter &filter,
+                                            const ModuleSP &module_sp) {
+  SymbolContextList func_list;
+  FindFunctions(filter, module_sp, func_list);
+  std::lock_guard<std::mutex> guard(m_prefetched_mutex);
+  m_prefetched_functions[module_sp.get()] = func_list;
+}
+
+void BreakpointResolverName::ClearPrefetchedModules() {
+  std::lock_guard<std::mutex> guard(m_prefetched_mutex);
+  m_prefetched_functions.clear();
+}
+
+// FIXME: Right now we look at the module level, and call the module's
+// "FindFunctions".
+// Greg says he will add function tables, maybe at the CompileUnit level to
+// accelerate function
+// lookup.  At that point, we should switch the depth to CompileUnit, and look
+// in these tables.
+
+Searcher::CallbackReturn
+BreakpointResolverName::SearchCallback(SearchFilter &filter,
+                                       SymbolContext &context, Address *addr,
+                                       bool containing) {
+  SymbolContextList func_list;
+  // SymbolContextList sym_list;
+
+  uint32_t i;
+  bool new_location;
+  Address break_addr;
+  assert(m_breakpoint != nullptr);
+
+  Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+
+  if (m_class_name) {
+    if (log)
+      log->Warning("Class/method function specification not supported yet.\n");
+    return Searcher::eCallbackReturnStop;
+  }
+
+  // Use the functions PrefetchModule already found, if it saw this module.
+  bool prefetched = false;
+  {
+    std::lock_guard<std::mutex> guard(m_prefetched_mutex);
+    auto pos = m_prefetched_functions.find(context.module_sp.get());
+    if (pos != m_prefetched_functions.end()) {
+      func_list = pos->second;
+      m_prefetched_functions.erase(pos);
+      prefetched = true;
+    }
+  }
+  if (!prefetched)
+    FindFunctions(filter, context.module_sp, func_list);
 
   // Remove any duplicates between the function list and the symbol list
   SymbolContext sc;
@@ -19,7 +19,8 @@
 using namespace lldb;
 using namespace lldb_private;
 
-BreakpointSiteList::BreakpointSiteList() : m_mutex(), m_bp_site_list() {}
+BreakpointSiteList::BreakpointSiteList()
+    : m_mutex(), m_bp_site_list(), m_snapshot_sp() {}
 
 BreakpointSiteList::~BreakpointSiteList() {}
 
@@ -34,6 +35,7 @@ lldb::break_id_t BreakpointSiteList::Add(const BreakpointSiteSP &bp) {
 
   if (iter == m_bp_site_list.end()) {
     m_bp_site_list.insert(iter, collection::value_type(bp_site_load_addr, bp));
+    InvalidateSnapshot();
     return bp->GetID();
   } else {
     return LLDB_INVALID_BREAK_ID;
@@ -70,6 +72,7 @@ bool BreakpointSiteList::Remove(lldb::break_id_t break_id) {
   collection::iterator pos = GetIDIterator(break_id); // Predicate
   if (pos != m_bp_site_list.end()) {
     m_bp_site_list.erase(pos);
+    InvalidateSnapshot();
     return true;
   }
   return false;
@@ -80,6 +83,7 @@ bool BreakpointSiteList::RemoveByAddress(lldb::addr_t address) {
   collection::iterator pos = m_bp_site_list.find(address);
   if (pos != m_bp_site_list.end()) {
     m_bp_site_list.erase(pos);
+    InvalidateSnapshot();
     return true;
   }
   return false;
@@ -134,13 +138,40 @@ BreakpointSiteList::FindByID(lldb::break_id_t break_id) const {
   return stop_sp;
 }
 
-BreakpointSiteSP BreakpointSiteList::FindByAddress(lldb::addr_t addr) {
-  BreakpointSiteSP found_sp;
+BreakpointSiteList::SnapshotSP BreakpointSiteList::GetSnapshot() const {
+  SnapshotSP snapshot_sp = std::atomic_load(&m_snapshot_sp);
+  if (snapshot_sp)
+    return snapshot_sp;
+
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
-  collection::iterator iter = m_bp_site_list.find(addr);
-  if (iter != m_bp_site_list.end())
-    found_sp = iter->second;
-  return found_sp;
+  // Somebody else may have built it while we waited for the lock.
+  snapshot_sp = std::atomic_load(&m_snapshot_sp);
+  if (snapshot_sp)
+    return snapshot_sp;
+
+  std::shared_ptr<Snapshot> new_snapshot_sp = std::make_shared<Snapshot>();
+  new_snapshot_sp->addrs.reserve(m_bp_site_list.size());
+  new_snapshot_sp->sites.reserve(m_bp_site_list.size());
+  for (const auto &pair : m_bp_site_list) {
+    new_snapshot_sp->addrs.push_back(pair.first);
+    new_snapshot_sp->sites.push_back(pair.second);
+  }
+  snapshot_sp = new_snapshot_sp;
+  std::atomic_store(&m_snapshot_sp, snapshot_sp);
+  return snapshot_sp;
+}
+
+void BreakpointSiteList::InvalidateSnapshot() {
+  std::atomic_store(&m_snapshot_sp, SnapshotSP());
+}
+
+BreakpointSiteSP BreakpointSiteList::FindByAddress(lldb::addr_t addr) {
+  SnapshotSP snapshot_sp = GetSnapshot();
+  const std::vector<lldb::addr_t> &addrs = snapshot_sp->addrs;
+  auto pos = std::lower_bound(addrs.begin(), addrs.end(), addr);
+  if (pos == addrs.end() || *pos != addr)
+    return BreakpointSiteSP();
+  return snapshot_sp->sites[pos - addrs.begin()];
 }
 
 bool BreakpointSiteList::BreakpointSiteContainsBreakpoint(
@@ -173,6 +204,29 @@ void BreakpointSiteList::ForEach(
     callback(pair.second.get());
 }
 
+void BreakpointSiteList::ForEachInRange(
+    lldb::addr_t lower_bound, lldb::addr_t upper_bound,
+    std::function<void(BreakpointSite *)> const &callback) const {
+  if (lower_bound >= upper_bound)
+    return;
+
+  SnapshotSP snapshot_sp = GetSnapshot();
+  const std::vector<lldb::addr_t> &addrs = snapshot_sp->addrs;
+  size_t idx =
+      std::lower_bound(addrs.begin(), addrs.end(), lower_bound) - addrs.begin();
+
+  // Sites don't overlap each other, so only the one right before the range
+  // can reach into it.
+  if (idx > 0) {
+    BreakpointSite *prev_site = snapshot_sp->sites[idx - 1].get();
+    if (prev_site->GetLoadAddress() + prev_site->GetByteSize() > lower_bound)
+      callback(prev_site);
+  }
+
+  for (; idx < addrs.size() && addrs[idx] < upper_bound; ++idx)
+    callback(snapshot_sp->sites[idx].get());
+}
+
 bool BreakpointSiteList::FindInRange(lldb::addr_t lower_bound,
                                      lldb::addr_t upper_bound,
                                      BreakpointSiteList &bp_site_list) const {
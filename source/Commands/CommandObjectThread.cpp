@@ -146,6 +146,11 @@ public:
     }
 
     if (m_unique_stacks) {
+      // Bucketing needs every frame of every thread, so unwind them all in
+      // parallel first.
+      m_exe_ctx.GetProcessPtr()->GetThreadList().ComputeStackFrames(
+          tids, UINT32_MAX);
+
       // Iterate over threads, finding unique stack buckets.
       std::set<UniqueStack> unique_stacks;
       for (const lldb::tid_t &tid : tids) {
@@ -176,6 +181,9 @@ public:
         }
       }
     } else {
+      if (tids.size() > 1)
+        WillHandleThreads(tids);
+
       uint32_t idx = 0;
       for (const lldb::tid_t &tid : tids) {
         if (idx != 0 && m_add_return)
@@ -203,6 +211,10 @@ protected:
 
   virtual bool HandleOneThread(lldb::tid_t, CommandReturnObject &result) = 0;
 
+  // Override this to do any work for all of the threads up front, before
+  // HandleOneThread is called on each of them in turn.
+  virtual void WillHandleThreads(const std::vector<lldb::tid_t> &tids) {}
+
   bool BucketThread(lldb::tid_t tid, std::set<UniqueStack> &unique_stacks,
                     CommandReturnObject &result) {
     // Grab the corresponding thread for the given thread id.
@@ -361,6 +373,16 @@ protected:
     }
   }
 
+  void WillHandleThreads(const std::vector<lldb::tid_t> &tids) override {
+    // Only unwind as deep as the frames that will be printed.
+    uint32_t end_idx = UINT32_MAX;
+    if (m_options.m_count != UINT32_MAX &&
+        m_options.m_count < UINT32_MAX - m_options.m_start)
+      end_idx = m_options.m_start + m_options.m_count;
+    m_exe_ctx.GetProcessPtr()->GetThreadList().ComputeStackFrames(tids,
+                                                                  end_idx);
+  }
+
   bool HandleOneThread(lldb::tid_t tid, CommandReturnObject &result) override {
     ThreadSP thread_sp =
         m_exe_ctx.GetProcessPtr()->GetThreadList().FindThreadByID(tid);
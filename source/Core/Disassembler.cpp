@@ -195,6 +195,29 @@ lldb::DisassemblerSP Disassembler::DisassembleRange(
     bool prefer_file_cache) {
   lldb::DisassemblerSP disasm_sp;
   if (range.GetByteSize() > 0 && range.GetBaseAddress().IsValid()) {
+    // Code read from the object file of a module doesn't change, so share
+    // the decoded instructions with everyone else disassembling the same
+    // range of that module.
+    ModuleSP module_sp;
+    std::string cache_key;
+    if (prefer_file_cache) {
+      module_sp = range.GetBaseAddress().GetModule();
+      if (module_sp) {
+        const char *cache_flavor = flavor;
+        TargetSP target_sp = exe_ctx.GetTargetSP();
+        if (cache_flavor == nullptr && target_sp)
+          cache_flavor = target_sp->GetDisassemblyFlavor();
+        cache_key = arch.GetTriple().getTriple();
+        cache_key.append(1, ';').append(cache_flavor ? cache_flavor : "");
+        cache_key.append(1, ';').append(plugin_name ? plugin_name : "");
+        disasm_sp = module_sp->GetCachedDisassembly(
+            range.GetBaseAddress().GetFileAddress(), range.GetByteSize(),
+            cache_key);
+        if (disasm_sp)
+          return disasm_sp;
+      }
+    }
+
     disasm_sp = Disassembler::FindPluginForTarget(exe_ctx.GetTargetSP(), arch,
                                                   flavor, plugin_name);
 
@@ -203,6 +226,10 @@ lldb::DisassemblerSP Disassembler::DisassembleRange(
           &exe_ctx, range, nullptr, prefer_file_cache);
       if (bytes_disassembled == 0)
         disasm_sp.reset();
+      else if (module_sp)
+        module_sp->CacheDisassembly(range.GetBaseAddress().GetFileAddress(),
+                                    range.GetByteSize(), cache_key,
+                                    disasm_sp);
     }
   }
   return disasm_sp;
@@ -462,6 +462,59 @@ CompUnitSP Module::GetCompileUnitAtIndex(size_t index) {
   return cu_sp;
 }
 
+bool Module::MightContainSourceFile(const FileSpec &file_spec) {
+  const ConstString &file_name = file_spec.GetFilename();
+  if (!file_name || !file_spec.IsCaseSensitive())
+    return true;
+
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  SymbolVendor *symbols = GetSymbolVendor();
+  if (!symbols || symbols->ForceInlineSourceFileCheck())
+    return true;
+
+  if (!m_did_index_source_files) {
+    const size_t num_comp_units = GetNumCompileUnits();
+    for (size_t i = 0; i < num_comp_units; ++i) {
+      CompUnitSP cu_sp(GetCompileUnitAtIndex(i));
+      if (!cu_sp)
+        continue;
+      const FileSpecList &support_files = cu_sp->GetSupportFiles();
+      const size_t num_files = support_files.GetSize();
+      for (size_t j = 0; j < num_files; ++j)
+        m_source_file_names.insert(
+            support_files.GetFileSpecAtIndex(j).GetFilename().GetCString());
+      m_source_file_names.insert(cu_sp->GetFilename().GetCString());
+    }
+    m_did_index_source_files = true;
+  }
+  return m_source_file_names.count(file_name.GetCString()) != 0;
+}
+
+lldb::DisassemblerSP Module::GetCachedDisassembly(lldb::addr_t file_addr,
+                                                  lldb::addr_t byte_size,
+                                                  llvm::StringRef key) {
+  std::lock_guard<std::mutex> guard(m_disassembly_cache_mutex);
+  auto pos = m_disassembly_cache.find(
+      DisassemblyCacheKey(file_addr, byte_size, key.str()));
+  if (pos == m_disassembly_cache.end())
+    return lldb::DisassemblerSP();
+  return pos->second;
+}
+
+void Module::CacheDisassembly(lldb::addr_t file_addr, lldb::addr_t byte_size,
+                              llvm::StringRef key,
+                              const lldb::DisassemblerSP &disasm_sp) {
+  // Bound the memory used by modules that have a lot of code stepped
+  // through or symbolicated; dropping everything is good enough since
+  // the ranges in use will be repopulated on the next stop.
+  static const size_t g_max_cached_ranges = 4096;
+  std::lock_guard<std::mutex> guard(m_disassembly_cache_mutex);
+  if (m_disassembly_cache.size() >= g_max_cached_ranges)
+    m_disassembly_cache.clear();
+  m_disassembly_cache[DisassemblyCacheKey(file_addr, byte_size, key.str())] =
+      disasm_sp;
+}
+
 bool Module::ResolveFileAddress(lldb::addr_t vm_addr, Address &so_addr) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
   static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
@@ -1545,6 +1598,8 @@ void Module::SetSymbolFileFileSpec(const FileSpec &file) {
   m_symfile_spec = file;
   m_symfile_ap.reset();
   m_did_load_symbol_vendor = false;
+  m_did_index_source_files = false;
+  m_source_file_names.clear();
 }
 
 bool Module::IsExecutable() {
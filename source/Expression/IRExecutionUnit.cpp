@@ -12,6 +12,11 @@
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -20,6 +25,7 @@
 #include "lldb/Core/Module.h"
 #include "lldb/Core/Section.h"
 #include "lldb/Expression/IRExecutionUnit.h"
+#include "lldb/Host/HostInfo.h"
 #include "lldb/Symbol/CompileUnit.h"
 #include "lldb/Symbol/SymbolContext.h"
 #include "lldb/Symbol/SymbolFile.h"
@@ -35,8 +41,94 @@
 
 #include "lldb/../../source/Plugins/Language/CPlusPlus/CPlusPlusLanguage.h"
 
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
 using namespace lldb_private;
 
+// Objects past this total size are removed from the JIT object cache, oldest
+// first.  Helpers that bake in process addresses produce new objects in every
+// session, so without a bound the cache would grow forever.
+static const uint64_t g_max_object_cache_size = 64 * 1024 * 1024;
+
+// Code loaded from the JIT object cache runs in the inferior, so the cache
+// only uses files and directories that belong to the current user and that
+// nobody else can read or write.
+static bool IsPrivateToUser(const llvm::sys::fs::file_status &status) {
+#if !defined(_WIN32)
+  if (status.getUser() != HostInfo::GetEffectiveUserID())
+    return false;
+  if (status.permissions() &
+      (llvm::sys::fs::group_all | llvm::sys::fs::others_all))
+    return false;
+#endif
+  return true;
+}
+
+static bool GetObjectCacheDirectory(std::string &directory) {
+  Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS));
+
+  llvm::SmallString<256> path;
+  if (!llvm::sys::path::user_cache_directory(path, "lldb", "jit-objects"))
+    return false;
+  if (llvm::sys::fs::create_directories(path, true,
+                                        llvm::sys::fs::owner_all))
+    return false;
+
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path, status) ||
+      status.type() != llvm::sys::fs::file_type::directory_file ||
+      !IsPrivateToUser(status)) {
+    if (log)
+      log->Printf("Not caching JIT object code: %s isn't a directory that "
+                  "only the current user can access",
+                  path.c_str());
+    return false;
+  }
+
+  directory = path.str();
+  return true;
+}
+
+static void PruneObjectCache(const std::string &directory) {
+  struct CachedObject {
+    llvm::sys::TimePoint<> time;
+    uint64_t size;
+    std::string path;
+  };
+  std::vector<CachedObject> objects;
+  uint64_t total_size = 0;
+
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(directory, ec), end;
+       it != end && !ec; it.increment(ec)) {
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(it->path(), status) ||
+        status.type() != llvm::sys::fs::file_type::regular_file)
+      continue;
+    objects.push_back(
+        {status.getLastModificationTime(), status.getSize(), it->path()});
+    total_size += status.getSize();
+  }
+
+  if (total_size <= g_max_object_cache_size)
+    return;
+
+  std::sort(objects.begin(), objects.end(),
+            [](const CachedObject &lhs, const CachedObject &rhs) {
+              return lhs.time < rhs.time;
+            });
+  for (const CachedObject &object : objects) {
+    if (total_size <= g_max_object_cache_size)
+      break;
+    if (!llvm::sys::fs::remove(object.path))
+      total_size -= object.size;
+  }
+}
+
 IRExecutionUnit::IRExecutionUnit(std::unique_ptr<llvm::LLVMContext> &context_ap,
                                  std::unique_ptr<llvm::Module> &module_ap,
                                  ConstString &name,
@@ -46,7 +138,7 @@ IRExecutionUnit::IRExecutionUnit(std::unique_ptr<llvm::LLVMContext> &context_ap,
     : IRMemoryMap(target_sp), m_context_ap(context_ap.release()),
       m_module_ap(module_ap.release()), m_jit_module_wp(),
       m_module(m_module_ap.get()), m_cpu_features(cpu_features), m_name(name),
-      m_sym_ctx(sym_ctx), m_did_jit(false),
+      m_sym_ctx(sym_ctx), m_did_jit(false), m_use_object_cache(false),
       m_function_load_addr(LLDB_INVALID_ADDRESS),
       m_function_end_load_addr(LLDB_INVALID_ADDRESS),
       m_reported_allocations(false) {}
@@ -347,9 +439,136 @@ void IRExecutionUnit::GetRunnableInfo(Status &error, lldb::addr_t &func_addr,
     }
   };
 
+  // Keeps the object code of each module in the user's cache directory,
+  // named by a hash of the module's IR, the CPU features and the LLDB
+  // version.  Identical IR produces identical object code, so a hit lets the
+  // JIT skip code generation entirely.
+  class PersistentObjectCache : public llvm::ObjectCache {
+  public:
+    PersistentObjectCache(const std::string &directory,
+                          const std::vector<std::string> &cpu_features)
+        : m_directory(directory), m_cpu_features(cpu_features) {}
+
+    void notifyObjectCompiled(const llvm::Module *module,
+                              llvm::MemoryBufferRef object) override {
+      std::string path = GetPath(module);
+      if (llvm::sys::fs::create_directories(m_directory, true,
+                                            llvm::sys::fs::owner_all))
+        return;
+
+      // Write to a temporary file and rename it into place, so that other
+      // sessions never see a partially written object.
+      int fd = 0;
+      llvm::SmallString<256> temp_path;
+      if (llvm::sys::fs::createUniqueFile(m_directory + "/tmp-%%%%%%%%.o", fd,
+                                          temp_path))
+        return;
+#if !defined(_WIN32)
+      // The file is created readable by everyone, less the umask, and
+      // getObject ignores objects other users can access.
+      if (::fchmod(fd, S_IRUSR | S_IWUSR) != 0) {
+        llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+        llvm::sys::fs::remove(temp_path);
+        return;
+      }
+#endif
+
+      bool write_failed = false;
+      {
+        llvm::raw_fd_ostream fds(fd, true);
+        fds.write(object.getBufferStart(), object.getBufferSize());
+        fds.close();
+        write_failed = fds.has_error();
+        fds.clear_error();
+      }
+
+      if (write_failed || llvm::sys::fs::rename(temp_path, path)) {
+        llvm::sys::fs::remove(temp_path);
+        return;
+      }
+
+      PruneObjectCache(m_directory);
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer>
+    getObject(const llvm::Module *module) override {
+      std::string path = GetPath(module);
+      int fd = -1;
+      if (llvm::sys::fs::openFileForRead(path, fd))
+        return nullptr;
+
+      // Check the file that was actually opened, so that it can't be
+      // swapped between the check and the read.
+      Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS));
+      llvm::sys::fs::file_status status;
+      if (llvm::sys::fs::status(fd, status) ||
+          status.type() != llvm::sys::fs::file_type::regular_file ||
+          !IsPrivateToUser(status)) {
+        if (log)
+          log->Printf("Ignoring cached JIT object code in %s: it isn't a "
+                      "file that only the current user can access",
+                      path.c_str());
+        llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+        return nullptr;
+      }
+
+      auto buffer_or_error =
+          llvm::MemoryBuffer::getOpenFile(fd, path, status.getSize());
+      llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+      if (!buffer_or_error)
+        return nullptr;
+
+      if (log)
+        log->Printf("Loaded JIT object code for %s from %s",
+                    module->getModuleIdentifier().c_str(), path.c_str());
+      return std::move(*buffer_or_error);
+    }
+
+  private:
+    std::string GetPath(const llvm::Module *module) {
+      if (module == m_module && !m_path.empty())
+        return m_path;
+
+      std::string ir;
+      llvm::raw_string_ostream ir_stream(ir);
+      module->print(ir_stream, nullptr);
+      ir_stream.flush();
+
+      llvm::MD5 hash;
+      hash.update(lldb_private::GetVersion());
+      for (const std::string &feature : m_cpu_features)
+        hash.update(feature);
+      hash.update(ir);
+      llvm::MD5::MD5Result result;
+      hash.final(result);
+      llvm::SmallString<32> digest;
+      llvm::MD5::stringifyResult(result, digest);
+
+      llvm::SmallString<256> path(m_directory);
+      llvm::sys::path::append(path, digest.str() + ".o");
+
+      m_module = module;
+      m_path = path.str();
+      return m_path;
+    }
+
+    std::string m_directory;
+    std::vector<std::string> m_cpu_features;
+    const llvm::Module *m_module = nullptr;
+    std::string m_path;
+  };
+
   if (process_sp->GetTarget().GetEnableSaveObjects()) {
     m_object_cache_ap = llvm::make_unique<ObjectDumper>();
     m_execution_engine_ap->setObjectCache(m_object_cache_ap.get());
+  } else if (m_use_object_cache &&
+             process_sp->GetTarget().GetEnableCacheObjects()) {
+    std::string cache_dir;
+    if (GetObjectCacheDirectory(cache_dir)) {
+      m_object_cache_ap = llvm::make_unique<PersistentObjectCache>(
+          cache_dir, m_cpu_features);
+      m_execution_engine_ap->setObjectCache(m_object_cache_ap.get());
+    }
   }
 
   // Make sure we see all sections, including ones that don't have
@@ -39,6 +39,8 @@
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cmath>
+#include <cstring>
 #include <map>
 
 using namespace llvm;
@@ -82,6 +84,8 @@ static bool CanIgnoreCall(const CallInst *call) {
       break;
     case llvm::Intrinsic::dbg_declare:
     case llvm::Intrinsic::dbg_value:
+    case llvm::Intrinsic::lifetime_start:
+    case llvm::Intrinsic::lifetime_end:
       return true;
     }
   }
@@ -89,6 +93,148 @@ static bool CanIgnoreCall(const CallInst *call) {
   return false;
 }
 
+static bool IsSupportedFloatType(const Type *type) {
+  return type->isFloatTy() || type->isDoubleTy();
+}
+
+// Converting a NaN, or a value whose integer part doesn't fit, to an integer
+// is undefined, both in the IR and on the host.
+static bool FloatFitsInInteger(double value, unsigned bits, bool is_signed) {
+  if (std::isnan(value) || bits == 0 || bits > 64)
+    return false;
+  const double integer_part = std::trunc(value);
+  const double limit = std::ldexp(1.0, is_signed ? bits - 1 : bits);
+  const double lowest = is_signed ? -limit : 0.0;
+  return integer_part >= lowest && integer_part < limit;
+}
+
+// Pure math functions the interpreter computes itself instead of calling
+// them in the inferior.
+enum class EmulatedFunction {
+  None,
+  Abs,
+  Ceil,
+  CopySign,
+  Fabs,
+  Floor,
+  Fmax,
+  Fmin,
+  Pow,
+  Round,
+  Sqrt,
+  Trunc
+};
+
+static EmulatedFunction GetEmulatedFunction(const CallInst *call) {
+  const llvm::Function *called_function =
+      dyn_cast<llvm::Function>(call->getCalledValue()->stripPointerCasts());
+
+  if (!called_function || !called_function->isDeclaration())
+    return EmulatedFunction::None;
+
+  EmulatedFunction emulated = EmulatedFunction::None;
+
+  if (called_function->isIntrinsic()) {
+    switch (called_function->getIntrinsicID()) {
+    default:
+      break;
+    case llvm::Intrinsic::ceil:
+      emulated = EmulatedFunction::Ceil;
+      break;
+    case llvm::Intrinsic::copysign:
+      emulated = EmulatedFunction::CopySign;
+      break;
+    case llvm::Intrinsic::fabs:
+      emulated = EmulatedFunction::Fabs;
+      break;
+    case llvm::Intrinsic::floor:
+      emulated = EmulatedFunction::Floor;
+      break;
+    case llvm::Intrinsic::maxnum:
+      emulated = EmulatedFunction::Fmax;
+      break;
+    case llvm::Intrinsic::minnum:
+      emulated = EmulatedFunction::Fmin;
+      break;
+    case llvm::Intrinsic::pow:
+      emulated = EmulatedFunction::Pow;
+      break;
+    case llvm::Intrinsic::round:
+      emulated = EmulatedFunction::Round;
+      break;
+    case llvm::Intrinsic::sqrt:
+      emulated = EmulatedFunction::Sqrt;
+      break;
+    case llvm::Intrinsic::trunc:
+      emulated = EmulatedFunction::Trunc;
+      break;
+    }
+  } else {
+    // The library's pow, sqrt and fmod set errno on domain errors, so calls
+    // to them are left to the JIT.  Their intrinsics above don't.
+    static const struct {
+      const char *name;
+      EmulatedFunction function;
+    } g_libm_functions[] = {{"abs", EmulatedFunction::Abs},
+                            {"labs", EmulatedFunction::Abs},
+                            {"llabs", EmulatedFunction::Abs},
+                            {"ceil", EmulatedFunction::Ceil},
+                            {"ceilf", EmulatedFunction::Ceil},
+                            {"copysign", EmulatedFunction::CopySign},
+                            {"copysignf", EmulatedFunction::CopySign},
+                            {"fabs", EmulatedFunction::Fabs},
+                            {"fabsf", EmulatedFunction::Fabs},
+                            {"floor", EmulatedFunction::Floor},
+                            {"floorf", EmulatedFunction::Floor},
+                            {"fmax", EmulatedFunction::Fmax},
+                            {"fmaxf", EmulatedFunction::Fmax},
+                            {"fmin", EmulatedFunction::Fmin},
+                            {"fminf", EmulatedFunction::Fmin},
+                            {"round", EmulatedFunction::Round},
+                            {"roundf", EmulatedFunction::Round},
+                            {"trunc", EmulatedFunction::Trunc},
+                            {"truncf", EmulatedFunction::Trunc}};
+
+    llvm::StringRef name = called_function->getName();
+    for (const auto &entry : g_libm_functions) {
+      if (name == entry.name) {
+        emulated = entry.function;
+        break;
+      }
+    }
+  }
+
+  if (emulated == EmulatedFunction::None)
+    return emulated;
+
+  // Only emulate calls whose arguments all have the type of the result, and
+  // that type is one the emulation handles.
+  const unsigned num_args = call->getNumArgOperands();
+  switch (emulated) {
+  case EmulatedFunction::Abs:
+    if (!call->getType()->isIntegerTy() || num_args != 1)
+      return EmulatedFunction::None;
+    break;
+  case EmulatedFunction::CopySign:
+  case EmulatedFunction::Fmax:
+  case EmulatedFunction::Fmin:
+  case EmulatedFunction::Pow:
+    if (!IsSupportedFloatType(call->getType()) || num_args != 2)
+      return EmulatedFunction::None;
+    break;
+  default:
+    if (!IsSupportedFloatType(call->getType()) || num_args != 1)
+      return EmulatedFunction::None;
+    break;
+  }
+
+  for (unsigned i = 0; i < num_args; ++i)
+    if (call->getArgOperand(i)->getType() != call->getType())
+      return EmulatedFunction::None;
+
+  return emulated;
+}
+
 class InterpreterStackFrame {
 public:
   typedef std::map<const Value *, lldb::addr_t> ValueMap;
@@ -150,6 +296,21 @@ public:
 
   bool AssignToMatchType(lldb_private::Scalar &scalar, uint64_t u64value,
                          Type *type) {
+    // Floating point values are passed around as their bits.
+    if (type->isFloatTy()) {
+      uint32_t bits = (uint32_t)u64value;
+      float f;
+      memcpy(&f, &bits, sizeof(f));
+      scalar = f;
+      return true;
+    }
+    if (type->isDoubleTy()) {
+      double d;
+      memcpy(&d, &u64value, sizeof(d));
+      scalar = d;
+      return true;
+    }
+
     size_t type_size = m_target_data.getTypeStoreSize(type);
 
     switch (type_size) {
@@ -208,6 +369,20 @@ public:
     return false;
   }
 
+  // Get the bits of a floating point value, as bitcasts see them.
+  uint64_t GetFloatBits(const lldb_private::Scalar &scalar, Type *type) {
+    if (type->isFloatTy()) {
+      float f = scalar.Float();
+      uint32_t bits;
+      memcpy(&bits, &f, sizeof(bits));
+      return bits;
+    }
+    double d = scalar.Double();
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+  }
+
   bool AssignValue(const Value *value, lldb_private::Scalar &scalar,
                    Module &module) {
     lldb::addr_t process_address = ResolveValue(value, module);
@@ -216,8 +391,13 @@ public:
       return false;
 
     lldb_private::Scalar cast_scalar;
+    Type *type = value->getType();
 
-    if (!AssignToMatchType(cast_scalar, scalar.ULongLong(), value->getType()))
+    if (type->isFloatTy())
+      cast_scalar = scalar.Float();
+    else if (type->isDoubleTy())
+      cast_scalar = scalar.Double();
+    else if (!AssignToMatchType(cast_scalar, scalar.ULongLong(), type))
       return false;
 
     size_t value_byte_size = m_target_data.getTypeStoreSize(value->getType());
@@ -454,6 +634,8 @@ static const char *interpreter_internal_error =
     "Interpreter encountered an internal error";
 static const char *bad_value_error =
     "Interpreter couldn't resolve a value during execution";
+static const char *float_conversion_error =
+    "Interpreter can't convert a NaN or out of range value to an integer";
 static const char *memory_allocation_error =
     "Interpreter couldn't allocate memory";
 static const char *memory_write_error = "Interpreter couldn't write to memory";
@@ -547,7 +729,9 @@ bool IRInterpreter::CanInterpret(llvm::Module &module, llvm::Function &function,
           return false;
         }
 
-        if (!CanIgnoreCall(call_inst) && !support_function_calls) {
+        if (!CanIgnoreCall(call_inst) &&
+            GetEmulatedFunction(call_inst) == EmulatedFunction::None &&
+            !support_function_calls) {
           if (log)
             log->Printf("Unsupported instruction: %s",
                         PrintValue(&*ii).c_str());
@@ -558,6 +742,44 @@ bool IRInterpreter::CanInterpret(llvm::Module &module, llvm::Function &function,
       } break;
       case Instruction::GetElementPtr:
         break;
+      case Instruction::FAdd:
+      case Instruction::FSub:
+      case Instruction::FMul:
+      case Instruction::FDiv:
+      case Instruction::FCmp:
+      case Instruction::FPExt:
+      case Instruction::FPTrunc:
+      case Instruction::FPToSI:
+      case Instruction::FPToUI:
+      case Instruction::SIToFP:
+      case Instruction::UIToFP: {
+        // Only float and double have a host type to compute with.
+        Type *fp_type = ii->getType()->isFloatingPointTy()
+                            ? ii->getType()
+                            : ii->getOperand(0)->getType();
+        if (!IsSupportedFloatType(fp_type) ||
+            (ii->getOperand(0)->getType()->isFloatingPointTy() &&
+             !IsSupportedFloatType(ii->getOperand(0)->getType()))) {
+          if (log)
+            log->Printf("Unsupported floating point type: %s",
+                        PrintValue(&*ii).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(unsupported_operand_error);
+          return false;
+        }
+      } break;
+      case Instruction::Select: {
+        Type *select_type = ii->getType();
+        if (!select_type->isIntegerTy() && !select_type->isPointerTy() &&
+            !IsSupportedFloatType(select_type)) {
+          if (log)
+            log->Printf("Unsupported select type: %s",
+                        PrintValue(&*ii).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(unsupported_operand_error);
+          return false;
+        }
+      } break;
       case Instruction::ICmp: {
         ICmpInst *icmp_inst = dyn_cast<ICmpInst>(ii);
 
@@ -916,8 +1138,308 @@ bool IRInterpreter::Interpret(llvm::Module &module, llvm::Function &function,
         return false;
       }
 
+      // A bitcast to or from a floating point type keeps the bits, not the
+      // numeric value.
+      Type *src_ty = source->getType();
+      Type *dst_ty = inst->getType();
+      if (src_ty->isFloatingPointTy() || dst_ty->isFloatingPointTy()) {
+        if ((src_ty->isFloatingPointTy() && !IsSupportedFloatType(src_ty)) ||
+            (dst_ty->isFloatingPointTy() && !IsSupportedFloatType(dst_ty))) {
+          if (log)
+            log->Printf("Unsupported floating point type: %s",
+                        PrintValue(inst).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(unsupported_operand_error);
+          return false;
+        }
+        uint64_t bits = src_ty->isFloatingPointTy()
+                            ? frame.GetFloatBits(S, src_ty)
+                            : S.ULongLong();
+        if (!frame.AssignToMatchType(S, bits, dst_ty)) {
+          error.SetErrorToGenericError();
+          error.SetErrorString(bad_value_error);
+          return false;
+        }
+      }
+
       frame.AssignValue(inst, S, module);
     } break;
+    case Instruction::FPExt:
+    case Instruction::FPTrunc:
+    case Instruction::FPToSI:
+    case Instruction::FPToUI:
+    case Instruction::SIToFP:
+    case Instruction::UIToFP: {
+      Value *source = inst->getOperand(0);
+
+      lldb_private::Scalar S;
+
+      if (!frame.EvaluateValue(S, source, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(source).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      // AssignValue converts the result to the width or floating point type
+      // of the instruction.
+      lldb_private::Scalar result;
+
+      const unsigned opcode = inst->getOpcode();
+      if (opcode == Instruction::FPToSI || opcode == Instruction::FPToUI) {
+        if (!FloatFitsInInteger(S.Double(),
+                                inst->getType()->getIntegerBitWidth(),
+                                opcode == Instruction::FPToSI)) {
+          if (log)
+            log->Printf("Can't convert %s in %s",
+                        frame.SummarizeValue(source).c_str(),
+                        PrintValue(inst).c_str());
+          error.SetErrorToGenericError();
+          error.SetErrorString(float_conversion_error);
+          return false;
+        }
+      }
+
+      switch (opcode) {
+      default:
+        result = S;
+        break;
+      case Instruction::FPToSI:
+        result = (long long)S.Double();
+        break;
+      case Instruction::FPToUI:
+        result = (unsigned long long)S.Double();
+        break;
+      case Instruction::SIToFP:
+        S.MakeSigned();
+        result = (double)S.SLongLong();
+        break;
+      case Instruction::UIToFP:
+        result = (double)S.ULongLong();
+        break;
+      }
+
+      frame.AssignValue(inst, result, module);
+
+      if (log) {
+        log->Printf("Interpreted a %s", inst->getOpcodeName());
+        log->Printf("  Src : %s", frame.SummarizeValue(source).c_str());
+        log->Printf("  =   : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::FAdd:
+    case Instruction::FSub:
+    case Instruction::FMul:
+    case Instruction::FDiv: {
+      Value *lhs = inst->getOperand(0);
+      Value *rhs = inst->getOperand(1);
+
+      lldb_private::Scalar L;
+      lldb_private::Scalar R;
+
+      if (!frame.EvaluateValue(L, lhs, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(lhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      if (!frame.EvaluateValue(R, rhs, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(rhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      // Compute in double and let AssignValue round floats, which gives the
+      // same result for a single operation on two floats.
+      const double l = L.Double();
+      const double r = R.Double();
+      lldb_private::Scalar result;
+
+      switch (inst->getOpcode()) {
+      default:
+        break;
+      case Instruction::FAdd:
+        result = l + r;
+        break;
+      case Instruction::FSub:
+        result = l - r;
+        break;
+      case Instruction::FMul:
+        result = l * r;
+        break;
+      case Instruction::FDiv:
+        result = l / r;
+        break;
+      }
+
+      frame.AssignValue(inst, result, module);
+
+      if (log) {
+        log->Printf("Interpreted a %s", inst->getOpcodeName());
+        log->Printf("  L : %s", frame.SummarizeValue(lhs).c_str());
+        log->Printf("  R : %s", frame.SummarizeValue(rhs).c_str());
+        log->Printf("  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::FCmp: {
+      const FCmpInst *fcmp_inst = dyn_cast<FCmpInst>(inst);
+
+      if (!fcmp_inst) {
+        if (log)
+          log->Printf(
+              "getOpcode() returns FCmp, but instruction is not an FCmpInst");
+        error.SetErrorToGenericError();
+        error.SetErrorString(interpreter_internal_error);
+        return false;
+      }
+
+      Value *lhs = inst->getOperand(0);
+      Value *rhs = inst->getOperand(1);
+
+      lldb_private::Scalar L;
+      lldb_private::Scalar R;
+
+      if (!frame.EvaluateValue(L, lhs, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(lhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      if (!frame.EvaluateValue(R, rhs, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(rhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      const double l = L.Double();
+      const double r = R.Double();
+      const bool unordered = std::isnan(l) || std::isnan(r);
+      bool cond = false;
+
+      switch (fcmp_inst->getPredicate()) {
+      default:
+        if (log)
+          log->Printf("Unsupported FCmp predicate: %s",
+                      PrintValue(inst).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(unsupported_opcode_error);
+        return false;
+      case CmpInst::FCMP_FALSE:
+        cond = false;
+        break;
+      case CmpInst::FCMP_TRUE:
+        cond = true;
+        break;
+      case CmpInst::FCMP_ORD:
+        cond = !unordered;
+        break;
+      case CmpInst::FCMP_UNO:
+        cond = unordered;
+        break;
+      case CmpInst::FCMP_OEQ:
+        cond = !unordered && l == r;
+        break;
+      case CmpInst::FCMP_ONE:
+        cond = !unordered && l != r;
+        break;
+      case CmpInst::FCMP_OGT:
+        cond = !unordered && l > r;
+        break;
+      case CmpInst::FCMP_OGE:
+        cond = !unordered && l >= r;
+        break;
+      case CmpInst::FCMP_OLT:
+        cond = !unordered && l < r;
+        break;
+      case CmpInst::FCMP_OLE:
+        cond = !unordered && l <= r;
+        break;
+      case CmpInst::FCMP_UEQ:
+        cond = unordered || l == r;
+        break;
+      case CmpInst::FCMP_UNE:
+        cond = unordered || l != r;
+        break;
+      case CmpInst::FCMP_UGT:
+        cond = unordered || l > r;
+        break;
+      case CmpInst::FCMP_UGE:
+        cond = unordered || l >= r;
+        break;
+      case CmpInst::FCMP_ULT:
+        cond = unordered || l < r;
+        break;
+      case CmpInst::FCMP_ULE:
+        cond = unordered || l <= r;
+        break;
+      }
+
+      lldb_private::Scalar result = cond;
+
+      frame.AssignValue(inst, result, module);
+
+      if (log) {
+        log->Printf("Interpreted an FCmpInst");
+        log->Printf("  L : %s", frame.SummarizeValue(lhs).c_str());
+        log->Printf("  R : %s", frame.SummarizeValue(rhs).c_str());
+        log->Printf("  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::Select: {
+      const SelectInst *select_inst = dyn_cast<SelectInst>(inst);
+
+      if (!select_inst) {
+        if (log)
+          log->Printf(
+              "getOpcode() returns Select, but instruction is not a "
+              "SelectInst");
+        error.SetErrorToGenericError();
+        error.SetErrorString(interpreter_internal_error);
+        return false;
+      }
+
+      const Value *condition = select_inst->getCondition();
+
+      lldb_private::Scalar C;
+
+      if (!frame.EvaluateValue(C, condition, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(condition).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      const Value *value = C.IsZero() ? select_inst->getFalseValue()
+                                      : select_inst->getTrueValue();
+
+      lldb_private::Scalar result;
+
+      if (!frame.EvaluateValue(result, value, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(value).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      frame.AssignValue(inst, result, module);
+
+      if (log) {
+        log->Printf("Interpreted a SelectInst");
+        log->Printf("  cond : %s", frame.SummarizeValue(condition).c_str());
+        log->Printf("  =    : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
     case Instruction::SExt: {
       const CastInst *cast_inst = dyn_cast<CastInst>(inst);
 
@@ -1501,6 +2023,85 @@ bool IRInterpreter::Interpret(llvm::Module &module, llvm::Function &function,
       if (CanIgnoreCall(call_inst))
         break;
 
+      EmulatedFunction emulated = GetEmulatedFunction(call_inst);
+      if (emulated != EmulatedFunction::None) {
+        lldb_private::Scalar args[2];
+        const unsigned num_args = call_inst->getNumArgOperands();
+
+        for (unsigned i = 0; i < num_args; ++i) {
+          Value *arg = call_inst->getArgOperand(i);
+          if (!frame.EvaluateValue(args[i], arg, module)) {
+            if (log)
+              log->Printf("Couldn't evaluate %s", PrintValue(arg).c_str());
+            error.SetErrorToGenericError();
+            error.SetErrorString(bad_value_error);
+            return false;
+          }
+        }
+
+        lldb_private::Scalar result;
+
+        if (emulated == EmulatedFunction::Abs) {
+          args[0].MakeSigned();
+          const long long value = args[0].SLongLong();
+          // Negate as unsigned, so that LLONG_MIN doesn't overflow.
+          result = value < 0 ? 0ULL - (unsigned long long)value
+                             : (unsigned long long)value;
+        } else {
+          // Compute in the type of the call, so that the float variants
+          // round like the library would.
+          const bool is_float = call_inst->getType()->isFloatTy();
+          const double x = args[0].Double();
+          const double y = num_args > 1 ? args[1].Double() : 0.0;
+          const float xf = (float)x;
+          const float yf = (float)y;
+
+          switch (emulated) {
+          default:
+            break;
+          case EmulatedFunction::Ceil:
+            result = is_float ? (double)std::ceil(xf) : std::ceil(x);
+            break;
+          case EmulatedFunction::CopySign:
+            result =
+                is_float ? (double)std::copysign(xf, yf) : std::copysign(x, y);
+            break;
+          case EmulatedFunction::Fabs:
+            result = is_float ? (double)std::fabs(xf) : std::fabs(x);
+            break;
+          case EmulatedFunction::Floor:
+            result = is_float ? (double)std::floor(xf) : std::floor(x);
+            break;
+          case EmulatedFunction::Fmax:
+            result = is_float ? (double)std::fmax(xf, yf) : std::fmax(x, y);
+            break;
+          case EmulatedFunction::Fmin:
+            result = is_float ? (double)std::fmin(xf, yf) : std::fmin(x, y);
+            break;
+          case EmulatedFunction::Pow:
+            result = is_float ? (double)std::pow(xf, yf) : std::pow(x, y);
+            break;
+          case EmulatedFunction::Round:
+            result = is_float ? (double)std::round(xf) : std::round(x);
+            break;
+          case EmulatedFunction::Sqrt:
+            result = is_float ? (double)std::sqrt(xf) : std::sqrt(x);
+            break;
+          case EmulatedFunction::Trunc:
+            result = is_float ? (double)std::trunc(xf) : std::trunc(x);
+            break;
+          }
+        }
+
+        frame.AssignValue(inst, result, module);
+
+        if (log) {
+          log->Printf("Emulated a call");
+          log->Printf("  = : %s", frame.SummarizeValue(inst).c_str());
+        }
+        break;
+      }
+
       // Get the return type
       llvm::Type *returnType = call_inst->getType();
       if (returnType == nullptr) {
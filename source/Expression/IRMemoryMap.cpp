@@ -18,9 +18,12 @@
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/Status.h"
 
+#include <algorithm>
+
 using namespace lldb_private;
 
-IRMemoryMap::IRMemoryMap(lldb::TargetSP target_sp) : m_target_wp(target_sp) {
+IRMemoryMap::IRMemoryMap(lldb::TargetSP target_sp)
+    : m_target_wp(target_sp), m_batching(false) {
   if (target_sp)
     m_process_wp = target_sp->GetProcessSP();
 }
@@ -278,7 +281,8 @@ IRMemoryMap::Allocation::Allocation(lldb::addr_t process_alloc,
                                     AllocationPolicy policy)
     : m_process_alloc(process_alloc), m_process_start(process_start),
       m_size(size), m_permissions(permissions), m_alignment(alignment),
-      m_policy(policy), m_leak(false) {
+      m_policy(policy), m_leak(false), m_dirty_start(0), m_dirty_end(0),
+      m_host_current(false) {
   switch (policy) {
   default:
     assert(0 && "We cannot reach this!");
@@ -338,12 +342,10 @@ lldb::addr_t IRMemoryMap::Malloc(size_t size, uint8_t alignment,
                   process_sp && process_sp->CanJIT() ? "true" : "false",
                   process_sp && process_sp->IsAlive() ? "true" : "false");
     if (process_sp && process_sp->CanJIT() && process_sp->IsAlive()) {
-      if (!zero_memory)
-        allocation_address =
-            process_sp->AllocateMemory(allocation_size, permissions, error);
-      else
-        allocation_address =
-            process_sp->CallocateMemory(allocation_size, permissions, error);
+      // Zeroing is done below, once the allocation is in the map, so that
+      // the process memory is only written once.
+      allocation_address =
+          process_sp->AllocateMemory(allocation_size, permissions, error);
 
       if (!error.Success())
         return LLDB_INVALID_ADDRESS;
@@ -365,12 +367,8 @@ lldb::addr_t IRMemoryMap::Malloc(size_t size, uint8_t alignment,
     process_sp = m_process_wp.lock();
     if (process_sp) {
       if (process_sp->CanJIT() && process_sp->IsAlive()) {
-        if (!zero_memory)
-          allocation_address =
-              process_sp->AllocateMemory(allocation_size, permissions, error);
-        else
-          allocation_address =
-              process_sp->CallocateMemory(allocation_size, permissions, error);
+        allocation_address =
+            process_sp->AllocateMemory(allocation_size, permissions, error);
 
         if (!error.Success())
           return LLDB_INVALID_ADDRESS;
@@ -396,7 +394,9 @@ lldb::addr_t IRMemoryMap::Malloc(size_t size, uint8_t alignment,
       Allocation(allocation_address, aligned_address, allocation_size,
                  permissions, alignment, policy);
 
-  if (zero_memory) {
+  // Host only allocations start out zeroed, so this only costs a write when
+  // the memory lives in the process.
+  if (zero_memory && policy != eAllocationPolicyHostOnly) {
     Status write_error;
     std::vector<uint8_t> zero_buf(size, 0);
     WriteMemory(aligned_address, zero_buf.data(), size, write_error);
@@ -558,6 +558,18 @@ void IRMemoryMap::WriteMemory(lldb::addr_t process_address,
       return;
     }
     ::memcpy(allocation.m_data.GetBytes() + offset, bytes, size);
+    if (m_batching) {
+      if (allocation.m_dirty_end == allocation.m_dirty_start) {
+        allocation.m_dirty_start = offset;
+        allocation.m_dirty_end = offset + size;
+      } else {
+        allocation.m_dirty_start =
+            std::min<size_t>(allocation.m_dirty_start, offset);
+        allocation.m_dirty_end =
+            std::max<size_t>(allocation.m_dirty_end, offset + size);
+      }
+      break;
+    }
     process_sp = m_process_wp.lock();
     if (process_sp) {
       process_sp->WriteMemory(process_address, bytes, size, error);
@@ -682,6 +694,14 @@ void IRMemoryMap::ReadMemory(uint8_t *bytes, lldb::addr_t process_address,
     break;
   case eAllocationPolicyMirror:
     process_sp = m_process_wp.lock();
+    if (process_sp && m_batching) {
+      if (SyncAllocationForBatch(allocation, error)) {
+        ::memcpy(bytes, allocation.m_data.GetBytes() + offset, size);
+        break;
+      }
+      if (!error.Success())
+        return;
+    }
     if (process_sp) {
       process_sp->ReadMemory(process_address, bytes, size, error);
       if (!error.Success())
@@ -815,11 +835,18 @@ void IRMemoryMap::GetMemoryData(DataExtractor &extractor,
         return;
       }
       if (process_sp) {
-        process_sp->ReadMemory(allocation.m_process_start,
-                               allocation.m_data.GetBytes(),
-                               allocation.m_data.GetByteSize(), error);
-        if (!error.Success())
-          return;
+        if (m_batching) {
+          SyncAllocationForBatch(allocation, error);
+          if (!error.Success())
+            return;
+        }
+        if (!allocation.m_host_current) {
+          process_sp->ReadMemory(allocation.m_process_start,
+                                 allocation.m_data.GetBytes(),
+                                 allocation.m_data.GetByteSize(), error);
+          if (!error.Success())
+            return;
+        }
         uint64_t offset = process_address - allocation.m_process_start;
         extractor = DataExtractor(allocation.m_data.GetBytes() + offset, size,
                                   GetByteOrder(), GetAddressByteSize());
@@ -843,3 +870,84 @@ void IRMemoryMap::GetMemoryData(DataExtractor &extractor,
     return;
   }
 }
+
+// Mirrored allocations larger than this are not read whole during a batch;
+// reads go to the process as usual.
+static const size_t g_max_batched_read_size = 64 * 1024;
+
+void IRMemoryMap::BeginBatch() { m_batching = true; }
+
+void IRMemoryMap::EndBatch(Status &error) {
+  error.Clear();
+
+  m_batching = false;
+
+  for (auto &entry : m_allocations) {
+    Allocation &allocation = entry.second;
+
+    if (allocation.m_policy != eAllocationPolicyMirror)
+      continue;
+
+    allocation.m_host_current = false;
+
+    Status flush_error;
+    FlushAllocation(allocation, flush_error);
+    if (flush_error.Fail() && error.Success())
+      error = flush_error;
+  }
+}
+
+void IRMemoryMap::FlushAllocation(Allocation &allocation, Status &error) {
+  if (allocation.m_dirty_end == allocation.m_dirty_start)
+    return;
+
+  const size_t start = allocation.m_dirty_start;
+  const size_t size = allocation.m_dirty_end - start;
+
+  allocation.m_dirty_start = allocation.m_dirty_end = 0;
+
+  lldb::ProcessSP process_sp = m_process_wp.lock();
+
+  if (!process_sp)
+    return;
+
+  process_sp->WriteMemory(allocation.m_process_start + start,
+                          allocation.m_data.GetBytes() + start, size, error);
+
+  if (lldb_private::Log *log =
+          lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS)) {
+    log->Printf("IRMemoryMap::FlushAllocation wrote [0x%" PRIx64
+                "..0x%" PRIx64 ")",
+                (uint64_t)(allocation.m_process_start + start),
+                (uint64_t)(allocation.m_process_start + start + size));
+  }
+}
+
+bool IRMemoryMap::SyncAllocationForBatch(Allocation &allocation,
+                                         Status &error) {
+  if (allocation.m_host_current)
+    return true;
+
+  // The process needs to see what was written before it can be read back.
+  FlushAllocation(allocation, error);
+  if (!error.Success())
+    return false;
+
+  if (allocation.m_data.GetByteSize() < allocation.m_size ||
+      allocation.m_size > g_max_batched_read_size)
+    return false;
+
+  lldb::ProcessSP process_sp = m_process_wp.lock();
+
+  if (!process_sp)
+    return false;
+
+  process_sp->ReadMemory(allocation.m_process_start,
+                         allocation.m_data.GetBytes(), allocation.m_size,
+                         error);
+  if (!error.Success())
+    return false;
+
+  allocation.m_host_current = true;
+  return true;
+}
@@ -1424,13 +1424,25 @@ Materializer::Materialize(lldb::StackFrameSP &frame_sp, IRMemoryMap &map,
     error.SetErrorString("Couldn't materialize: target doesn't exist");
   }
 
+  // Write the whole argument struct, and any other mirrored memory the
+  // entities fill in, with one transfer per allocation.
+  map.BeginBatch();
+
   for (EntityUP &entity_up : m_entities) {
     entity_up->Materialize(frame_sp, map, process_address, error);
 
-    if (!error.Success())
+    if (!error.Success()) {
+      Status batch_error;
+      map.EndBatch(batch_error);
       return DematerializerSP();
+    }
   }
 
+  map.EndBatch(error);
+
+  if (!error.Success())
+    return DematerializerSP();
+
   if (Log *log =
           lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS)) {
     log->Printf(
@@ -1475,6 +1487,10 @@ void Materializer::Dematerializer::Dematerialize(Status &error,
         entity_up->DumpToLog(*m_map, m_process_address, log);
     }
 
+    // Read the argument struct back with one transfer instead of one per
+    // entity.
+    m_map->BeginBatch();
+
     for (EntityUP &entity_up : m_materializer->m_entities) {
       entity_up->Dematerialize(frame_sp, *m_map, m_process_address, frame_top,
                                frame_bottom, error);
@@ -1483,6 +1499,11 @@ void Materializer::Dematerializer::Dematerialize(Status &error,
         break;
     }
 
+    Status batch_error;
+    m_map->EndBatch(batch_error);
+    if (error.Success() && batch_error.Fail())
+      error = batch_error;
+
     // Okay now if there's an error and it is not empty, then report that,
     // otherwise report the regular error...
   }
@@ -13,6 +13,7 @@
 #endif
 
 #include <cstdlib>
+#include <inttypes.h>
 #include <map>
 #include <string>
 
@@ -35,6 +36,7 @@
 #include "lldb/Symbol/TypeSystem.h"
 #include "lldb/Symbol/VariableList.h"
 #include "lldb/Target/ExecutionContext.h"
+#include "lldb/Target/Language.h"
 #include "lldb/Target/Process.h"
 #include "lldb/Target/StackFrame.h"
 #include "lldb/Target/Target.h"
@@ -82,15 +84,57 @@ bool UserExpression::LockAndCheckContext(ExecutionContext &exe_ctx,
   if (m_address.IsValid()) {
     if (!frame_sp)
       return false;
-    else
-      return (0 == Address::CompareLoadAddress(m_address,
-                                               frame_sp->GetFrameCodeAddress(),
-                                               target_sp.get()));
+    if (0 == Address::CompareLoadAddress(m_address,
+                                         frame_sp->GetFrameCodeAddress(),
+                                         target_sp.get()))
+      return true;
+    // The frame only matters to the parsed expression through the variables
+    // that were in scope, so it can run anywhere in the same lexical block.
+    Block *block = m_address.CalculateSymbolContextBlock();
+    return block != nullptr &&
+           block == frame_sp->GetSymbolContext(lldb::eSymbolContextBlock).block;
   }
 
   return true;
 }
 
+static bool CanCacheExpression(llvm::StringRef expr,
+                               lldb::LanguageType language,
+                               lldb_private::ExecutionPolicy execution_policy,
+                               const EvaluateExpressionOptions &options) {
+  if (language == lldb::eLanguageTypeSwift) {
+    // REPL and playground expressions add their declarations to the
+    // persistent state, so each one has to be compiled where it's entered.
+    if (options.GetREPLEnabled() || options.GetPlaygroundTransformEnabled())
+      return false;
+  } else if (!Language::LanguageIsC(language) &&
+             !Language::LanguageIsCPlusPlus(language) &&
+             !Language::LanguageIsObjC(language)) {
+    // Only expressions handled by the Clang and Swift expression parsers are
+    // known to be safe to execute more than once.
+    return false;
+  }
+  // Top level expressions define things rather than compute a value.
+  if (execution_policy == eExecutionPolicyTopLevel)
+    return false;
+  // Expressions mentioning persistent variables or registers may declare new
+  // persistent variables, which must happen again each time they're run.
+  return expr.find('$') == llvm::StringRef::npos;
+}
+
+static std::string GetExpressionCacheKey(
+    llvm::StringRef expr, llvm::StringRef prefix, lldb::LanguageType language,
+    Expression::ResultType desired_type,
+    lldb_private::ExecutionPolicy execution_policy, bool generate_debug_info) {
+  StreamString key;
+  key.Printf("%u;%u;%u;%u;%" PRIu64 ";", (unsigned)language,
+             (unsigned)desired_type, (unsigned)execution_policy,
+             (unsigned)generate_debug_info, (uint64_t)prefix.size());
+  key.PutCString(prefix);
+  key.PutCString(expr);
+  return key.GetString().str();
+}
+
 bool UserExpression::MatchesContext(ExecutionContext &exe_ctx) {
   lldb::TargetSP target_sp;
   lldb::ProcessSP process_sp;
@@ -218,22 +262,36 @@ lldb::ExpressionResults UserExpression::Evaluate(
       language = frame->GetLanguage();
   }
 
-  lldb::UserExpressionSP user_expression_sp(
-      target->GetUserExpressionForLanguage(expr, full_prefix, language,
-                                           desired_type, options, error));
-  if (error.Fail()) {
-    if (log)
-      log->Printf("== [UserExpression::Evaluate] Getting expression: %s ==",
-                  error.AsCString());
-    return lldb::eExpressionSetupError;
+  const bool keep_expression_in_memory = true;
+  const bool generate_debug_info = options.GetGenerateDebugInfo();
+
+  // Watch windows evaluate the same expressions at every stop, so reuse the
+  // parsed and JITted code when the context allows it and only materialize
+  // the variables again.
+  lldb::UserExpressionSP user_expression_sp;
+  std::string cache_key;
+  if (CanCacheExpression(expr, language, execution_policy, options)) {
+    cache_key =
+        GetExpressionCacheKey(expr, full_prefix, language, desired_type,
+                              execution_policy, generate_debug_info);
+    user_expression_sp = target->GetCachedUserExpression(cache_key, exe_ctx);
   }
+  const bool is_cached = (bool)user_expression_sp;
 
-  if (log)
-    log->Printf("== [UserExpression::Evaluate] Parsing expression %s ==",
-                expr.str().c_str());
+  if (!is_cached) {
+    user_expression_sp.reset(target->GetUserExpressionForLanguage(
+        expr, full_prefix, language, desired_type, options, error));
+    if (error.Fail()) {
+      if (log)
+        log->Printf("== [UserExpression::Evaluate] Getting expression: %s ==",
+                    error.AsCString());
+      return lldb::eExpressionSetupError;
+    }
+  }
 
-  const bool keep_expression_in_memory = true;
-  const bool generate_debug_info = options.GetGenerateDebugInfo();
+  if (log)
+    log->Printf("== [UserExpression::Evaluate] %s expression %s ==",
+                is_cached ? "Reusing parsed" : "Parsing", expr.str().c_str());
 
   if (options.InvokeCancelCallback(lldb::eExpressionEvaluationParse)) {
     error.SetErrorString("expression interrupted by callback before parse");
@@ -244,9 +302,11 @@ lldb::ExpressionResults UserExpression::Evaluate(
 
   DiagnosticManager diagnostic_manager;
 
-  bool parse_success = user_expression_sp->Parse(
-      diagnostic_manager, exe_ctx, execution_policy, keep_expression_in_memory,
-      generate_debug_info, 0);
+  bool parse_success =
+      is_cached ||
+      user_expression_sp->Parse(diagnostic_manager, exe_ctx, execution_policy,
+                                keep_expression_in_memory, generate_debug_info,
+                                0);
 
   // Calculate the fixed expression always, since we need it for errors.
   std::string tmp_fixed_expression;
@@ -315,6 +375,9 @@ lldb::ExpressionResults UserExpression::Evaluate(
         error.SetExpressionError(lldb::eExpressionSetupError,
                                  "expression needed to run but couldn't");
     } else if (execution_policy == eExecutionPolicyTopLevel) {
+      // Top level expressions can add types and functions that change how
+      // cached expressions would parse now.
+      target->ClearUserExpressionCache();
       error.SetError(UserExpression::kNoResult, lldb::eErrorTypeGeneric);
       return lldb::eExpressionCompleted;
     } else {
@@ -336,6 +399,13 @@ lldb::ExpressionResults UserExpression::Evaluate(
           user_expression_sp->Execute(diagnostic_manager, exe_ctx, options,
                                       user_expression_sp, expr_result);
 
+      // Only keep expressions that ran cleanly, and not the ones the parser
+      // had to fix, which were created for different text.
+      if (!cache_key.empty() &&
+          execution_results == lldb::eExpressionCompleted &&
+          expr == user_expression_sp->GetUserText())
+        target->CacheUserExpression(cache_key, user_expression_sp);
+
       if (execution_results != lldb::eExpressionCompleted) {
         if (log)
           log->Printf("== [UserExpression::Evaluate] Execution completed "
@@ -11,6 +11,7 @@
 
 #include "lldb/Core/ArchSpec.h"
 #include "lldb/Core/ModuleSpec.h"
+#include "lldb/Core/RegisterValue.h"
 #include "lldb/Core/State.h"
 #include "lldb/Host/Host.h"
 #include "lldb/Host/common/NativeRegisterContext.h"
@@ -18,6 +19,7 @@
 #include "lldb/Host/common/SoftwareBreakpoint.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Target/Process.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/LLDBAssert.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/lldb-enumerations.h"
@@ -422,6 +424,90 @@ Status NativeProcessProtocol::RemoveBreakpoint(lldb::addr_t addr,
     return m_breakpoint_list.DecRef(addr);
 }
 
+void NativeProcessProtocol::SetBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs,
+                                           uint32_t size_hint, bool hardware,
+                                           std::vector<Status> &errors) {
+  errors.clear();
+  for (lldb::addr_t addr : addrs)
+    errors.push_back(SetBreakpoint(addr, size_hint, hardware));
+}
+
+void NativeProcessProtocol::RemoveBreakpoints(
+    llvm::ArrayRef<lldb::addr_t> addrs, bool hardware,
+    std::vector<Status> &errors) {
+  errors.clear();
+  for (lldb::addr_t addr : addrs)
+    errors.push_back(RemoveBreakpoint(addr, hardware));
+}
+
+void NativeProcessProtocol::SetSoftwareBreakpoints(
+    llvm::ArrayRef<lldb::addr_t> addrs, uint32_t size_hint,
+    std::vector<Status> &errors) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+  if (log)
+    log->Printf("NativeProcessProtocol::%s %zu breakpoints", __FUNCTION__,
+                addrs.size());
+
+  // Only the breakpoints that don't exist yet need writing.
+  std::vector<lldb::addr_t> new_addrs;
+  for (lldb::addr_t addr : addrs) {
+    NativeBreakpointSP breakpoint_sp;
+    if (m_breakpoint_list.GetBreakpoint(addr, breakpoint_sp).Fail())
+      new_addrs.push_back(addr);
+  }
+  std::sort(new_addrs.begin(), new_addrs.end());
+  new_addrs.erase(std::unique(new_addrs.begin(), new_addrs.end()),
+                  new_addrs.end());
+
+  // Write the traps a page at a time.  Any that can't be written this way
+  // are left to SetSoftwareBreakpoint below.
+  std::map<lldb::addr_t, NativeBreakpointSP> written;
+  size_t opcode_size = 0;
+  const uint8_t *opcode_bytes = nullptr;
+  if (new_addrs.size() > 1 &&
+      GetSoftwareBreakpointTrapOpcode(size_hint, opcode_size, opcode_bytes)
+          .Success()) {
+    const lldb::addr_t page_mask = ~lldb::addr_t(0xfff);
+    size_t begin = 0;
+    while (begin < new_addrs.size()) {
+      size_t end = begin + 1;
+      while (end < new_addrs.size() &&
+             (new_addrs[end] & page_mask) == (new_addrs[begin] & page_mask) &&
+             new_addrs[end] >= new_addrs[end - 1] + opcode_size)
+        ++end;
+      std::vector<NativeBreakpointSP> breakpoints;
+      if (end - begin > 1 &&
+          SoftwareBreakpoint::CreateSoftwareBreakpoints(
+              *this, llvm::makeArrayRef(new_addrs).slice(begin, end - begin),
+              size_hint, breakpoints)
+              .Success()) {
+        for (const NativeBreakpointSP &breakpoint_sp : breakpoints)
+          written[breakpoint_sp->GetAddress()] = breakpoint_sp;
+      }
+      begin = end;
+    }
+  }
+
+  errors.clear();
+  for (lldb::addr_t addr : addrs) {
+    auto pos = written.find(addr);
+    if (pos == written.end()) {
+      errors.push_back(SetSoftwareBreakpoint(addr, size_hint));
+      continue;
+    }
+    NativeBreakpointSP written_sp = pos->second;
+    written.erase(pos);
+    errors.push_back(m_breakpoint_list.AddRef(
+        addr, size_hint, false,
+        [&written_sp](lldb::addr_t /* addr */, size_t /* size_hint */,
+                      bool /* hardware */,
+                      NativeBreakpointSP &breakpoint_sp) -> Status {
+          breakpoint_sp = written_sp;
+          return Status();
+        }));
+  }
+}
+
 Status NativeProcessProtocol::EnableBreakpoint(lldb::addr_t addr) {
   return m_breakpoint_list.EnableBreakpoint(addr);
 }
@@ -430,6 +516,125 @@ Status NativeProcessProtocol::DisableBreakpoint(lldb::addr_t addr) {
   return m_breakpoint_list.DisableBreakpoint(addr);
 }
 
+Status NativeProcessProtocol::SetBreakpointStopOptions(
+    lldb::addr_t addr, std::vector<AgentExpression> conditions,
+    uint32_t ignore_count, bool auto_continue) {
+  NativeBreakpointSP breakpoint_sp;
+  Status error = m_breakpoint_list.GetBreakpoint(addr, breakpoint_sp);
+  if (error.Fail())
+    return error;
+
+  if (!breakpoint_sp->IsSoftwareBreakpoint()) {
+    if (conditions.empty() && ignore_count == 0 && !auto_continue)
+      return Status();
+    return Status("stop options are only supported on software breakpoints");
+  }
+
+  breakpoint_sp->SetConditions(std::move(conditions));
+  breakpoint_sp->SetIgnoreCount(ignore_count);
+  breakpoint_sp->SetAutoContinue(auto_continue);
+  return Status();
+}
+
+Status NativeProcessProtocol::GetBreakpointHitCounts(lldb::addr_t addr,
+                                                     uint64_t &skipped_hits,
+                                                     uint32_t &ignore_count) {
+  NativeBreakpointSP breakpoint_sp;
+  Status error = m_breakpoint_list.GetBreakpoint(addr, breakpoint_sp);
+  if (error.Fail())
+    return error;
+
+  skipped_hits = breakpoint_sp->GetSkippedHitCount();
+  ignore_count = breakpoint_sp->GetIgnoreCount();
+  return Status();
+}
+
+void NativeProcessProtocol::SkipBreakpointHit(lldb::addr_t addr,
+                                              bool count_hit) {
+  NativeBreakpointSP breakpoint_sp;
+  if (!count_hit || m_breakpoint_list.GetBreakpoint(addr, breakpoint_sp).Fail())
+    return;
+
+  // Same order as BreakpointHitShouldStop, the ignore count goes first.
+  const uint32_t ignore_count = breakpoint_sp->GetIgnoreCount();
+  if (ignore_count > 0)
+    breakpoint_sp->SetIgnoreCount(ignore_count - 1);
+  breakpoint_sp->IncrementSkippedHitCount();
+}
+
+bool NativeProcessProtocol::BreakpointHitShouldStop(
+    NativeThreadProtocol &thread, lldb::addr_t addr, bool &count_hit) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+
+  count_hit = false;
+  NativeBreakpointSP breakpoint_sp;
+  if (m_breakpoint_list.GetBreakpoint(addr, breakpoint_sp).Fail() ||
+      !breakpoint_sp->IsSoftwareBreakpoint())
+    return true;
+
+  // The client decrements the ignore count before it looks at the
+  // conditions, and counts ignored hits.
+  if (breakpoint_sp->GetIgnoreCount() > 0) {
+    LLDB_LOG(log, "pid {0} tid {1} breakpoint at {2:x} ignored", GetID(),
+             thread.GetID(), addr);
+    count_hit = true;
+    return false;
+  }
+
+  if (breakpoint_sp->GetConditions().empty()) {
+    count_hit = breakpoint_sp->IsAutoContinue();
+    return !count_hit;
+  }
+
+  NativeRegisterContextSP reg_ctx_sp = thread.GetRegisterContext();
+  lldb::ByteOrder byte_order;
+  if (!reg_ctx_sp || !GetByteOrder(byte_order))
+    return true;
+
+  auto read_register = [&reg_ctx_sp](uint32_t reg_num, uint64_t &value) {
+    const RegisterInfo *reg_info = reg_ctx_sp->GetRegisterInfoAtIndex(reg_num);
+    RegisterValue reg_value;
+    if (!reg_info || reg_ctx_sp->ReadRegister(reg_info, reg_value).Fail())
+      return false;
+    bool success = false;
+    value = reg_value.GetAsUInt64(0, &success);
+    return success;
+  };
+
+  auto read_memory = [this, byte_order](lldb::addr_t addr, size_t size,
+                                        uint64_t &value) {
+    uint8_t buf[8];
+    size_t bytes_read = 0;
+    if (size > sizeof(buf) ||
+        ReadMemoryWithoutTrap(addr, buf, size, bytes_read).Fail() ||
+        bytes_read != size)
+      return false;
+    DataExtractor data(buf, size, byte_order, size);
+    lldb::offset_t offset = 0;
+    value = data.GetMaxU64(&offset, size);
+    return true;
+  };
+
+  for (const AgentExpression &condition : breakpoint_sp->GetConditions()) {
+    uint64_t result = 0;
+    Status error = condition.Evaluate(read_register, read_memory, result);
+    if (error.Fail()) {
+      LLDB_LOG(log, "pid {0} tid {1} breakpoint at {2:x} condition failed: {3}",
+               GetID(), thread.GetID(), addr, error);
+      return true;
+    }
+    if (result != 0) {
+      count_hit = breakpoint_sp->IsAutoContinue();
+      return !count_hit;
+    }
+  }
+
+  // Hits where the condition is false aren't counted by the client either.
+  LLDB_LOG(log, "pid {0} tid {1} breakpoint at {2:x} conditions are false",
+           GetID(), thread.GetID(), addr);
+  return false;
+}
+
 lldb::StateType NativeProcessProtocol::GetState() const {
   std::lock_guard<std::recursive_mutex> guard(m_state_mutex);
   return m_state;
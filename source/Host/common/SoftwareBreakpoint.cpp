@@ -33,11 +33,143 @@ Status SoftwareBreakpoint::CreateSoftwareBreakpoint(
     return Status("SoftwareBreakpoint::%s invalid load address specified.",
                   __FUNCTION__);
 
-  // Ask the NativeProcessProtocol subclass to fill in the correct software
-  // breakpoint
-  // trap for the breakpoint site.
   size_t bp_opcode_size = 0;
   const uint8_t *bp_opcode_bytes = NULL;
+  Status error =
+      GetTrapOpcode(process, addr, size_hint, bp_opcode_size, bp_opcode_bytes);
+  if (error.Fail())
+    return error;
+
+  // Enable the breakpoint.
+  uint8_t saved_opcode_bytes[MAX_TRAP_OPCODE_SIZE];
+  error = EnableSoftwareBreakpoint(process, addr, bp_opcode_size,
+                                   bp_opcode_bytes, saved_opcode_bytes);
+  if (error.Fail()) {
+    if (log)
+      log->Printf("SoftwareBreakpoint::%s: failed to enable new breakpoint at "
+                  "0x%" PRIx64 ": %s",
+                  __FUNCTION__, addr, error.AsCString());
+    return error;
+  }
+
+  if (log)
+    log->Printf("SoftwareBreakpoint::%s addr = 0x%" PRIx64 " -- SUCCESS",
+                __FUNCTION__, addr);
+
+  // Set the breakpoint and verified it was written properly.  Now
+  // create a breakpoint remover that understands how to undo this
+  // breakpoint.
+  breakpoint_sp.reset(new SoftwareBreakpoint(process, addr, saved_opcode_bytes,
+                                             bp_opcode_bytes, bp_opcode_size));
+  return Status();
+}
+
+Status SoftwareBreakpoint::CreateSoftwareBreakpoints(
+    NativeProcessProtocol &process, llvm::ArrayRef<lldb::addr_t> addrs,
+    size_t size_hint, std::vector<NativeBreakpointSP> &breakpoints) {
+  breakpoints.clear();
+  if (addrs.empty())
+    return Status();
+
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+  if (log)
+    log->Printf("SoftwareBreakpoint::%s %zu breakpoints in 0x%" PRIx64
+                "-0x%" PRIx64,
+                __FUNCTION__, addrs.size(), addrs.front(), addrs.back());
+
+  if (addrs.front() == LLDB_INVALID_ADDRESS ||
+      addrs.back() == LLDB_INVALID_ADDRESS)
+    return Status("SoftwareBreakpoint::%s invalid load address specified.",
+                  __FUNCTION__);
+
+  size_t bp_opcode_size = 0;
+  const uint8_t *bp_opcode_bytes = NULL;
+  Status error = GetTrapOpcode(process, addrs.front(), size_hint,
+                               bp_opcode_size, bp_opcode_bytes);
+  if (error.Fail())
+    return error;
+
+  for (size_t i = 1; i < addrs.size(); ++i) {
+    if (addrs[i] < addrs[i - 1] + bp_opcode_size)
+      return Status("SoftwareBreakpoint::%s breakpoints at 0x%" PRIx64
+                    " and 0x%" PRIx64 " are unsorted or overlap",
+                    __FUNCTION__, addrs[i - 1], addrs[i]);
+  }
+
+  // Read the whole range once, put all the traps in a copy of it and
+  // write that copy back with a single write.
+  const lldb::addr_t range_addr = addrs.front();
+  const size_t range_size = addrs.back() + bp_opcode_size - range_addr;
+  std::vector<uint8_t> saved_bytes(range_size);
+  size_t bytes_read = 0;
+  error = process.ReadMemory(range_addr, saved_bytes.data(), range_size,
+                             bytes_read);
+  if (error.Success() && bytes_read != range_size)
+    error.SetErrorStringWithFormat(
+        "SoftwareBreakpoint::%s failed to read memory while attempting to "
+        "set breakpoints: attempted to read %zu bytes but only read %zu",
+        __FUNCTION__, range_size, bytes_read);
+  if (error.Fail())
+    return error;
+
+  std::vector<uint8_t> trap_bytes(saved_bytes);
+  for (lldb::addr_t addr : addrs)
+    ::memcpy(trap_bytes.data() + (addr - range_addr), bp_opcode_bytes,
+             bp_opcode_size);
+
+  size_t bytes_written = 0;
+  error = process.WriteMemory(range_addr, trap_bytes.data(), range_size,
+                              bytes_written);
+  if (error.Success() && bytes_written != range_size)
+    error.SetErrorStringWithFormat(
+        "SoftwareBreakpoint::%s failed write memory while attempting to set "
+        "breakpoints: attempted to write %zu bytes but only wrote %zu",
+        __FUNCTION__, range_size, bytes_written);
+
+  if (error.Success()) {
+    std::vector<uint8_t> verify_bytes(range_size);
+    size_t verify_bytes_read = 0;
+    error = process.ReadMemory(range_addr, verify_bytes.data(), range_size,
+                               verify_bytes_read);
+    if (error.Success() && (verify_bytes_read != range_size ||
+                            verify_bytes != trap_bytes))
+      error.SetErrorStringWithFormat(
+          "SoftwareBreakpoint::%s: verification of software breakpoint "
+          "writing failed - trap opcodes not successfully read back after "
+          "writing when setting breakpoints in 0x%" PRIx64 "-0x%" PRIx64,
+          __FUNCTION__, range_addr, range_addr + range_size);
+  }
+
+  if (error.Fail()) {
+    if (log)
+      log->Printf("SoftwareBreakpoint::%s: %s", __FUNCTION__,
+                  error.AsCString());
+    // Don't leave some of the traps behind.
+    size_t bytes_restored = 0;
+    process.WriteMemory(range_addr, saved_bytes.data(), range_size,
+                        bytes_restored);
+    return error;
+  }
+
+  for (lldb::addr_t addr : addrs)
+    breakpoints.push_back(NativeBreakpointSP(new SoftwareBreakpoint(
+        process, addr, saved_bytes.data() + (addr - range_addr),
+        bp_opcode_bytes, bp_opcode_size)));
+
+  if (log)
+    log->Printf("SoftwareBreakpoint::%s %zu breakpoints -- SUCCESS",
+                __FUNCTION__, addrs.size());
+  return Status();
+}
+
+Status SoftwareBreakpoint::GetTrapOpcode(NativeProcessProtocol &process,
+                                         lldb::addr_t addr, size_t size_hint,
+                                         size_t &bp_opcode_size,
+                                         const uint8_t *&bp_opcode_bytes) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+
+  // Ask the NativeProcessProtocol subclass to fill in the correct software
+  // breakpoint trap for the breakpoint site.
   Status error = process.GetSoftwareBreakpointTrapOpcode(
       size_hint, bp_opcode_size, bp_opcode_bytes);
 
@@ -82,27 +214,6 @@ Status SoftwareBreakpoint::CreateSoftwareBreakpoint(
                   addr);
   }
 
-  // Enable the breakpoint.
-  uint8_t saved_opcode_bytes[MAX_TRAP_OPCODE_SIZE];
-  error = EnableSoftwareBreakpoint(process, addr, bp_opcode_size,
-                                   bp_opcode_bytes, saved_opcode_bytes);
-  if (error.Fail()) {
-    if (log)
-      log->Printf("SoftwareBreakpoint::%s: failed to enable new breakpoint at "
-                  "0x%" PRIx64 ": %s",
-                  __FUNCTION__, addr, error.AsCString());
-    return error;
-  }
-
-  if (log)
-    log->Printf("SoftwareBreakpoint::%s addr = 0x%" PRIx64 " -- SUCCESS",
-                __FUNCTION__, addr);
-
-  // Set the breakpoint and verified it was written properly.  Now
-  // create a breakpoint remover that understands how to undo this
-  // breakpoint.
-  breakpoint_sp.reset(new SoftwareBreakpoint(process, addr, saved_opcode_bytes,
-                                             bp_opcode_bytes, bp_opcode_size));
   return Status();
 }
 
@@ -741,7 +741,12 @@ void ClangASTSource::FindExternalVisibleDecls(
                       (name_string ? name_string : "<anonymous>"));
         }
 
-        CompilerType full_type = type_sp->GetFullCompilerType();
+        // With lazy type import, a forward declaration is enough: the
+        // parser completes the type through CompleteType() if it needs the
+        // definition.
+        CompilerType full_type = m_target->GetLazyTypeImport(nullptr)
+                                     ? type_sp->GetForwardCompilerType()
+                                     : type_sp->GetFullCompilerType();
 
         CompilerType copied_clang_type(GuardedCopyType(full_type));
 
@@ -127,8 +127,13 @@ void ClangExpressionDeclMap::InstallCodeGenerator(
 void ClangExpressionDeclMap::DidParse() {
   Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS));
 
-  if (log)
+  if (log) {
+    log->Printf("ClangExpressionDeclMap::DidParse imported %" PRIu64
+                " Decls and completed %" PRIu64 " for this expression",
+                ClangASTMetrics::GetLocalClangImportCount(),
+                ClangASTMetrics::GetLocalDeclCompletionCount());
     ClangASTMetrics::DumpCounters(log);
+  }
 
   if (m_parser_vars.get()) {
     for (size_t entity_index = 0, num_entities = m_found_entities.GetSize();
@@ -1513,7 +1518,16 @@ void ClangExpressionDeclMap::FindExternalVisibleDecls(
       return false;
     }
 
-    CompilerType var_clang_type = var_type->GetFullCompilerType();
+    // With lazy type import the variable's type is only completed when the
+    // parser asks for its definition, so that a variable that is only passed
+    // around doesn't pull in its whole class.
+    Target *target = m_parser_vars->m_exe_ctx.GetTargetPtr();
+    const bool lazy_type_import =
+        target && target->GetLazyTypeImport(&m_parser_vars->m_exe_ctx);
+
+    CompilerType var_clang_type = lazy_type_import
+                                      ? var_type->GetForwardCompilerType()
+                                      : var_type->GetFullCompilerType();
 
     if (!var_clang_type) {
       if (log)
@@ -1558,7 +1572,6 @@ void ClangExpressionDeclMap::FindExternalVisibleDecls(
 
   DWARFExpression &var_location_expr = var->LocationExpression();
 
-  Target *target = m_parser_vars->m_exe_ctx.GetTargetPtr();
   Status err;
 
   if (var->GetLocationIsConstantValueData()) {
@@ -1637,8 +1650,11 @@ void ClangExpressionDeclMap::AddOneVariable(NameSearchContext &context,
     return;
 
   if (const clang::Type *parser_type = parser_opaque_type.getTypePtr()) {
-    if (const TagType *tag_type = dyn_cast<TagType>(parser_type))
-      CompleteType(tag_type->getDecl());
+    if (const TagType *tag_type = dyn_cast<TagType>(parser_type)) {
+      Target *target = m_parser_vars->m_exe_ctx.GetTargetPtr();
+      if (!target || !target->GetLazyTypeImport(&m_parser_vars->m_exe_ctx))
+        CompleteType(tag_type->getDecl());
+    }
     if (const ObjCObjectPointerType *objc_object_ptr_type =
             dyn_cast<ObjCObjectPointerType>(parser_type))
       CompleteType(objc_object_ptr_type->getInterfaceDecl());
@@ -9,6 +9,9 @@
 
 // C Includes
 // C++ Includes
+#include <map>
+#include <mutex>
+
 // Other libraries and framework includes
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -263,6 +266,63 @@ private:
   std::shared_ptr<clang::TextDiagnosticBuffer> m_passthrough;
 };
 
+//===----------------------------------------------------------------------===//
+// Pool of target infos
+//===----------------------------------------------------------------------===//
+
+// Building a clang::TargetInfo computes the feature map and data layout for
+// the target from scratch, and is a noticeable part of the cost of small
+// expressions.  Target infos only depend on the target options, so keep the
+// ones parsers are done with around for the next parser with the same
+// options.  Each one is handed to a single parser at a time, since their
+// reference counts aren't thread safe.
+
+typedef std::multimap<std::string, IntrusiveRefCntPtr<TargetInfo>>
+    TargetInfoPool;
+
+static std::mutex &GetTargetInfoPoolMutex() {
+  static std::mutex g_mutex;
+  return g_mutex;
+}
+
+static TargetInfoPool &GetTargetInfoPool() {
+  static TargetInfoPool g_pool;
+  return g_pool;
+}
+
+static std::string GetTargetInfoPoolKey(const TargetOptions &opts) {
+  std::string key = opts.Triple;
+  key.append(1, ';').append(opts.CPU);
+  key.append(1, ';').append(opts.ABI);
+  key.append(1, ';').append(opts.FPMath);
+  for (const std::string &feature : opts.FeaturesAsWritten)
+    key.append(1, ';').append(feature);
+  key.append(1, '|');
+  for (const std::string &feature : opts.Features)
+    key.append(1, ';').append(feature);
+  return key;
+}
+
+static IntrusiveRefCntPtr<TargetInfo>
+TakeTargetInfoFromPool(const std::string &key) {
+  std::lock_guard<std::mutex> guard(GetTargetInfoPoolMutex());
+  TargetInfoPool &pool = GetTargetInfoPool();
+  auto pos = pool.find(key);
+  if (pos == pool.end())
+    return nullptr;
+  IntrusiveRefCntPtr<TargetInfo> target_info = std::move(pos->second);
+  pool.erase(pos);
+  return target_info;
+}
+
+static void ReturnTargetInfoToPool(std::string key,
+                                   IntrusiveRefCntPtr<TargetInfo> target_info) {
+  // Each parser alive at the same time needs its own target info, so this
+  // only grows with the number of expressions parsed in parallel.
+  std::lock_guard<std::mutex> guard(GetTargetInfoPoolMutex());
+  GetTargetInfoPool().emplace(std::move(key), std::move(target_info));
+}
+
 //===----------------------------------------------------------------------===//
 // Implementation of ClangExpressionParser
 //===----------------------------------------------------------------------===//
@@ -416,10 +476,15 @@ ClangExpressionParser::ClangExpressionParser(ExecutionContextScope *exe_scope,
       StringList::LogDump(log, opts.Reciprocals, "Reciprocals");
     }
 
-  // 4. Create and install the target on the compiler.
+  // 4. Create and install the target on the compiler, reusing one an earlier
+  // expression built for the same options if possible.
   m_compiler->createDiagnostics();
-  auto target_info = TargetInfo::CreateTargetInfo(
-      m_compiler->getDiagnostics(), m_compiler->getInvocation().TargetOpts);
+  m_target_info_key = GetTargetInfoPoolKey(m_compiler->getTargetOpts());
+  m_target_info = TakeTargetInfoFromPool(m_target_info_key);
+  if (!m_target_info)
+    m_target_info = TargetInfo::CreateTargetInfo(
+        m_compiler->getDiagnostics(), m_compiler->getInvocation().TargetOpts);
+  TargetInfo *target_info = m_target_info.get();
   if (log) {
     log->Printf("Using SIMD alignment: %d", target_info->getSimdDefaultAlign());
     log->Printf("Target datalayout string: '%s'",
@@ -607,7 +672,19 @@ ClangExpressionParser::ClangExpressionParser(ExecutionContextScope *exe_scope,
       m_compiler->getCodeGenOpts(), *m_llvm_context));
 }
 
-ClangExpressionParser::~ClangExpressionParser() {}
+ClangExpressionParser::~ClangExpressionParser() {
+  if (!m_target_info)
+    return;
+  // Everything that refers to the target info has to be gone before another
+  // parser can take it from the pool.
+  m_ast_context.reset();
+  m_code_generator.reset();
+  m_selector_table.reset();
+  m_builtin_context.reset();
+  m_compiler.reset();
+  ReturnTargetInfoToPool(std::move(m_target_info_key),
+                         std::move(m_target_info));
+}
 
 unsigned ClangExpressionParser::Parse(DiagnosticManager &diagnostic_manager,
                                       uint32_t first_line, uint32_t last_line,
@@ -892,6 +969,10 @@ lldb_private::Status ClangExpressionParser::PrepareForExecution(
                           function_name, exe_ctx.GetTargetSP(), sc,
                           m_compiler->getTargetOpts().Features));
 
+  // LLDB's own helpers are compiled from the same source every session, so
+  // their object code is worth keeping on disk.
+  execution_unit_sp->SetUseObjectCache(m_expr.CanCacheCompiledCode());
+
   ClangExpressionHelper *type_system_helper =
       dyn_cast<ClangExpressionHelper>(m_expr.GetTypeSystemHelper());
   ClangExpressionDeclMap *decl_map =
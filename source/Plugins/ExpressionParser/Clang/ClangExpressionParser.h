@@ -17,6 +17,8 @@
 #include "lldb/Utility/Status.h"
 #include "lldb/lldb-public.h"
 
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+
 #include <string>
 #include <vector>
 
@@ -161,6 +163,10 @@ private:
   LLDBPreprocessorCallbacks *m_pp_callbacks; ///< Called when the preprocessor
                                              ///encounters module imports
   std::unique_ptr<ClangASTContext> m_ast_context;
+  llvm::IntrusiveRefCntPtr<clang::TargetInfo>
+      m_target_info; ///< The target info installed in the compiler, which
+                     ///goes back to the pool when the parser is destroyed
+  std::string m_target_info_key; ///< The key m_target_info is pooled under
 };
 }
 
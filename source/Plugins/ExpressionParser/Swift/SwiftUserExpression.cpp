@@ -74,6 +74,37 @@ void SwiftUserExpression::DidFinishExecuting() {
   }
 }
 
+// Returns the name of the type ScanContext() gives 'self' in the frame: the
+// dynamic type if it can be found without running the target, or else the
+// declared type.
+static ConstString GetSelfTypeName(StackFrame &frame) {
+  SymbolContext sym_ctx = frame.GetSymbolContext(lldb::eSymbolContextFunction |
+                                                 lldb::eSymbolContextBlock);
+  Block *function_block = sym_ctx.GetFunctionBlock();
+  if (!function_block)
+    return ConstString();
+
+  lldb::VariableListSP variable_list_sp(
+      function_block->GetBlockVariableList(true));
+  if (!variable_list_sp)
+    return ConstString();
+
+  lldb::VariableSP self_var_sp(
+      variable_list_sp->FindVariable(ConstString("self")));
+  if (!self_var_sp || !self_var_sp->LocationIsValidForFrame(&frame))
+    return ConstString();
+
+  lldb::ValueObjectSP valobj_sp = frame.GetValueObjectForFrameVariable(
+      self_var_sp, lldb::eDynamicDontRunTarget);
+  if (valobj_sp && valobj_sp->GetError().Success() &&
+      valobj_sp->GetCompilerType().IsValid())
+    return valobj_sp->GetCompilerType().GetTypeName();
+
+  if (Type *self_lldb_type = self_var_sp->GetType())
+    return self_lldb_type->GetForwardCompilerType().GetTypeName();
+  return ConstString();
+}
+
 void SwiftUserExpression::ScanContext(ExecutionContext &exe_ctx, Status &err) {
   Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS));
 
@@ -121,6 +152,7 @@ void SwiftUserExpression::ScanContext(ExecutionContext &exe_ctx, Status &err) {
   if (frame_is_swift) {
     m_language_flags &= ~eLanguageFlagIsClass;
     m_language_flags &= ~eLanguageFlagNeedsObjectPointer;
+    m_self_type_name = ConstString();
 
     // we need to make sure the Target's SwiftASTContext has been setup BEFORE
     // we do any Swift name lookups
@@ -202,6 +234,8 @@ void SwiftUserExpression::ScanContext(ExecutionContext &exe_ctx, Status &err) {
             break;
           }
 
+          m_self_type_name = self_type.GetTypeName();
+
           // Check to see if we are in a class func of a class (or static func
           // of a struct) and adjust our
           // self_type to point to the instance type.
@@ -628,6 +662,20 @@ bool SwiftUserExpression::Parse(DiagnosticManager &diagnostic_manager,
   }
 }
 
+bool SwiftUserExpression::MatchesContext(ExecutionContext &exe_ctx) {
+  if (!m_swift_generic_info.function_bindings.empty() ||
+      !m_swift_generic_info.class_bindings.empty())
+    return false;
+
+  // Code compiled for a subclass instance would use the subclass layout on
+  // a base class instance.
+  StackFrame *frame = exe_ctx.GetFramePtr();
+  if (!frame || GetSelfTypeName(*frame) != m_self_type_name)
+    return false;
+
+  return UserExpression::MatchesContext(exe_ctx);
+}
+
 bool SwiftUserExpression::AddArguments(ExecutionContext &exe_ctx,
                                        std::vector<lldb::addr_t> &args,
                                        lldb::addr_t struct_address,
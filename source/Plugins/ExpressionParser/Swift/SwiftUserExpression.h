@@ -117,6 +117,15 @@ public:
              bool keep_result_in_memory, bool generate_debug_info,
              uint32_t line_offset = 0) override;
 
+  //------------------------------------------------------------------
+  /// Return true if the expression was parsed for an equivalent context.
+  /// Expressions parsed in generic contexts bake in the generic type
+  /// bindings of the frame they were parsed in, so they are never reused.
+  /// Expressions are compiled for the dynamic type of 'self', so they are
+  /// only reused while 'self' has the same dynamic type.
+  //------------------------------------------------------------------
+  bool MatchesContext(ExecutionContext &exe_ctx) override;
+
   ExpressionTypeSystemHelper *GetTypeSystemHelper() override {
     return &m_type_system_helper;
   }
@@ -153,6 +162,7 @@ private:
                     DiagnosticManager &diagnostic_manager) override;
 
   SwiftUserExpressionHelper m_type_system_helper;
+  ConstString m_self_type_name; ///< The type of 'self' at parse time
 
   class ResultDelegate : public Materializer::PersistentVariableDelegate {
   public:
@@ -16,6 +16,7 @@
 #include <unistd.h>
 
 // C++ Includes
+#include <algorithm>
 #include <fstream>
 #include <mutex>
 #include <sstream>
@@ -52,6 +53,7 @@
 #include "Procfs.h"
 
 #include <linux/unistd.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
@@ -383,8 +385,9 @@ llvm::Expected<std::vector<::pid_t>> NativeProcessLinux::Attach(::pid_t pid) {
   return std::move(tids);
 }
 
-Status NativeProcessLinux::SetDefaultPtraceOpts(lldb::pid_t pid) {
-  long ptrace_opts = 0;
+Status NativeProcessLinux::SetDefaultPtraceOpts(lldb::pid_t pid,
+                                                long extra_opts) {
+  long ptrace_opts = extra_opts;
 
   // Have the child raise an event on exit.  This is used to keep the child in
   // limbo until it is destroyed.
@@ -478,6 +481,14 @@ void NativeProcessLinux::MonitorCallback(lldb::pid_t pid, bool exited,
     LLDB_LOG(log, "tid {0}, si_code: {1}, si_pid: {2}", pid, info.si_code,
              info.si_pid);
 
+    // With forks traced, a forked child can stop before its parent reports
+    // the fork.  MonitorFork takes care of it then.
+    if (m_tracing_forks && !getProcFile(GetID(), pid, "stat")) {
+      LLDB_LOG(log, "tid {0} is a forked child, not a thread", pid);
+      m_stopped_fork_children.insert(pid);
+      return;
+    }
+
     auto thread_sp = AddThread(pid);
 
     // Resume the newly created thread.
@@ -601,10 +612,28 @@ void NativeProcessLinux::MonitorSIGTRAP(const siginfo_t &info,
   assert(info.si_signo == SIGTRAP && "Unexpected child signal!");
 
   switch (info.si_code) {
-  // TODO: these two cases are required if we want to support tracing of the
-  // inferiors' children.  We'd need this to debug a monitor.
-  // case (SIGTRAP | (PTRACE_EVENT_FORK << 8)):
-  // case (SIGTRAP | (PTRACE_EVENT_VFORK << 8)):
+  // Forks are only traced while pages are protected for software
+  // watchpoints, see SetForkTracing.  Debugging the children themselves
+  // would need more than this.
+  case (SIGTRAP | (PTRACE_EVENT_FORK << 8)):
+  case (SIGTRAP | (PTRACE_EVENT_VFORK << 8)): {
+    unsigned long event_message = 0;
+    if (GetEventMessage(thread.GetID(), &event_message).Fail())
+      LLDB_LOG(log,
+               "pid {0} received fork event but GetEventMessage failed so "
+               "we don't know the child's pid",
+               thread.GetID());
+    else
+      MonitorFork(thread, event_message,
+                  info.si_code == (SIGTRAP | (PTRACE_EVENT_VFORK << 8)));
+
+    ResumeThread(thread, thread.GetState(), LLDB_INVALID_SIGNAL_NUMBER);
+    break;
+  }
+
+  case (SIGTRAP | (PTRACE_EVENT_VFORK_DONE << 8)):
+    MonitorVForkDone(thread);
+    break;
 
   case (SIGTRAP | (PTRACE_EVENT_CLONE << 8)): {
     // This is the notification on the parent thread which informs us of new
@@ -636,6 +665,18 @@ void NativeProcessLinux::MonitorSIGTRAP(const siginfo_t &info,
     // Exec clears any pending notifications.
     m_pending_notification_tid = LLDB_INVALID_THREAD_ID;
 
+    // The breakpoint we may have been stepping over is gone with the old
+    // image, don't write its saved opcode into the new one.
+    m_step_over_breakpoint_tid = LLDB_INVALID_THREAD_ID;
+    m_step_over_breakpoint_addr = LLDB_INVALID_ADDRESS;
+
+    // So are the ranges threads were stepping through, the pages protected
+    // for software watchpoints, and the vdso.
+    m_threads_range_stepping.clear();
+    m_software_watchpoints.clear();
+    m_protected_pages.clear();
+    m_syscall_insn_addr = LLDB_INVALID_ADDRESS;
+
     // Remove all but the main thread here.  Linux fork creates a new process
     // which only copies the main thread.
     LLDB_LOG(log, "exec received, stop tracking all but main thread");
@@ -803,6 +844,48 @@ void NativeProcessLinux::MonitorTrace(NativeThreadLinux &thread) {
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
   LLDB_LOG(log, "received trace event, pid = {0}", thread.GetID());
 
+  if (thread.GetID() == m_step_over_breakpoint_tid) {
+    // The thread has stepped past a breakpoint hit the client doesn't need
+    // to know about.  Put the trap back before anything runs: the write goes
+    // through the process id, which fails if the main thread is running, and
+    // a hit in between would go unnoticed.
+    Status error = RestoreSteppedOverBreakpoint();
+    if (error.Fail()) {
+      // Report the stop rather than run on without the breakpoint.
+      thread.SetStoppedByTrace();
+      StopRunningThreads(thread.GetID());
+      return;
+    }
+    ResumeThread(thread, eStateRunning, LLDB_INVALID_SIGNAL_NUMBER);
+    ResumeStoppedThreads();
+    return;
+  }
+
+  auto range_pos = m_threads_range_stepping.find(thread.GetID());
+  if (range_pos != m_threads_range_stepping.end() &&
+      m_pending_notification_tid != LLDB_INVALID_THREAD_ID) {
+    // Another thread's stop is waiting for this one, so stop stepping and
+    // report how far the thread got.
+    m_threads_range_stepping.erase(range_pos);
+    thread.SetStoppedByTrace();
+    SignalIfAllThreadsStopped();
+    return;
+  }
+  if (range_pos != m_threads_range_stepping.end()) {
+    // Keep stepping while the pc is in the range, the client only wants to
+    // hear about the step that leaves it.
+    const lldb::addr_t pc = thread.GetRegisterContext()->GetPC();
+    if (pc >= range_pos->second.first && pc < range_pos->second.second) {
+      Status error =
+          ResumeThread(thread, eStateStepping, LLDB_INVALID_SIGNAL_NUMBER);
+      if (error.Success())
+        return;
+      LLDB_LOG(log, "failed to step tid {0} through range: {1}",
+               thread.GetID(), error);
+    }
+    m_threads_range_stepping.erase(range_pos);
+  }
+
   // This thread is currently stopped.
   thread.SetStoppedByTrace();
 
@@ -915,6 +998,10 @@ void NativeProcessLinux::MonitorSignal(const siginfo_t &info,
     return;
   }
 
+  // Accesses to pages protected for software watchpoints are ours to handle.
+  if (MonitorSoftwareWatchpointFault(info, thread))
+    return;
+
   // Check if debugger should stop at this signal or just ignore it
   // and resume the inferior.
   if (m_signals_to_ignore.find(signo) != m_signals_to_ignore.end()) {
@@ -1131,6 +1218,8 @@ Status NativeProcessLinux::Resume(const ResumeActionList &resume_actions) {
     }
   }
 
+  m_all_threads_continued = true;
+  m_threads_range_stepping.clear();
   for (auto thread_sp : m_threads) {
     assert(thread_sp && "thread list should not contain NULL threads");
 
@@ -1140,12 +1229,21 @@ Status NativeProcessLinux::Resume(const ResumeActionList &resume_actions) {
     if (action == nullptr) {
       LLDB_LOG(log, "no action specified for pid {0} tid {1}", GetID(),
                thread_sp->GetID());
+      m_all_threads_continued = false;
       continue;
     }
 
+    if (action->state != eStateRunning)
+      m_all_threads_continued = false;
+
     LLDB_LOG(log, "processing resume action state {0} for pid {1} tid {2}",
              action->state, GetID(), thread_sp->GetID());
 
+    if (action->state == eStateStepping && !software_single_step &&
+        action->range_start < action->range_end)
+      m_threads_range_stepping[thread_sp->GetID()] = {action->range_start,
+                                                      action->range_end};
+
     switch (action->state) {
     case eStateRunning:
     case eStateStepping: {
@@ -1183,6 +1281,18 @@ Status NativeProcessLinux::Halt() {
 Status NativeProcessLinux::Detach() {
   Status error;
 
+  // Don't leave pages protected for software watchpoints behind, the
+  // inferior would crash on them.  A watchpoint that can't be removed stays
+  // in the map, so walk a copy of the addresses.
+  std::vector<lldb::addr_t> watched_addrs;
+  for (const auto &entry : m_software_watchpoints)
+    watched_addrs.push_back(entry.first);
+  for (lldb::addr_t addr : watched_addrs) {
+    Status e = RemoveSoftwareWatchpoint(addr);
+    if (e.Fail())
+      error = e;
+  }
+
   // Stop monitoring the inferior.
   m_sigchld_handle.reset();
 
@@ -1384,6 +1494,17 @@ ParseMemoryRegionInfoFromProcMapsLine(llvm::StringRef &maps_line,
   return Status();
 }
 
+static uint32_t GetProtection(const MemoryRegionInfo &region) {
+  uint32_t prot = PROT_NONE;
+  if (region.GetReadable() == MemoryRegionInfo::eYes)
+    prot |= PROT_READ;
+  if (region.GetWritable() == MemoryRegionInfo::eYes)
+    prot |= PROT_WRITE;
+  if (region.GetExecutable() == MemoryRegionInfo::eYes)
+    prot |= PROT_EXEC;
+  return prot;
+}
+
 Status NativeProcessLinux::GetMemoryRegionInfo(lldb::addr_t load_addr,
                                                MemoryRegionInfo &range_info) {
   // FIXME review that the final memory region returned extends to the end of
@@ -1434,6 +1555,7 @@ Status NativeProcessLinux::GetMemoryRegionInfo(lldb::addr_t load_addr,
     } else if (proc_entry_info.GetRange().Contains(load_addr)) {
       // The target address is within the memory region we're processing here.
       range_info = proc_entry_info;
+      AdjustForProtectedPages(load_addr, range_info);
       return error;
     }
 
@@ -1455,6 +1577,64 @@ Status NativeProcessLinux::GetMemoryRegionInfo(lldb::addr_t load_addr,
   return error;
 }
 
+void NativeProcessLinux::AdjustForProtectedPages(
+    lldb::addr_t load_addr, MemoryRegionInfo &range_info) const {
+  if (m_protected_pages.empty())
+    return;
+
+  // A page's protection as the inferior set it.
+  const lldb::addr_t page_size = getpagesize();
+  const lldb::addr_t base = range_info.GetRange().GetRangeBase();
+  const lldb::addr_t end = range_info.GetRange().GetRangeEnd();
+  const uint32_t region_prot = GetProtection(range_info);
+  const lldb::addr_t page = load_addr & ~(page_size - 1);
+  auto page_it = m_protected_pages.find(page);
+  const uint32_t prot = page_it != m_protected_pages.end()
+                            ? page_it->second.original_prot
+                            : region_prot;
+
+  // Grow [lo, hi) from the page at load_addr over the neighbouring pages
+  // that had the same protection, skipping over unprotected runs at once.
+  lldb::addr_t lo = std::max(page, base);
+  while (lo > base) {
+    auto it = m_protected_pages.lower_bound(lo);
+    const bool have_prev = it != m_protected_pages.begin() &&
+                           std::prev(it)->first >= base;
+    if (have_prev && std::prev(it)->first + page_size == lo) {
+      if (std::prev(it)->second.original_prot != prot)
+        break;
+      lo -= page_size;
+    } else {
+      if (region_prot != prot)
+        break;
+      lo = have_prev ? std::prev(it)->first + page_size : base;
+    }
+  }
+  lldb::addr_t hi = std::min(page + page_size, end);
+  while (hi < end) {
+    auto it = m_protected_pages.lower_bound(hi);
+    const bool have_next = it != m_protected_pages.end() && it->first < end;
+    if (have_next && it->first == hi) {
+      if (it->second.original_prot != prot)
+        break;
+      hi += page_size;
+    } else {
+      if (region_prot != prot)
+        break;
+      hi = have_next ? it->first : end;
+    }
+  }
+
+  range_info.GetRange().SetRangeBase(lo);
+  range_info.GetRange().SetRangeEnd(hi);
+  range_info.SetReadable(prot & PROT_READ ? MemoryRegionInfo::eYes
+                                          : MemoryRegionInfo::eNo);
+  range_info.SetWritable(prot & PROT_WRITE ? MemoryRegionInfo::eYes
+                                           : MemoryRegionInfo::eNo);
+  range_info.SetExecutable(prot & PROT_EXEC ? MemoryRegionInfo::eYes
+                                            : MemoryRegionInfo::eNo);
+}
+
 Status NativeProcessLinux::PopulateMemoryRegionCache() {
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
 
@@ -1614,6 +1794,15 @@ Status NativeProcessLinux::SetBreakpoint(lldb::addr_t addr, uint32_t size,
     return SetSoftwareBreakpoint(addr, size);
 }
 
+void NativeProcessLinux::SetBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs,
+                                       uint32_t size_hint, bool hardware,
+                                       std::vector<Status> &errors) {
+  if (hardware)
+    NativeProcessProtocol::SetBreakpoints(addrs, size_hint, hardware, errors);
+  else
+    SetSoftwareBreakpoints(addrs, size_hint, errors);
+}
+
 Status NativeProcessLinux::RemoveBreakpoint(lldb::addr_t addr, bool hardware) {
   if (hardware)
     return RemoveHardwareBreakpoint(addr);
@@ -1621,6 +1810,705 @@ Status NativeProcessLinux::RemoveBreakpoint(lldb::addr_t addr, bool hardware) {
     return NativeProcessProtocol::RemoveBreakpoint(addr);
 }
 
+namespace {
+// What it takes to run a syscall on the architectures that support
+// watchpoints implemented with page protection.
+struct SyscallABI {
+  const uint8_t *insn;
+  size_t insn_size;
+  const char *number_reg; // Also holds the result.
+  const char *arg_regs[3];
+  uint64_t mprotect_number;
+};
+} // anonymous namespace
+
+static const SyscallABI *GetSyscallABI(const ArchSpec &arch) {
+  static const uint8_t g_x86_64_syscall[] = {0x0f, 0x05}; // syscall
+  static const uint8_t g_i386_syscall[] = {0xcd, 0x80};   // int $0x80
+  static const SyscallABI g_x86_64_abi = {
+      g_x86_64_syscall, sizeof(g_x86_64_syscall), "rax", {"rdi", "rsi", "rdx"},
+      10};
+  static const SyscallABI g_i386_abi = {
+      g_i386_syscall, sizeof(g_i386_syscall), "eax", {"ebx", "ecx", "edx"},
+      125};
+
+  switch (arch.GetMachine()) {
+  case llvm::Triple::x86_64:
+    return &g_x86_64_abi;
+  case llvm::Triple::x86:
+    return &g_i386_abi;
+  default:
+    return nullptr;
+  }
+}
+
+Status NativeProcessLinux::SetWatchpoint(lldb::addr_t addr, size_t size,
+                                         uint32_t watch_flags, bool hardware) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS |
+                                    LIBLLDB_LOG_WATCHPOINTS));
+
+  // Replace any software watchpoint at this address, like the threads do for
+  // hardware ones.
+  if (m_software_watchpoints.count(addr)) {
+    Status error = RemoveSoftwareWatchpoint(addr);
+    if (error.Fail())
+      return error;
+  }
+
+  // The debug registers are much cheaper, use them whenever they can take
+  // the watchpoint.
+  Status error =
+      NativeProcessProtocol::SetWatchpoint(addr, size, watch_flags, hardware);
+  if (error.Success())
+    return error;
+
+  LLDB_LOG(log,
+           "pid {0} can't watch [{1:x}, {2:x}) with the debug registers ({3}), "
+           "falling back to page protection",
+           GetID(), addr, addr + size, error);
+  Status sw_error = SetSoftwareWatchpoint(addr, size, watch_flags);
+  if (sw_error.Fail()) {
+    LLDB_LOG(log, "pid {0} page protection watchpoint failed: {1}", GetID(),
+             sw_error);
+    return error;
+  }
+  return sw_error;
+}
+
+Status NativeProcessLinux::RemoveWatchpoint(lldb::addr_t addr) {
+  if (m_software_watchpoints.count(addr))
+    return RemoveSoftwareWatchpoint(addr);
+  return NativeProcessProtocol::RemoveWatchpoint(addr);
+}
+
+Status NativeProcessLinux::SetSoftwareWatchpoint(lldb::addr_t addr,
+                                                 size_t size,
+                                                 uint32_t watch_flags) {
+  if (size == 0)
+    return Status("cannot watch zero bytes");
+  if ((watch_flags & 0x3) == 0)
+    return Status("invalid watchpoint flags 0x%" PRIx32, watch_flags);
+  if (!GetSyscallABI(m_arch))
+    return Status("page protection watchpoints are not supported on %s",
+                  m_arch.GetArchitectureName());
+
+  // Any stopped thread can run the mprotect calls for us.
+  NativeThreadLinuxSP thread_sp = GetThreadByID(GetCurrentThreadID());
+  if (!thread_sp || StateIsRunningState(thread_sp->GetState()))
+    return Status("no stopped thread to protect the watched pages with");
+
+  // Forked children would crash on the protected pages, see MonitorFork.
+  Status error = SetForkTracing(true);
+  if (error.Fail())
+    return error;
+
+  m_software_watchpoints[addr] = {addr, size, watch_flags};
+  error = UpdatePageProtections(*thread_sp, addr, size);
+  if (error.Fail()) {
+    m_software_watchpoints.erase(addr);
+    UpdatePageProtections(*thread_sp, addr, size);
+    if (m_software_watchpoints.empty())
+      SetForkTracing(false);
+  }
+  // The protections in /proc/pid/maps have changed.
+  m_mem_region_cache.clear();
+  return error;
+}
+
+Status NativeProcessLinux::RemoveSoftwareWatchpoint(lldb::addr_t addr) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS |
+                                    LIBLLDB_LOG_WATCHPOINTS));
+
+  auto wp_it = m_software_watchpoints.find(addr);
+  if (wp_it == m_software_watchpoints.end())
+    return Status();
+
+  // Keep the watchpoint until its pages are unprotected, so that they are
+  // never left protected without a record of why.
+  NativeThreadLinuxSP thread_sp = GetThreadByID(GetCurrentThreadID());
+  if (!thread_sp || StateIsRunningState(thread_sp->GetState()))
+    return Status("no stopped thread to unprotect the watched pages with");
+
+  const SoftwareWatchpoint wp = wp_it->second;
+  m_software_watchpoints.erase(wp_it);
+  Status error = UpdatePageProtections(*thread_sp, addr, wp.size);
+  m_mem_region_cache.clear();
+  if (error.Fail()) {
+    // The pages may still be protected for it, keep handling its faults.
+    m_software_watchpoints.emplace(addr, wp);
+    return error;
+  }
+
+  if (m_software_watchpoints.empty()) {
+    Status fork_error = SetForkTracing(false);
+    if (fork_error.Fail())
+      LLDB_LOG(log, "pid {0} failed to stop tracing forks: {1}", GetID(),
+               fork_error);
+
+    const SoftwareWatchpointStats &stats = m_software_watchpoint_stats;
+    LLDB_LOG(log,
+             "pid {0} page protection watchpoints: {1} faults, {2} hits, "
+             "{3} syscalls, {4} us handling faults",
+             GetID(), stats.faults, stats.hits, stats.syscalls,
+             std::chrono::duration_cast<std::chrono::microseconds>(
+                 stats.fault_time)
+                 .count());
+  }
+  return Status();
+}
+
+Status NativeProcessLinux::SetForkTracing(bool enable) {
+  if (enable == m_tracing_forks)
+    return Status();
+
+  // Threads created later inherit the options, but every existing thread
+  // has to be told.
+  const long fork_opts =
+      PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_TRACEVFORKDONE;
+  Status error;
+  for (const auto &thread_sp : m_threads) {
+    error = SetDefaultPtraceOpts(thread_sp->GetID(), enable ? fork_opts : 0);
+    if (error.Fail())
+      break;
+  }
+  if (error.Fail()) {
+    for (const auto &thread_sp : m_threads)
+      SetDefaultPtraceOpts(thread_sp->GetID(), m_tracing_forks ? fork_opts : 0);
+    return error;
+  }
+  m_tracing_forks = enable;
+  return Status();
+}
+
+Status
+NativeProcessLinux::RestoreOriginalProtections(NativeThreadLinux &thread) {
+  const lldb::addr_t page_size = getpagesize();
+  lldb::addr_t run_start = LLDB_INVALID_ADDRESS;
+  lldb::addr_t run_end = LLDB_INVALID_ADDRESS;
+  uint32_t run_prot = PROT_NONE;
+  Status error;
+  auto flush_run = [&]() {
+    if (run_start != LLDB_INVALID_ADDRESS && error.Success())
+      error = ProtectPages(thread, run_start, run_end - run_start, run_prot);
+    run_start = LLDB_INVALID_ADDRESS;
+  };
+
+  for (const auto &entry : m_protected_pages) {
+    const lldb::addr_t page = entry.first;
+    const ProtectedPage &protected_page = entry.second;
+    if (protected_page.prot == protected_page.original_prot) {
+      flush_run();
+      continue;
+    }
+    if (run_start != LLDB_INVALID_ADDRESS &&
+        (run_end != page || run_prot != protected_page.original_prot))
+      flush_run();
+    if (run_start == LLDB_INVALID_ADDRESS) {
+      run_start = page;
+      run_prot = protected_page.original_prot;
+    }
+    run_end = page + page_size;
+  }
+  flush_run();
+  return error;
+}
+
+void NativeProcessLinux::MonitorFork(NativeThreadLinux &parent,
+                                     ::pid_t child_pid, bool is_vfork) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS |
+                                    LIBLLDB_LOG_WATCHPOINTS));
+  LLDB_LOG(log, "tid {0} {1} child {2}", parent.GetID(),
+           is_vfork ? "vforked" : "forked", child_pid);
+
+  // The child starts out stopped, wait for that unless the main loop has
+  // already seen it.
+  if (!m_stopped_fork_children.erase(child_pid)) {
+    int status = 0;
+    ::pid_t wait_pid = llvm::sys::RetryAfterSignal(-1, ::waitpid, child_pid,
+                                                   &status, __WALL);
+    if (wait_pid != child_pid || !WIFSTOPPED(status)) {
+      LLDB_LOG(log, "child {0} went away before it could be released",
+               child_pid);
+      return;
+    }
+  }
+
+  // The child has its own copy of the protected pages after a fork, and
+  // shares ours after a vfork.  Either way, it mustn't run into them.
+  NativeThreadLinux child_thread(*this, child_pid);
+  Status error = RestoreOriginalProtections(child_thread);
+  if (error.Fail())
+    LLDB_LOG(log, "failed to restore page protections in child {0}: {1}",
+             child_pid, error);
+  else if (is_vfork) {
+    // Until MonitorVForkDone protects them again, nothing is watched.
+    for (auto &entry : m_protected_pages)
+      entry.second.prot = entry.second.original_prot;
+    m_mem_region_cache.clear();
+  }
+
+  error = Detach(child_pid);
+  if (error.Fail())
+    LLDB_LOG(log, "failed to detach from child {0}: {1}", child_pid, error);
+}
+
+void NativeProcessLinux::MonitorVForkDone(NativeThreadLinux &thread) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS |
+                                    LIBLLDB_LOG_WATCHPOINTS));
+  if (m_software_watchpoints.empty()) {
+    ResumeThread(thread, thread.GetState(), LLDB_INVALID_SIGNAL_NUMBER);
+    return;
+  }
+
+  // The thread is still inside vfork, whose return would clobber the
+  // registers InjectSyscall sets up.  Step out of it first.
+  const lldb::tid_t tid = thread.GetID();
+  siginfo_t fault;
+  Status error = SingleStepSynchronously(tid, fault);
+  if (!GetThreadByID(tid))
+    return;
+  if (error.Success() && fault.si_signo == 0) {
+    for (const auto &entry : m_software_watchpoints) {
+      error = UpdatePageProtections(thread, entry.second.addr,
+                                    entry.second.size);
+      if (error.Fail())
+        break;
+    }
+    m_mem_region_cache.clear();
+  }
+  if (error.Fail())
+    LLDB_LOG(log, "tid {0} failed to protect watched pages after vfork: {1}",
+             tid, error);
+
+  if (fault.si_signo != 0) {
+    thread.SetStoppedBySignal(fault.si_signo, &fault);
+    StopRunningThreads(tid);
+  } else if (thread.GetState() == eStateStepping)
+    MonitorTrace(thread);
+  else
+    ResumeThread(thread, thread.GetState(), LLDB_INVALID_SIGNAL_NUMBER);
+}
+
+bool NativeProcessLinux::IsProtectedForWatchpoints(lldb::addr_t page) const {
+  auto pos = m_protected_pages.find(page);
+  return pos != m_protected_pages.end() &&
+         pos->second.prot != pos->second.original_prot;
+}
+
+Status NativeProcessLinux::UpdatePageProtections(NativeThreadLinux &thread,
+                                                 lldb::addr_t addr,
+                                                 size_t size) {
+  const lldb::addr_t page_size = getpagesize();
+  const lldb::addr_t first_page = addr & ~(page_size - 1);
+  const lldb::addr_t end_page =
+      (addr + size + page_size - 1) & ~(page_size - 1);
+
+  // Contiguous pages that need the same protection are changed with a single
+  // mprotect call, so watching a large buffer stays cheap.
+  lldb::addr_t run_start = LLDB_INVALID_ADDRESS;
+  lldb::addr_t run_end = LLDB_INVALID_ADDRESS;
+  uint32_t run_prot = PROT_NONE;
+  Status error;
+  auto flush_run = [&]() {
+    if (run_start != LLDB_INVALID_ADDRESS && error.Success())
+      error = ProtectPages(thread, run_start, run_end - run_start, run_prot);
+    run_start = LLDB_INVALID_ADDRESS;
+  };
+
+  for (lldb::addr_t page = first_page; page != end_page; page += page_size) {
+    bool watch_read = false;
+    bool watch_write = false;
+    for (const auto &entry : m_software_watchpoints) {
+      const SoftwareWatchpoint &wp = entry.second;
+      if (wp.addr >= page + page_size || wp.addr + wp.size <= page)
+        continue;
+      watch_read |= (wp.watch_flags & 0x2) != 0;
+      watch_write |= (wp.watch_flags & 0x1) != 0;
+    }
+
+    auto page_it = m_protected_pages.find(page);
+    uint32_t original_prot;
+    uint32_t current_prot;
+    if (page_it != m_protected_pages.end()) {
+      original_prot = page_it->second.original_prot;
+      current_prot = page_it->second.prot;
+    } else if (!watch_read && !watch_write) {
+      flush_run();
+      continue;
+    } else {
+      MemoryRegionInfo region;
+      error = GetMemoryRegionInfo(page, region);
+      if (error.Fail())
+        break;
+      if (region.GetMapped() != MemoryRegionInfo::eYes ||
+          region.GetReadable() != MemoryRegionInfo::eYes) {
+        error.SetErrorStringWithFormat(
+            "cannot watch unreadable memory at 0x%" PRIx64, page);
+        break;
+      }
+      original_prot = current_prot = GetProtection(region);
+    }
+
+    // Reads can only be caught by taking all access away; writes just need
+    // the page to be read only.
+    uint32_t prot = original_prot;
+    if (watch_read)
+      prot = PROT_NONE;
+    else if (watch_write)
+      prot = original_prot & ~PROT_WRITE;
+
+    if (watch_read || watch_write)
+      m_protected_pages[page] = {original_prot, prot};
+    else
+      m_protected_pages.erase(page);
+
+    if (prot == current_prot) {
+      flush_run();
+      continue;
+    }
+    if (run_start != LLDB_INVALID_ADDRESS &&
+        (run_end != page || run_prot != prot))
+      flush_run();
+    if (run_start == LLDB_INVALID_ADDRESS) {
+      run_start = page;
+      run_prot = prot;
+    }
+    run_end = page + page_size;
+  }
+  flush_run();
+  return error;
+}
+
+Status NativeProcessLinux::ProtectPages(NativeThreadLinux &thread,
+                                       lldb::addr_t addr, size_t size,
+                                       uint32_t prot) {
+  const SyscallABI *abi = GetSyscallABI(m_arch);
+  if (!abi)
+    return Status("don't know how to run mprotect on %s",
+                  m_arch.GetArchitectureName());
+
+  int64_t result = 0;
+  Status error = InjectSyscall(thread, abi->mprotect_number,
+                               {addr, size, prot}, result);
+  if (error.Fail())
+    return error;
+  if (result < 0)
+    return Status(-result, eErrorTypePOSIX);
+  return Status();
+}
+
+Status NativeProcessLinux::InjectSyscall(NativeThreadLinux &thread,
+                                        uint64_t sysno,
+                                        llvm::ArrayRef<uint64_t> args,
+                                        int64_t &result) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  const SyscallABI *abi = GetSyscallABI(m_arch);
+  if (!abi || args.size() > llvm::array_lengthof(abi->arg_regs))
+    return Status("can't run syscall %" PRIu64 " on %s", sysno,
+                  m_arch.GetArchitectureName());
+
+  // Use a syscall instruction the vdso already has instead of writing one at
+  // the pc, which other threads may be running concurrently.
+  if (m_syscall_insn_addr == LLDB_INVALID_ADDRESS) {
+    Status error = PopulateMemoryRegionCache();
+    if (error.Fail())
+      return error;
+    for (const auto &entry : m_mem_region_cache) {
+      const MemoryRegionInfo &region = entry.first;
+      if (region.GetName() != ConstString("[vdso]") ||
+          region.GetExecutable() != MemoryRegionInfo::eYes)
+        continue;
+      std::vector<uint8_t> bytes(region.GetRange().GetByteSize());
+      size_t bytes_read = 0;
+      error = ReadMemory(region.GetRange().GetRangeBase(), bytes.data(),
+                         bytes.size(), bytes_read);
+      if (error.Fail())
+        return error;
+      auto pos = std::search(bytes.begin(), bytes.begin() + bytes_read,
+                             abi->insn, abi->insn + abi->insn_size);
+      if (pos != bytes.begin() + bytes_read)
+        m_syscall_insn_addr =
+            region.GetRange().GetRangeBase() + (pos - bytes.begin());
+      break;
+    }
+    if (m_syscall_insn_addr == LLDB_INVALID_ADDRESS)
+      return Status("no syscall instruction found in the vdso");
+    LLDB_LOG(log, "pid {0} running syscalls from {1:x}", GetID(),
+             m_syscall_insn_addr);
+  }
+
+  const lldb::tid_t tid = thread.GetID();
+  // If one of our threads exits while stepping, MonitorCallback may destroy
+  // it, so hold on to it.
+  NativeThreadLinuxSP thread_sp = GetThreadByID(tid);
+  NativeRegisterContextSP reg_ctx_sp = thread.GetRegisterContext();
+  if (!reg_ctx_sp)
+    return Status("no register context for thread %" PRIu64, tid);
+
+  const RegisterInfo *number_reg =
+      reg_ctx_sp->GetRegisterInfoByName(abi->number_reg);
+  if (!number_reg)
+    return Status("no %s register", abi->number_reg);
+
+  DataBufferSP saved_regs_sp;
+  Status error = reg_ctx_sp->ReadAllRegisterValues(saved_regs_sp);
+  if (error.Fail())
+    return error;
+
+  error = reg_ctx_sp->WriteRegisterFromUnsigned(number_reg, sysno);
+  for (size_t i = 0; i < args.size() && error.Success(); ++i) {
+    const RegisterInfo *arg_reg =
+        reg_ctx_sp->GetRegisterInfoByName(abi->arg_regs[i]);
+    if (!arg_reg)
+      error.SetErrorStringWithFormat("no %s register", abi->arg_regs[i]);
+    else
+      error = reg_ctx_sp->WriteRegisterFromUnsigned(arg_reg, args[i]);
+  }
+  if (error.Success())
+    error = reg_ctx_sp->SetPC(m_syscall_insn_addr);
+
+  siginfo_t fault;
+  if (error.Success())
+    error = SingleStepSynchronously(tid, fault);
+  if (error.Success() && fault.si_signo != 0)
+    error.SetErrorStringWithFormat("syscall %" PRIu64 " raised signal %d",
+                                   sysno, fault.si_signo);
+  if (thread_sp && !GetThreadByID(tid))
+    return Status("thread %" PRIu64 " exited while running syscall %" PRIu64,
+                  tid, sysno);
+
+  if (error.Success()) {
+    ++m_software_watchpoint_stats.syscalls;
+    uint64_t value = reg_ctx_sp->ReadRegisterAsUnsigned(number_reg, 0);
+    if (number_reg->byte_size == 4)
+      result = static_cast<int32_t>(value);
+    else
+      result = static_cast<int64_t>(value);
+  }
+
+  Status restore_error = reg_ctx_sp->WriteAllRegisterValues(saved_regs_sp);
+  return error.Fail() ? error : restore_error;
+}
+
+Status NativeProcessLinux::SingleStepSynchronously(lldb::tid_t tid,
+                                                   siginfo_t &fault) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  fault.si_signo = 0;
+  std::vector<int> deferred_signals;
+  Status error;
+  while (true) {
+    error = PtraceWrapper(PTRACE_SINGLESTEP, tid);
+    if (error.Fail())
+      break;
+
+    int status = 0;
+    ::pid_t wait_pid =
+        llvm::sys::RetryAfterSignal(-1, ::waitpid, tid, &status, __WALL);
+    if (wait_pid == -1) {
+      error.SetErrorToErrno();
+      break;
+    }
+
+    WaitStatus wait_status = WaitStatus::Decode(status);
+    if (wait_status.type != WaitStatus::Stop) {
+      // Nobody else will see this event, hand it over as the main loop would.
+      LLDB_LOG(log, "tid {0} exited while stepping: {1}", tid, wait_status);
+      error.SetErrorStringWithFormat("thread %" PRIu64 " exited", tid);
+      bool exited = wait_status.type == WaitStatus::Exit ||
+                    static_cast<lldb::pid_t>(tid) == GetID();
+      if (GetThreadByID(tid))
+        MonitorCallback(tid, exited, wait_status);
+      return error;
+    }
+
+    const int signo = WSTOPSIG(status);
+    if (signo == SIGTRAP && (status >> 16) == 0)
+      break; // The step is done.
+    if (signo == SIGTRAP) {
+      error.SetErrorStringWithFormat(
+          "unexpected ptrace event %d while stepping", status >> 16);
+      break;
+    }
+
+    siginfo_t info;
+    error = GetSignalInfo(tid, &info);
+    if (error.Fail())
+      break;
+    if ((signo == SIGSEGV || signo == SIGBUS || signo == SIGILL ||
+         signo == SIGFPE) &&
+        info.si_code > 0) {
+      // The instruction itself faulted.
+      fault = info;
+      break;
+    }
+
+    // An asynchronous signal interrupted the step.  Hold it back and try
+    // again.
+    LLDB_LOG(log, "tid {0} received signal {1} while stepping, deferring it",
+             tid, Host::GetSignalAsCString(signo));
+    deferred_signals.push_back(signo);
+  }
+
+  // A forked child is the leader of its own thread group.
+  const ::pid_t tgid = GetThreadByID(tid) ? GetID() : tid;
+  for (int signo : deferred_signals)
+    syscall(__NR_tgkill, tgid, static_cast<::pid_t>(tid), signo);
+  return error;
+}
+
+bool NativeProcessLinux::MonitorSoftwareWatchpointFault(
+    const siginfo_t &info, NativeThreadLinux &thread) {
+  if (info.si_signo != SIGSEGV || info.si_code != SEGV_ACCERR)
+    return false;
+
+  const lldb::addr_t page_size = getpagesize();
+  const lldb::addr_t fault_addr = reinterpret_cast<uintptr_t>(info.si_addr);
+  const lldb::addr_t fault_page = fault_addr & ~(page_size - 1);
+  if (!IsProtectedForWatchpoints(fault_page))
+    return false;
+
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS |
+                                    LIBLLDB_LOG_WATCHPOINTS));
+  LLDB_LOG(log, "tid {0} faulted on watched page {1:x} at {2:x}",
+           thread.GetID(), fault_page, fault_addr);
+
+  SoftwareWatchpointStats &stats = m_software_watchpoint_stats;
+  const auto start_time = std::chrono::steady_clock::now();
+  ++stats.faults;
+
+  const lldb::tid_t tid = thread.GetID();
+  // A page that isn't writable doesn't fault on reads, so any fault on it is
+  // a write.  A page without any access can't tell the two apart, a write is
+  // detected by comparing the watched bytes.
+  const bool write_fault = m_protected_pages[fault_page].prot != PROT_NONE;
+
+  // Give the faulting page, and any other watched page the same instruction
+  // touches, its original protection back and step over the access.  Other
+  // threads keep running meanwhile, so their accesses to these pages during
+  // the step aren't seen.
+  std::vector<lldb::addr_t> pages;
+  std::vector<lldb::addr_t> fault_addrs;
+  std::vector<std::pair<lldb::addr_t, std::vector<uint8_t>>> snapshots;
+  siginfo_t fault = info;
+  Status error;
+  do {
+    const lldb::addr_t page = reinterpret_cast<uintptr_t>(fault.si_addr) &
+                              ~(page_size - 1);
+    if (fault.si_signo != SIGSEGV || fault.si_code != SEGV_ACCERR ||
+        !IsProtectedForWatchpoints(page) ||
+        std::find(pages.begin(), pages.end(), page) != pages.end())
+      break; // A genuine fault.
+
+    error = ProtectPages(thread, page, page_size,
+                         m_protected_pages[page].original_prot);
+    if (error.Fail())
+      break;
+    pages.push_back(page);
+    fault_addrs.push_back(reinterpret_cast<uintptr_t>(fault.si_addr));
+
+    for (const auto &entry : m_software_watchpoints) {
+      const SoftwareWatchpoint &wp = entry.second;
+      const lldb::addr_t lo = std::max(wp.addr, page);
+      const lldb::addr_t hi = std::min(wp.addr + wp.size, page + page_size);
+      if (lo >= hi || !(wp.watch_flags & 0x1))
+        continue;
+      std::vector<uint8_t> bytes(hi - lo);
+      size_t bytes_read = 0;
+      if (ReadMemory(lo, bytes.data(), bytes.size(), bytes_read).Success())
+        snapshots.emplace_back(lo, std::move(bytes));
+    }
+
+    error = SingleStepSynchronously(tid, fault);
+  } while (error.Success() && fault.si_signo != 0);
+
+  if (!GetThreadByID(tid)) {
+    stats.fault_time += std::chrono::steady_clock::now() - start_time;
+    return true;
+  }
+
+  // Work out which watchpoint, if any, the access hit before protecting the
+  // pages again.
+  const SoftwareWatchpoint *hit_wp = nullptr;
+  lldb::addr_t hit_addr = fault_addr;
+  if (error.Success() && fault.si_signo == 0) {
+    for (const auto &entry : m_software_watchpoints) {
+      const SoftwareWatchpoint &wp = entry.second;
+      bool contains = false;
+      for (lldb::addr_t addr : fault_addrs) {
+        if (addr >= wp.addr && addr < wp.addr + wp.size) {
+          contains = true;
+          hit_addr = addr;
+          break;
+        }
+      }
+      bool changed = false;
+      for (const auto &snapshot : snapshots) {
+        if (snapshot.first < wp.addr ||
+            snapshot.first >= wp.addr + wp.size)
+          continue;
+        std::vector<uint8_t> bytes(snapshot.second.size());
+        size_t bytes_read = 0;
+        if (ReadMemory(snapshot.first, bytes.data(), bytes.size(), bytes_read)
+                .Success() &&
+            bytes != snapshot.second) {
+          changed = true;
+          break;
+        }
+      }
+      const bool is_write = write_fault || changed;
+      if ((is_write && (wp.watch_flags & 0x1) && (contains || changed)) ||
+          (!is_write && (wp.watch_flags & 0x2) && contains)) {
+        hit_wp = &wp;
+        break;
+      }
+    }
+  }
+
+  for (lldb::addr_t page : pages) {
+    Status protect_error =
+        ProtectPages(thread, page, page_size, m_protected_pages[page].prot);
+    if (protect_error.Fail())
+      LLDB_LOG(log, "failed to protect page {0:x} again: {1}", page,
+               protect_error);
+  }
+  stats.fault_time += std::chrono::steady_clock::now() - start_time;
+
+  if (error.Fail()) {
+    LLDB_LOG(log, "tid {0} failed to step over watched access: {1}", tid,
+             error);
+    return false;
+  }
+
+  if (fault.si_signo != 0) {
+    // The instruction faulted for reasons of its own, report that fault.
+    if (m_signals_to_ignore.count(fault.si_signo)) {
+      ResumeThread(thread, thread.GetState(), fault.si_signo);
+      return true;
+    }
+    thread.SetStoppedBySignal(fault.si_signo, &fault);
+    StopRunningThreads(tid);
+    return true;
+  }
+
+  if (hit_wp) {
+    ++stats.hits;
+    LLDB_LOG(log, "tid {0} hit watchpoint {1:x} at {2:x}", tid, hit_wp->addr,
+             hit_addr);
+    thread.SetStoppedBySoftwareWatchpoint(hit_wp->addr, hit_addr);
+    StopRunningThreads(tid);
+    return true;
+  }
+
+  // A false alarm: something else on the page was accessed.
+  if (thread.GetState() == eStateStepping)
+    MonitorTrace(thread);
+  else
+    ResumeThread(thread, thread.GetState(), LLDB_INVALID_SIGNAL_NUMBER);
+  return true;
+}
+
 Status NativeProcessLinux::GetSoftwareBreakpointTrapOpcode(
     size_t trap_opcode_size_hint, size_t &actual_opcode_size,
     const uint8_t *&trap_opcode_bytes) {
@@ -1990,6 +2878,12 @@ bool NativeProcessLinux::StopTrackingThread(lldb::tid_t thread_id) {
 
   if (found)
     StopTracingForThread(thread_id);
+
+  // If the thread went away while stepping over a breakpoint, don't leave
+  // the other threads waiting for the step to finish.
+  if (thread_id == m_step_over_breakpoint_tid)
+    FinishStepOverBreakpoint();
+
   SignalIfAllThreadsStopped();
   return found;
 }
@@ -2222,6 +3116,15 @@ void NativeProcessLinux::SignalIfAllThreadsStopped() {
   Log *log(
       GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_BREAKPOINTS));
 
+  // Something other than the step, e.g. a signal, stopped the thread that
+  // was stepping over a breakpoint.  Put the breakpoint back before the
+  // client gets to see the process.
+  if (m_step_over_breakpoint_tid != LLDB_INVALID_THREAD_ID)
+    RestoreSteppedOverBreakpoint();
+
+  if (StepOverSkippedBreakpointHit())
+    return;
+
   // Clear any temporary breakpoints we used to implement software single
   // stepping.
   for (const auto &thread_info : m_threads_stepping_with_breakpoint) {
@@ -2238,6 +3141,95 @@ void NativeProcessLinux::SignalIfAllThreadsStopped() {
   m_pending_notification_tid = LLDB_INVALID_THREAD_ID;
 }
 
+bool NativeProcessLinux::StepOverSkippedBreakpointHit() {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+
+  // We need every thread to be continued once we're done, and a hardware
+  // single step that doesn't involve temporary breakpoints.
+  if (!m_all_threads_continued || !SupportHardwareSingleStepping() ||
+      !m_threads_stepping_with_breakpoint.empty())
+    return false;
+
+  NativeThreadLinuxSP thread_sp = GetThreadByID(m_pending_notification_tid);
+  if (!thread_sp || !thread_sp->IsStoppedAtBreakpoint())
+    return false;
+
+  // All the other threads must have been stopped by us, if any of them has
+  // something to report the client gets to see everything.
+  for (const auto &other_thread_sp : m_threads) {
+    if (other_thread_sp == thread_sp)
+      continue;
+    ThreadStopInfo stop_info;
+    std::string description;
+    if (!other_thread_sp->GetStopReason(stop_info, description) ||
+        stop_info.reason != eStopReasonNone)
+      return false;
+  }
+
+  const lldb::addr_t pc = thread_sp->GetRegisterContext()->GetPC();
+  bool count_hit = false;
+  if (pc == LLDB_INVALID_ADDRESS ||
+      BreakpointHitShouldStop(*thread_sp, pc, count_hit))
+    return false;
+
+  // Step over the breakpoint with the other threads stopped, so none of them
+  // can run past it while it is removed.
+  Status error = DisableBreakpoint(pc);
+  if (error.Fail()) {
+    LLDB_LOG(log, "pid {0} tid {1} failed to disable breakpoint at {2:x}: {3}",
+             GetID(), thread_sp->GetID(), pc, error);
+    return false;
+  }
+
+  m_step_over_breakpoint_tid = thread_sp->GetID();
+  m_step_over_breakpoint_addr = pc;
+  m_pending_notification_tid = LLDB_INVALID_THREAD_ID;
+
+  error = ResumeThread(*thread_sp, eStateStepping, LLDB_INVALID_SIGNAL_NUMBER);
+  if (error.Fail()) {
+    LLDB_LOG(log, "pid {0} tid {1} failed to step over breakpoint: {2}",
+             GetID(), thread_sp->GetID(), error);
+    RestoreSteppedOverBreakpoint();
+    m_pending_notification_tid = thread_sp->GetID();
+    return false;
+  }
+
+  // Only now is the hit really skipped.
+  SkipBreakpointHit(pc, count_hit);
+
+  LLDB_LOG(log, "pid {0} tid {1} stepping over breakpoint at {2:x}", GetID(),
+           thread_sp->GetID(), pc);
+  return true;
+}
+
+Status NativeProcessLinux::RestoreSteppedOverBreakpoint() {
+  const lldb::addr_t addr = m_step_over_breakpoint_addr;
+  m_step_over_breakpoint_tid = LLDB_INVALID_THREAD_ID;
+  m_step_over_breakpoint_addr = LLDB_INVALID_ADDRESS;
+
+  Status error = EnableBreakpoint(addr);
+  if (error.Fail()) {
+    Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+    LLDB_LOG(log, "pid {0} failed to re-enable breakpoint at {1:x}: {2}",
+             GetID(), addr, error);
+  }
+  return error;
+}
+
+void NativeProcessLinux::FinishStepOverBreakpoint() {
+  RestoreSteppedOverBreakpoint();
+  ResumeStoppedThreads();
+}
+
+void NativeProcessLinux::ResumeStoppedThreads() {
+  for (const auto &thread_sp : m_threads) {
+    if (StateIsRunningState(thread_sp->GetState()))
+      continue;
+    ResumeThread(static_cast<NativeThreadLinux &>(*thread_sp), eStateRunning,
+                 LLDB_INVALID_SIGNAL_NUMBER);
+  }
+}
+
 void NativeProcessLinux::ThreadWasCreated(NativeThreadLinux &thread) {
   Log *const log = ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_THREAD);
   LLDB_LOG(log, "tid: {0}", thread.GetID());
@@ -10,7 +10,9 @@
 #ifndef liblldb_NativeProcessLinux_H_
 #define liblldb_NativeProcessLinux_H_
 
+#include <chrono>
 #include <csignal>
+#include <set>
 #include <unordered_set>
 
 // Other libraries and framework includes
@@ -56,6 +58,10 @@ public:
   // ---------------------------------------------------------------------
   Status Resume(const ResumeActionList &resume_actions) override;
 
+  bool SupportsRangeStepping() const override {
+    return SupportHardwareSingleStepping();
+  }
+
   Status Halt() override;
 
   Status Detach() override;
@@ -92,8 +98,16 @@ public:
   Status SetBreakpoint(lldb::addr_t addr, uint32_t size,
                        bool hardware) override;
 
+  void SetBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs, uint32_t size_hint,
+                      bool hardware, std::vector<Status> &errors) override;
+
   Status RemoveBreakpoint(lldb::addr_t addr, bool hardware = false) override;
 
+  Status SetWatchpoint(lldb::addr_t addr, size_t size, uint32_t watch_flags,
+                       bool hardware) override;
+
+  Status RemoveWatchpoint(lldb::addr_t addr) override;
+
   void DoStopIDBumped(uint32_t newBumpId) override;
 
   Status GetLoadedModuleFileSpec(const char *module_path,
@@ -156,6 +170,66 @@ private:
   // the relevan breakpoint
   std::map<lldb::tid_t, lldb::addr_t> m_threads_stepping_with_breakpoint;
 
+  // The thread single stepping past a breakpoint hit the client doesn't need
+  // to see, and the address of that breakpoint.  All the other threads stay
+  // stopped until the step completes.
+  lldb::tid_t m_step_over_breakpoint_tid = LLDB_INVALID_THREAD_ID;
+  lldb::addr_t m_step_over_breakpoint_addr = LLDB_INVALID_ADDRESS;
+
+  // True if the last Resume() continued every thread.  Only then can we
+  // resume the process ourselves after a breakpoint hit the client doesn't
+  // need to see, without losing a step the client asked for.
+  bool m_all_threads_continued = false;
+
+  // Threads stepping through an address range, and the range.  They are
+  // stepped again without telling the client until their pc leaves it.
+  std::map<lldb::tid_t, std::pair<lldb::addr_t, lldb::addr_t>>
+      m_threads_range_stepping;
+
+  // Watchpoints the debug registers couldn't take, implemented by protecting
+  // the pages they cover.  Keyed by watchpoint address.
+  struct SoftwareWatchpoint {
+    lldb::addr_t addr;
+    size_t size;
+    uint32_t watch_flags;
+  };
+  std::map<lldb::addr_t, SoftwareWatchpoint> m_software_watchpoints;
+
+  // The pages currently protected for software watchpoints, with the
+  // protection they had before and the one they have now (PROT_* flags).
+  struct ProtectedPage {
+    uint32_t original_prot;
+    uint32_t prot;
+  };
+  std::map<lldb::addr_t, ProtectedPage> m_protected_pages;
+
+  // A syscall instruction in the vdso, used to run syscalls in the inferior
+  // without writing to its code.
+  lldb::addr_t m_syscall_insn_addr = LLDB_INVALID_ADDRESS;
+
+  // Children inherit the protected pages, so forks are traced while there
+  // are software watchpoints, to give the children the original protections
+  // back before they run.
+  bool m_tracing_forks = false;
+
+  // Forked children whose initial stop the main loop saw before their
+  // parent's fork event.
+  std::set<::pid_t> m_stopped_fork_children;
+
+  // Counters describing what software watchpoints have cost the inferior,
+  // logged when the last one is removed.
+  struct SoftwareWatchpointStats {
+    // Access faults taken on pages protected for watchpoints.
+    uint64_t faults = 0;
+    // Faults that were reported as a watchpoint hit.
+    uint64_t hits = 0;
+    // mprotect calls run in the inferior.
+    uint64_t syscalls = 0;
+    // Time spent in the fault handler, including the injected syscalls.
+    std::chrono::nanoseconds fault_time{0};
+  };
+  SoftwareWatchpointStats m_software_watchpoint_stats;
+
   // ---------------------------------------------------------------------
   // Private Instance Methods
   // ---------------------------------------------------------------------
@@ -166,7 +240,7 @@ private:
   // Returns a list of process threads that we have attached to.
   static llvm::Expected<std::vector<::pid_t>> Attach(::pid_t pid);
 
-  static Status SetDefaultPtraceOpts(const lldb::pid_t);
+  static Status SetDefaultPtraceOpts(const lldb::pid_t, long extra_opts = 0);
 
   void MonitorCallback(lldb::pid_t pid, bool exited, WaitStatus status);
 
@@ -185,6 +259,60 @@ private:
 
   Status SetupSoftwareSingleStepping(NativeThreadLinux &thread);
 
+  // Single step the given stopped thread and wait for the step to complete,
+  // without going through the main loop.  Signals that arrive in the
+  // meantime are sent again once the step is done.  If the instruction
+  // faults, @p fault describes the fault, otherwise its si_signo is 0.
+  Status SingleStepSynchronously(lldb::tid_t tid, siginfo_t &fault);
+
+  // Run the syscall @p sysno with up to three arguments on the given stopped
+  // thread, leaving the thread's registers as they were.
+  // The thread may belong to a forked child that isn't in m_threads.
+  Status InjectSyscall(NativeThreadLinux &thread, uint64_t sysno,
+                       llvm::ArrayRef<uint64_t> args, int64_t &result);
+
+  Status ProtectPages(NativeThreadLinux &thread, lldb::addr_t addr,
+                      size_t size, uint32_t prot);
+
+  // Bring the protection of the pages covering [addr, addr + size) in line
+  // with the software watchpoints that overlap them.
+  Status UpdatePageProtections(NativeThreadLinux &thread, lldb::addr_t addr,
+                               size_t size);
+
+  // Give every page protected for software watchpoints its original
+  // protection back in the address space of @p thread.
+  Status RestoreOriginalProtections(NativeThreadLinux &thread);
+
+  Status SetForkTracing(bool enable);
+
+  // Handle a fork or vfork of @p parent while pages are protected for
+  // software watchpoints: restore the child's protections and let it go.
+  void MonitorFork(NativeThreadLinux &parent, ::pid_t child_pid,
+                   bool is_vfork);
+
+  // Protect the pages again once the vfork child of @p thread is done with
+  // the address space they share.
+  void MonitorVForkDone(NativeThreadLinux &thread);
+
+  // Report the protections pages protected for software watchpoints had
+  // before, splitting @p range_info where they differ.
+  void AdjustForProtectedPages(lldb::addr_t load_addr,
+                               MemoryRegionInfo &range_info) const;
+
+  Status SetSoftwareWatchpoint(lldb::addr_t addr, size_t size,
+                               uint32_t watch_flags);
+
+  Status RemoveSoftwareWatchpoint(lldb::addr_t addr);
+
+  bool IsProtectedForWatchpoints(lldb::addr_t page) const;
+
+  // Handle an access fault on a page protected for software watchpoints by
+  // letting the access complete and reporting a watchpoint hit if it touched
+  // a watched range.  Returns false if the fault has nothing to do with
+  // software watchpoints.
+  bool MonitorSoftwareWatchpointFault(const siginfo_t &info,
+                                      NativeThreadLinux &thread);
+
 #if 0
         static ::ProcessMessage::CrashReason
         GetCrashReasonForSIGSEGV(const siginfo_t *info);
@@ -232,6 +360,21 @@ private:
   // Notify the delegate if all threads have stopped.
   void SignalIfAllThreadsStopped();
 
+  // If the only thing that stopped the process is a breakpoint hit that
+  // doesn't need to be reported (see BreakpointHitShouldStop), step the
+  // thread past the breakpoint and return true instead of notifying the
+  // delegate.
+  bool StepOverSkippedBreakpointHit();
+
+  // Put back the breakpoint disabled by StepOverSkippedBreakpointHit.
+  Status RestoreSteppedOverBreakpoint();
+
+  // Restore the stepped over breakpoint and resume every stopped thread.
+  void FinishStepOverBreakpoint();
+
+  // Resume every thread that isn't running.
+  void ResumeStoppedThreads();
+
   // Resume the given thread, optionally passing it the given signal. The type
   // of resume
   // operation (continue, single-step) depends on the state parameter.
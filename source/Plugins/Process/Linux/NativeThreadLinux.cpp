@@ -387,6 +387,18 @@ void NativeThreadLinux::SetStoppedByWatchpoint(uint32_t wp_index) {
   m_stop_info.details.signal.signo = SIGTRAP;
 }
 
+void NativeThreadLinux::SetStoppedBySoftwareWatchpoint(lldb::addr_t wp_addr,
+                                                       lldb::addr_t hit_addr) {
+  SetStopped();
+
+  std::ostringstream ostr;
+  ostr << wp_addr << " " << LLDB_INVALID_INDEX32 << " " << hit_addr;
+  m_stop_description = ostr.str();
+
+  m_stop_info.reason = StopReason::eStopReasonWatchpoint;
+  m_stop_info.details.signal.signo = SIGTRAP;
+}
+
 bool NativeThreadLinux::IsStoppedAtBreakpoint() {
   return GetState() == StateType::eStateStopped &&
          m_stop_info.reason == StopReason::eStopReasonBreakpoint;
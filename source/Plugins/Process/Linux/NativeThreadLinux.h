@@ -77,6 +77,11 @@ private:
 
   void SetStoppedByWatchpoint(uint32_t wp_index);
 
+  // Stop for a watchpoint implemented with page protection, which has no
+  // debug register index.
+  void SetStoppedBySoftwareWatchpoint(lldb::addr_t wp_addr,
+                                      lldb::addr_t hit_addr);
+
   bool IsStoppedAtBreakpoint();
 
   bool IsStoppedAtWatchpoint();
@@ -703,6 +703,15 @@ Status NativeProcessNetBSD::SetBreakpoint(lldb::addr_t addr, uint32_t size,
     return SetSoftwareBreakpoint(addr, size);
 }
 
+void NativeProcessNetBSD::SetBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs,
+                                        uint32_t size_hint, bool hardware,
+                                        std::vector<Status> &errors) {
+  if (hardware)
+    NativeProcessProtocol::SetBreakpoints(addrs, size_hint, hardware, errors);
+  else
+    SetSoftwareBreakpoints(addrs, size_hint, errors);
+}
+
 Status NativeProcessNetBSD::GetSoftwareBreakpointTrapOpcode(
     size_t trap_opcode_size_hint, size_t &actual_opcode_size,
     const uint8_t *&trap_opcode_bytes) {
@@ -82,6 +82,9 @@ public:
   Status SetBreakpoint(lldb::addr_t addr, uint32_t size,
                        bool hardware) override;
 
+  void SetBreakpoints(llvm::ArrayRef<lldb::addr_t> addrs, uint32_t size_hint,
+                      bool hardware, std::vector<Status> &errors) override;
+
   Status GetLoadedModuleFileSpec(const char *module_path,
                                  FileSpec &file_spec) override;
 
@@ -0,0 +1,241 @@
+//===-- CompressedCoreFile.cpp ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// C Includes
+#include <string.h>
+
+#if defined(HAVE_LIBZ)
+#include <zlib.h>
+#endif
+
+// C++ Includes
+#include <algorithm>
+
+// Other libraries and framework includes
+// Project includes
+#include "lldb/Utility/DataBufferLLVM.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/Log.h"
+
+#include "CompressedCoreFile.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+// Up to 64MiB of decompressed data is cached.
+static const size_t g_max_cached_blocks = 1024;
+
+// Fixed part of a gzip member header, up to and including XLEN.
+static const size_t g_gzip_header_size = 12;
+
+// CRC32 and ISIZE follow the deflate data of each gzip member.
+static const size_t g_gzip_trailer_size = 8;
+
+static const uint8_t g_gzip_id1 = 0x1f;
+static const uint8_t g_gzip_id2 = 0x8b;
+static const uint8_t g_gzip_cm_deflate = 8;
+static const uint8_t g_gzip_flg_fextra = 4;
+
+bool CompressedCoreFile::MagicBytesMatch(const uint8_t *bytes, size_t size) {
+  // A BGZF block is a gzip member whose only optional field is an extra
+  // field, and the first extra subfield is 'BC'.
+  return size >= 18 && bytes[0] == g_gzip_id1 && bytes[1] == g_gzip_id2 &&
+         bytes[2] == g_gzip_cm_deflate && bytes[3] == g_gzip_flg_fextra &&
+         bytes[12] == 'B' && bytes[13] == 'C';
+}
+
+std::unique_ptr<CompressedCoreFile>
+CompressedCoreFile::Open(llvm::StringRef path) {
+#if defined(HAVE_LIBZ)
+  auto data_sp = DataBufferLLVM::CreateFromPath(path);
+  if (!data_sp ||
+      !MagicBytesMatch(data_sp->GetBytes(), data_sp->GetByteSize()))
+    return nullptr;
+
+  std::unique_ptr<CompressedCoreFile> file_up(new CompressedCoreFile(data_sp));
+  if (!file_up->BuildIndex())
+    return nullptr;
+  return file_up;
+#else
+  return nullptr;
+#endif
+}
+
+CompressedCoreFile::CompressedCoreFile(const DataBufferSP &data_sp)
+    : m_data_sp(data_sp) {}
+
+CompressedCoreFile::~CompressedCoreFile() = default;
+
+bool CompressedCoreFile::BuildIndex() {
+  Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_PROCESS));
+
+  DataExtractor data(m_data_sp, eByteOrderLittle, 4);
+  const lldb::offset_t file_size = data.GetByteSize();
+  lldb::offset_t block_offset = 0;
+
+  while (block_offset < file_size) {
+    if (!MagicBytesMatch(data.GetDataStart() + block_offset,
+                         file_size - block_offset)) {
+      if (log)
+        log->Printf("CompressedCoreFile::%s invalid BGZF block at 0x%" PRIx64,
+                    __FUNCTION__, block_offset);
+      return false;
+    }
+
+    lldb::offset_t offset = block_offset + 10;
+    const uint16_t xlen = data.GetU16(&offset);
+    const lldb::offset_t extra_end = offset + xlen;
+
+    // Look for the 'BC' subfield that holds the total size of this block.
+    uint32_t block_size = 0;
+    while (offset + 4 <= extra_end) {
+      const uint8_t si1 = data.GetU8(&offset);
+      const uint8_t si2 = data.GetU8(&offset);
+      const uint16_t slen = data.GetU16(&offset);
+      if (si1 == 'B' && si2 == 'C' && slen == 2) {
+        block_size = data.GetU16(&offset) + 1;
+        break;
+      }
+      offset += slen;
+    }
+
+    const size_t header_size = g_gzip_header_size + xlen;
+    if (block_size < header_size + g_gzip_trailer_size ||
+        !data.ValidOffsetForDataOfSize(block_offset, block_size)) {
+      if (log)
+        log->Printf("CompressedCoreFile::%s truncated BGZF block at 0x%" PRIx64,
+                    __FUNCTION__, block_offset);
+      return false;
+    }
+
+    offset = block_offset + block_size - 4;
+    const uint32_t isize = data.GetU32(&offset);
+
+    // Empty blocks, like the end of file marker, hold no data.
+    if (isize > 0) {
+      Block block;
+      block.compressed_offset = block_offset + header_size;
+      block.compressed_size = block_size - header_size - g_gzip_trailer_size;
+      block.uncompressed_offset = m_uncompressed_size;
+      block.uncompressed_size = isize;
+      m_blocks.push_back(block);
+      m_uncompressed_size += isize;
+    }
+
+    block_offset += block_size;
+  }
+
+  if (log)
+    log->Printf("CompressedCoreFile::%s indexed %" PRIu64
+                " blocks, 0x%" PRIx64 " bytes uncompressed",
+                __FUNCTION__, (uint64_t)m_blocks.size(), m_uncompressed_size);
+
+  return !m_blocks.empty();
+}
+
+size_t CompressedCoreFile::Read(uint64_t offset, void *dst, size_t size) {
+  if (offset >= m_uncompressed_size || size == 0)
+    return 0;
+
+  // Find the block that contains offset.
+  auto pos = std::upper_bound(
+      m_blocks.begin(), m_blocks.end(), offset,
+      [](uint64_t value, const Block &block) {
+        return value < block.uncompressed_offset;
+      });
+  if (pos == m_blocks.begin())
+    return 0;
+  size_t block_idx = std::distance(m_blocks.begin(), pos) - 1;
+
+  uint8_t *buf = static_cast<uint8_t *>(dst);
+  size_t bytes_read = 0;
+  while (bytes_read < size && block_idx < m_blocks.size()) {
+    const Block &block = m_blocks[block_idx];
+    BlockDataSP block_data_sp = GetBlockData(block_idx);
+    if (!block_data_sp)
+      break;
+
+    const uint64_t block_offset =
+        offset + bytes_read - block.uncompressed_offset;
+    const size_t bytes_to_copy = std::min<uint64_t>(
+        size - bytes_read, block_data_sp->size() - block_offset);
+    ::memcpy(buf + bytes_read, block_data_sp->data() + block_offset,
+             bytes_to_copy);
+    bytes_read += bytes_to_copy;
+    ++block_idx;
+  }
+  return bytes_read;
+}
+
+CompressedCoreFile::BlockDataSP
+CompressedCoreFile::GetBlockData(size_t block_idx) {
+  {
+    std::lock_guard<std::mutex> guard(m_cache_mutex);
+    auto pos = m_cache_map.find(block_idx);
+    if (pos != m_cache_map.end()) {
+      m_cache.splice(m_cache.begin(), m_cache, pos->second);
+      return pos->second->second;
+    }
+  }
+
+  // Inflate without holding the lock so that readers on other threads aren't
+  // held up.  If two threads race to inflate the same block the first one to
+  // finish wins.
+  BlockDataSP block_data_sp = InflateBlock(m_blocks[block_idx]);
+  if (!block_data_sp)
+    return nullptr;
+
+  std::lock_guard<std::mutex> guard(m_cache_mutex);
+  auto pos = m_cache_map.find(block_idx);
+  if (pos != m_cache_map.end())
+    return pos->second->second;
+
+  m_cache.emplace_front(block_idx, block_data_sp);
+  m_cache_map[block_idx] = m_cache.begin();
+  if (m_cache.size() > g_max_cached_blocks) {
+    m_cache_map.erase(m_cache.back().first);
+    m_cache.pop_back();
+  }
+  return block_data_sp;
+}
+
+CompressedCoreFile::BlockDataSP
+CompressedCoreFile::InflateBlock(const Block &block) {
+#if defined(HAVE_LIBZ)
+  BlockDataSP block_data_sp =
+      std::make_shared<std::vector<uint8_t>>(block.uncompressed_size);
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  stream.next_in = (Bytef *)(m_data_sp->GetBytes() + block.compressed_offset);
+  stream.avail_in = (uInt)block.compressed_size;
+  stream.next_out = (Bytef *)block_data_sp->data();
+  stream.avail_out = (uInt)block.uncompressed_size;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+
+  // Each block is a raw deflate stream.
+  if (inflateInit2(&stream, -15) != Z_OK)
+    return nullptr;
+  int status = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+  if (status != Z_STREAM_END || stream.total_out != block.uncompressed_size) {
+    Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_PROCESS));
+    if (log)
+      log->Printf("CompressedCoreFile::%s failed to inflate block at "
+                  "0x%" PRIx64,
+                  __FUNCTION__, block.compressed_offset);
+    return nullptr;
+  }
+  return block_data_sp;
+#else
+  return nullptr;
+#endif
+}
@@ -0,0 +1,118 @@
+//===-- CompressedCoreFile.h ------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_CompressedCoreFile_h_
+#define liblldb_CompressedCoreFile_h_
+
+// C Includes
+// C++ Includes
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Other libraries and framework includes
+#include "llvm/ADT/StringRef.h"
+
+// Project includes
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-forward.h"
+#include "lldb/lldb-types.h"
+
+//----------------------------------------------------------------------
+/// @class CompressedCoreFile CompressedCoreFile.h
+/// @brief Random access reads from a block compressed core file.
+///
+/// Core files are usually archived compressed.  Rather than inflating the
+/// whole file before it can be debugged, a core compressed in the BGZF
+/// format (a series of independent gzip members of at most 64KiB each, as
+/// written by "bgzip") is read in place.  The block boundaries are indexed
+/// from the gzip member headers without decompressing anything, and a read
+/// only inflates the blocks it touches.  Recently used blocks are kept in a
+/// small LRU cache.
+///
+/// BGZF files are valid gzip files, so the cores remain usable with the
+/// standard tools.  Plain single member gzip files can't be read at random
+/// offsets and are not supported.
+//----------------------------------------------------------------------
+class CompressedCoreFile {
+public:
+  //------------------------------------------------------------------
+  /// Check if the first bytes of a file look like a BGZF block.
+  //------------------------------------------------------------------
+  static bool MagicBytesMatch(const uint8_t *bytes, size_t size);
+
+  //------------------------------------------------------------------
+  /// Open and index a BGZF compressed file.
+  ///
+  /// @return
+  ///     A reader for the file, or nullptr if the file isn't a valid BGZF
+  ///     file or lldb was built without zlib support.
+  //------------------------------------------------------------------
+  static std::unique_ptr<CompressedCoreFile> Open(llvm::StringRef path);
+
+  ~CompressedCoreFile();
+
+  //------------------------------------------------------------------
+  /// The size of the file once decompressed.
+  //------------------------------------------------------------------
+  uint64_t GetByteSize() const { return m_uncompressed_size; }
+
+  //------------------------------------------------------------------
+  /// Read decompressed bytes from the file.
+  ///
+  /// This is safe to call from multiple threads.
+  ///
+  /// @param[in] offset
+  ///     The offset in the decompressed file to read from.
+  ///
+  /// @param[out] dst
+  ///     The buffer to copy the bytes into.
+  ///
+  /// @param[in] size
+  ///     The number of bytes to read.
+  ///
+  /// @return
+  ///     The number of bytes read, which is less than \a size if the read
+  ///     runs off the end of the file or a block fails to decompress.
+  //------------------------------------------------------------------
+  size_t Read(uint64_t offset, void *dst, size_t size);
+
+private:
+  struct Block {
+    uint64_t compressed_offset;   // File offset of the raw deflate data
+    uint32_t compressed_size;     // Size of the raw deflate data
+    uint64_t uncompressed_offset; // Offset of this block once decompressed
+    uint32_t uncompressed_size;
+  };
+
+  typedef std::shared_ptr<std::vector<uint8_t>> BlockDataSP;
+  typedef std::list<std::pair<size_t, BlockDataSP>> BlockCache;
+
+  CompressedCoreFile(const lldb::DataBufferSP &data_sp);
+
+  bool BuildIndex();
+
+  BlockDataSP GetBlockData(size_t block_idx);
+
+  BlockDataSP InflateBlock(const Block &block);
+
+  lldb::DataBufferSP m_data_sp; // The compressed file
+  std::vector<Block> m_blocks;  // Sorted by uncompressed_offset
+  uint64_t m_uncompressed_size = 0;
+
+  std::mutex m_cache_mutex;
+  BlockCache m_cache; // Most recently used block first
+  std::unordered_map<size_t, BlockCache::iterator> m_cache_map;
+
+  DISALLOW_COPY_AND_ASSIGN(CompressedCoreFile);
+};
+
+#endif // liblldb_CompressedCoreFile_h_
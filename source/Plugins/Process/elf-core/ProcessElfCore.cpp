@@ -7,10 +7,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "lldb/Host/Config.h"
+
 // C Includes
 #include <stdlib.h>
+#ifndef LLDB_DISABLE_POSIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 // C++ Includes
+#include <algorithm>
 #include <mutex>
 
 // Other libraries and framework includes
@@ -28,7 +35,9 @@
 #include "lldb/Utility/Log.h"
 
 #include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "Plugins/DynamicLoader/POSIX-DYLD/DynamicLoaderPOSIXDYLD.h"
 #include "Plugins/ObjectFile/ELF/ObjectFileELF.h"
@@ -52,27 +61,48 @@ void ProcessElfCore::Terminate() {
   PluginManager::UnregisterPlugin(ProcessElfCore::CreateInstance);
 }
 
+// Returns true if data_sp holds the ELF header of a core file.
+static bool IsCoreFileHeader(const lldb::DataBufferSP &data_sp) {
+  // Note: Here we care about e_type field only, so it is safe
+  // to ignore possible presence of the header extension.
+  const size_t header_size = sizeof(llvm::ELF::Elf64_Ehdr);
+  if (data_sp && data_sp->GetByteSize() == header_size &&
+      elf::ELFHeader::MagicBytesMatch(data_sp->GetBytes())) {
+    elf::ELFHeader elf_header;
+    DataExtractor data(data_sp, lldb::eByteOrderLittle, 4);
+    lldb::offset_t data_offset = 0;
+    if (elf_header.Parse(data, &data_offset))
+      return elf_header.e_type == llvm::ELF::ET_CORE;
+  }
+  return false;
+}
+
 lldb::ProcessSP ProcessElfCore::CreateInstance(lldb::TargetSP target_sp,
                                                lldb::ListenerSP listener_sp,
                                                const FileSpec *crash_file) {
   lldb::ProcessSP process_sp;
   if (crash_file) {
     // Read enough data for a ELF32 header or ELF64 header
-    // Note: Here we care about e_type field only, so it is safe
-    // to ignore possible presence of the header extension.
     const size_t header_size = sizeof(llvm::ELF::Elf64_Ehdr);
 
     auto data_sp = DataBufferLLVM::CreateSliceFromPath(crash_file->GetPath(),
                                                        header_size, 0);
-    if (data_sp && data_sp->GetByteSize() == header_size &&
-        elf::ELFHeader::MagicBytesMatch(data_sp->GetBytes())) {
-      elf::ELFHeader elf_header;
-      DataExtractor data(data_sp, lldb::eByteOrderLittle, 4);
-      lldb::offset_t data_offset = 0;
-      if (elf_header.Parse(data, &data_offset)) {
-        if (elf_header.e_type == llvm::ELF::ET_CORE)
-          process_sp.reset(
-              new ProcessElfCore(target_sp, listener_sp, *crash_file));
+    if (IsCoreFileHeader(data_sp)) {
+      process_sp.reset(new ProcessElfCore(target_sp, listener_sp, *crash_file));
+    } else if (data_sp && CompressedCoreFile::MagicBytesMatch(
+                              data_sp->GetBytes(), data_sp->GetByteSize())) {
+      // The core may have been compressed with a seekable block format, in
+      // which case it can be read in place.
+      std::unique_ptr<CompressedCoreFile> compressed_core =
+          CompressedCoreFile::Open(crash_file->GetPath());
+      if (compressed_core) {
+        lldb::DataBufferSP header_sp(new DataBufferHeap(header_size, 0));
+        if (compressed_core->Read(0, header_sp->GetBytes(), header_size) ==
+                header_size &&
+            IsCoreFileHeader(header_sp))
+          process_sp.reset(new ProcessElfCore(target_sp, listener_sp,
+                                              *crash_file,
+                                              std::move(compressed_core)));
       }
     }
   }
@@ -83,9 +113,19 @@ bool ProcessElfCore::CanDebug(lldb::TargetSP target_sp,
                               bool plugin_specified_by_name) {
   // For now we are just making sure the file exists for a given module
   if (!m_core_module_sp && m_core_file.Exists()) {
-    ModuleSpec core_module_spec(m_core_file, target_sp->GetArchitecture());
-    Status error(ModuleList::GetSharedModule(core_module_spec, m_core_module_sp,
-                                             NULL, NULL, NULL));
+    if (m_compressed_core_up) {
+      // Build the module from the headers only; it must not be shared since
+      // the temporary file goes away with this process.
+      if (!ExtractCompressedCoreHeaders())
+        return false;
+      ModuleSpec core_module_spec(m_core_headers_file,
+                                  target_sp->GetArchitecture());
+      m_core_module_sp = std::make_shared<Module>(core_module_spec);
+    } else {
+      ModuleSpec core_module_spec(m_core_file, target_sp->GetArchitecture());
+      Status error(ModuleList::GetSharedModule(
+          core_module_spec, m_core_module_sp, NULL, NULL, NULL));
+    }
     if (m_core_module_sp) {
       ObjectFile *core_objfile = m_core_module_sp->GetObjectFile();
       if (core_objfile && core_objfile->GetType() == ObjectFile::eTypeCoreFile)
@@ -98,19 +138,23 @@ bool ProcessElfCore::CanDebug(lldb::TargetSP target_sp,
 //----------------------------------------------------------------------
 // ProcessElfCore constructor
 //----------------------------------------------------------------------
-ProcessElfCore::ProcessElfCore(lldb::TargetSP target_sp,
-                               lldb::ListenerSP listener_sp,
-                               const FileSpec &core_file)
+ProcessElfCore::ProcessElfCore(
+    lldb::TargetSP target_sp, lldb::ListenerSP listener_sp,
+    const FileSpec &core_file,
+    std::unique_ptr<CompressedCoreFile> compressed_core)
     : Process(target_sp, listener_sp), m_core_module_sp(),
       m_core_file(core_file), m_dyld_plugin_name(),
       m_os(llvm::Triple::UnknownOS), m_thread_data_valid(false),
-      m_thread_data(), m_core_aranges() {}
+      m_thread_data(), m_core_aranges(),
+      m_compressed_core_up(std::move(compressed_core)) {}
 
 //----------------------------------------------------------------------
 // Destructor
 //----------------------------------------------------------------------
 ProcessElfCore::~ProcessElfCore() {
   Clear();
+  if (m_core_headers_file)
+    llvm::sys::fs::remove(m_core_headers_file.GetPath());
   // We need to call finalize on the process before destroying ourselves
   // to make sure all of the broadcaster cleanup goes as planned. If we
   // destruct this class, then Process::~Process() might have problems
@@ -125,6 +169,27 @@ ConstString ProcessElfCore::GetPluginName() { return GetPluginNameStatic(); }
 
 uint32_t ProcessElfCore::GetPluginVersion() { return 1; }
 
+// Reads at least this large are treated as part of a sequential scan and the
+// kernel is asked to start paging the whole range in.
+static const size_t g_sequential_read_hint_size = 128 * 1024;
+
+// Give the kernel an access pattern hint for part of the core file.  The core
+// file is mmapped by its object file and served from that mapping, so only
+// the pages that are actually read become resident.
+static void AdviseCoreFileAccess(const uint8_t *start, size_t size,
+                                 bool sequential) {
+#if !defined(LLDB_DISABLE_POSIX) && defined(MADV_WILLNEED)
+  static const uintptr_t page_size = ::sysconf(_SC_PAGESIZE);
+  if (start == nullptr || size == 0 || page_size == 0)
+    return;
+  const uintptr_t begin =
+      reinterpret_cast<uintptr_t>(start) & ~(page_size - 1);
+  const uintptr_t end = reinterpret_cast<uintptr_t>(start) + size;
+  ::madvise(reinterpret_cast<void *>(begin), end - begin,
+            sequential ? MADV_WILLNEED : MADV_RANDOM);
+#endif
+}
+
 lldb::addr_t ProcessElfCore::AddAddressRangeFromLoadSegment(
     const elf::ELFProgramHeader *header) {
   const lldb::addr_t addr = header->p_vaddr;
@@ -154,6 +219,88 @@ lldb::addr_t ProcessElfCore::AddAddressRangeFromLoadSegment(
   return addr;
 }
 
+bool ProcessElfCore::ExtractCompressedCoreHeaders() {
+  Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_PROCESS));
+
+  // Read the ELF header, and the first section header if the real program
+  // header count is kept there. Section headers usually trail the core, so
+  // don't read that far for anything else.
+  elf::ELFHeader elf_header;
+  uint64_t headers_size = sizeof(llvm::ELF::Elf64_Ehdr);
+  lldb::DataBufferSP data_sp;
+  for (int pass = 0; pass < 2; ++pass) {
+    data_sp.reset(new DataBufferHeap(headers_size, 0));
+    if (m_compressed_core_up->Read(0, data_sp->GetBytes(), headers_size) !=
+        headers_size)
+      return false;
+    DataExtractor data(data_sp, lldb::eByteOrderLittle, 4);
+    lldb::offset_t offset = 0;
+    if (!elf_header.Parse(data, &offset))
+      return false;
+    if (elf_header.e_phnum_hdr != llvm::ELF::PN_XNUM ||
+        elf_header.e_shoff == 0 ||
+        elf_header.e_shoff + elf_header.e_shentsize <= headers_size)
+      break;
+    headers_size = elf_header.e_shoff + elf_header.e_shentsize;
+  }
+
+  // Read the program headers and find the end of the last PT_NOTE segment.
+  // Everything after that is PT_LOAD data that we read on demand.
+  const uint64_t phdrs_end = elf_header.e_phoff + (uint64_t)elf_header.e_phnum *
+                                                      elf_header.e_phentsize;
+  uint64_t prefix_size = std::max(headers_size, phdrs_end);
+  if (prefix_size > m_compressed_core_up->GetByteSize())
+    return false;
+  data_sp.reset(new DataBufferHeap(prefix_size, 0));
+  if (m_compressed_core_up->Read(0, data_sp->GetBytes(), prefix_size) !=
+      prefix_size)
+    return false;
+
+  DataExtractor data(data_sp, elf_header.GetByteOrder(),
+                     elf_header.Is32Bit() ? 4 : 8);
+  for (uint32_t i = 0; i < elf_header.e_phnum; ++i) {
+    lldb::offset_t offset =
+        elf_header.e_phoff + (uint64_t)i * elf_header.e_phentsize;
+    elf::ELFProgramHeader header;
+    if (!header.Parse(data, &offset))
+      return false;
+    if (header.p_type == llvm::ELF::PT_NOTE)
+      prefix_size = std::max(prefix_size, header.p_offset + header.p_filesz);
+  }
+  if (prefix_size > m_compressed_core_up->GetByteSize())
+    return false;
+
+  if (prefix_size > data_sp->GetByteSize()) {
+    data_sp.reset(new DataBufferHeap(prefix_size, 0));
+    if (m_compressed_core_up->Read(0, data_sp->GetBytes(), prefix_size) !=
+        prefix_size)
+      return false;
+  }
+
+  int fd;
+  llvm::SmallString<128> path;
+  if (llvm::sys::fs::createTemporaryFile("lldb-core-headers", "core", fd,
+                                         path))
+    return false;
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose*/ true);
+    os.write(reinterpret_cast<const char *>(data_sp->GetBytes()),
+             data_sp->GetByteSize());
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(path);
+      return false;
+    }
+  }
+  m_core_headers_file.SetFile(path, false);
+
+  if (log)
+    log->Printf("ProcessElfCore::%s extracted 0x%" PRIx64
+                " bytes of headers from a compressed core into %s",
+                __FUNCTION__, prefix_size, path.c_str());
+  return true;
+}
+
 //----------------------------------------------------------------------
 // Process Control
 //----------------------------------------------------------------------
@@ -178,6 +325,14 @@ Status ProcessElfCore::DoLoadCore() {
 
   SetCanJIT(false);
 
+  // Keep a view of the whole core file.  This shares the object file's
+  // mapping of the file, so memory reads are copied straight out of it.
+  core->GetData(0, core->GetByteSize(), m_core_data);
+  // Most reads from a core are small and scattered, so don't let every page
+  // fault read ahead; large reads ask for their pages explicitly.
+  AdviseCoreFileAccess(m_core_data.GetDataStart(), m_core_data.GetByteSize(),
+                       false);
+
   m_thread_data_valid = true;
 
   bool ranges_are_sorted = true;
@@ -349,9 +504,10 @@ Status ProcessElfCore::GetMemoryRegionInfo(lldb::addr_t load_addr,
 
 size_t ProcessElfCore::DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
                                     Status &error) {
-  ObjectFile *core_objfile = m_core_module_sp->GetObjectFile();
+  const uint8_t *core_data = m_core_data.GetDataStart();
+  const lldb::offset_t core_size = m_core_data.GetByteSize();
 
-  if (core_objfile == NULL)
+  if (core_data == NULL && !m_compressed_core_up)
     return 0;
 
   // Get the address range
@@ -363,43 +519,74 @@ size_t ProcessElfCore::DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
     return 0;
   }
 
-  // Convert the address into core file offset
-  const lldb::addr_t offset = addr - address_range->GetRangeBase();
-  const lldb::addr_t file_start = address_range->data.GetRangeBase();
-  const lldb::addr_t file_end = address_range->data.GetRangeEnd();
-  size_t bytes_to_read = size; // Number of bytes to read from the core file
-  size_t bytes_copied = 0;   // Number of bytes actually read from the core file
-  size_t zero_fill_size = 0; // Padding
-  lldb::addr_t bytes_left =
-      0; // Number of bytes available in the core file from the given address
-
-  // Don't proceed if core file doesn't contain the actual data for this address range.
-  if (file_start == file_end)
-    return 0;
+  uint8_t *dst = static_cast<uint8_t *>(buf);
+  size_t bytes_read = 0; // Total number of bytes placed in the buffer
+  lldb::addr_t curr_addr = addr;
+
+  // A read may run off the end of one PT_LOAD segment into the next, so keep
+  // going while the following segment picks up where this one ends.
+  while (address_range) {
+    // Convert the address into core file offset
+    const lldb::addr_t offset = curr_addr - address_range->GetRangeBase();
+    const lldb::addr_t file_start = address_range->data.GetRangeBase();
+    const lldb::addr_t file_end = address_range->data.GetRangeEnd();
+    // Number of bytes to read from the core file for this segment
+    size_t bytes_to_read = std::min<lldb::addr_t>(
+        size - bytes_read, address_range->GetRangeEnd() - curr_addr);
+    size_t bytes_copied = 0;   // Number of bytes actually read from the core
+    size_t zero_fill_size = 0; // Padding
+    lldb::addr_t bytes_left =
+        0; // Number of bytes available in the core file from the given address
+
+    // Don't proceed if core file doesn't contain the actual data for this
+    // address range.
+    if (file_start == file_end)
+      break;
+
+    // Figure out how many on-disk bytes remain in this segment
+    // starting at the given offset
+    if (file_end > file_start + offset)
+      bytes_left = file_end - (file_start + offset);
+
+    // Figure out how many bytes we need to zero-fill if we are
+    // reading more bytes than available in the on-disk segment
+    if (bytes_to_read > bytes_left) {
+      zero_fill_size = bytes_to_read - bytes_left;
+      bytes_to_read = bytes_left;
+    }
 
-  // Figure out how many on-disk bytes remain in this segment
-  // starting at the given offset
-  if (file_end > file_start + offset)
-    bytes_left = file_end - (file_start + offset);
+    // If there is data available on the core file copy it out of the mapping
+    const lldb::addr_t file_offset = file_start + offset;
+    if (bytes_to_read && m_compressed_core_up) {
+      bytes_copied = m_compressed_core_up->Read(file_offset, dst + bytes_read,
+                                                bytes_to_read);
+    } else if (bytes_to_read && file_offset < core_size) {
+      bytes_copied = std::min<lldb::addr_t>(bytes_to_read,
+                                            core_size - file_offset);
+      if (bytes_copied >= g_sequential_read_hint_size)
+        AdviseCoreFileAccess(core_data + file_offset, bytes_copied, true);
+      ::memcpy(dst + bytes_read, core_data + file_offset, bytes_copied);
+    }
+    bytes_read += bytes_copied;
 
-  // Figure out how many bytes we need to zero-fill if we are
-  // reading more bytes than available in the on-disk segment
-  if (bytes_to_read > bytes_left) {
-    zero_fill_size = bytes_to_read - bytes_left;
-    bytes_to_read = bytes_left;
-  }
+    // The core file was truncated, don't make up the missing bytes.
+    if (bytes_copied < bytes_to_read)
+      break;
 
-  // If there is data available on the core file read it
-  if (bytes_to_read)
-    bytes_copied =
-        core_objfile->CopyData(offset + file_start, bytes_to_read, buf);
+    // Pad remaining bytes
+    if (zero_fill_size)
+      memset(dst + bytes_read, 0, zero_fill_size);
+    bytes_read += zero_fill_size;
 
-  assert(zero_fill_size <= size);
-  // Pad remaining bytes
-  if (zero_fill_size)
-    memset(((char *)buf) + bytes_copied, 0, zero_fill_size);
+    assert(bytes_read <= size);
+    if (bytes_read == size)
+      break;
+
+    curr_addr = addr + bytes_read;
+    address_range = m_core_aranges.FindEntryThatContains(curr_addr);
+  }
 
-  return bytes_copied + zero_fill_size;
+  return bytes_read;
 }
 
 void ProcessElfCore::Clear() {
@@ -30,6 +30,8 @@
 
 #include "Plugins/ObjectFile/ELF/ELFHeader.h"
 
+#include "CompressedCoreFile.h"
+
 struct ThreadData;
 
 class ProcessElfCore : public lldb_private::Process {
@@ -53,7 +55,8 @@ public:
   // Constructors and Destructors
   //------------------------------------------------------------------
   ProcessElfCore(lldb::TargetSP target_sp, lldb::ListenerSP listener_sp,
-                 const lldb_private::FileSpec &core_file);
+                 const lldb_private::FileSpec &core_file,
+                 std::unique_ptr<CompressedCoreFile> compressed_core = {});
 
   ~ProcessElfCore() override;
 
@@ -150,6 +153,17 @@ private:
   // AUXV structure found from the NOTE segment
   lldb_private::DataExtractor m_auxv;
 
+  // The whole core file, sharing the core object file's mapping of it
+  lldb_private::DataExtractor m_core_data;
+
+  // Reader for a compressed core file.  When set, m_core_module_sp is built
+  // from a temporary file holding only the ELF headers and notes, and memory
+  // is read from the compressed file.
+  std::unique_ptr<CompressedCoreFile> m_compressed_core_up;
+
+  // The temporary headers file for a compressed core
+  lldb_private::FileSpec m_core_headers_file;
+
   // Address ranges found in the core
   VMRangeToFileOffset m_core_aranges;
 
@@ -167,6 +181,10 @@ private:
   // Returns number of thread contexts stored in the core file
   uint32_t GetNumThreadContexts();
 
+  // Write the ELF headers and notes of a compressed core to a temporary file
+  // that the core module can be created from.
+  bool ExtractCompressedCoreHeaders();
+
   // Parse a contiguous address range of the process from LOAD segment
   lldb::addr_t
   AddAddressRangeFromLoadSegment(const elf::ELFProgramHeader *header);
@@ -63,6 +63,7 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient()
       m_supports_vCont_C(eLazyBoolCalculate),
       m_supports_vCont_s(eLazyBoolCalculate),
       m_supports_vCont_S(eLazyBoolCalculate),
+      m_supports_vCont_r(eLazyBoolCalculate),
       m_qHostInfo_is_valid(eLazyBoolCalculate),
       m_curr_pid_is_valid(eLazyBoolCalculate),
       m_qProcessInfo_is_valid(eLazyBoolCalculate),
@@ -82,6 +83,9 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient()
       m_supports_qXfer_libraries_svr4_read(eLazyBoolCalculate),
       m_supports_qXfer_features_read(eLazyBoolCalculate),
       m_supports_augmented_libraries_svr4_read(eLazyBoolCalculate),
+      m_supports_conditional_breakpoints(eLazyBoolCalculate),
+      m_supports_breakpoint_hit_counts(eLazyBoolCalculate),
+      m_supports_multi_breakpoints(eLazyBoolCalculate),
       m_supports_jThreadExtendedInfo(eLazyBoolCalculate),
       m_supports_jLoadedDynamicLibrariesInfos(eLazyBoolCalculate),
       m_supports_jGetSharedCacheInfo(eLazyBoolCalculate),
@@ -185,6 +189,27 @@ bool GDBRemoteCommunicationClient::GetQXferAuxvReadSupported() {
   return m_supports_qXfer_auxv_read == eLazyBoolYes;
 }
 
+bool GDBRemoteCommunicationClient::GetConditionalBreakpointsSupported() {
+  if (m_supports_conditional_breakpoints == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_conditional_breakpoints == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetBreakpointHitCountsSupported() {
+  if (m_supports_breakpoint_hit_counts == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_breakpoint_hit_counts == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetMultiBreakpointsSupported() {
+  if (m_supports_multi_breakpoints == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_multi_breakpoints == eLazyBoolYes;
+}
+
 bool GDBRemoteCommunicationClient::GetQXferFeaturesReadSupported() {
   if (m_supports_qXfer_features_read == eLazyBoolCalculate) {
     GetRemoteQSupported();
@@ -281,6 +306,7 @@ void GDBRemoteCommunicationClient::ResetDiscoverableSettings(bool did_exec) {
     m_supports_vCont_C = eLazyBoolCalculate;
     m_supports_vCont_s = eLazyBoolCalculate;
     m_supports_vCont_S = eLazyBoolCalculate;
+    m_supports_vCont_r = eLazyBoolCalculate;
     m_supports_p = eLazyBoolCalculate;
     m_supports_x = eLazyBoolCalculate;
     m_supports_QSaveRegisterState = eLazyBoolCalculate;
@@ -297,6 +323,9 @@ void GDBRemoteCommunicationClient::ResetDiscoverableSettings(bool did_exec) {
     m_supports_qXfer_libraries_svr4_read = eLazyBoolCalculate;
     m_supports_qXfer_features_read = eLazyBoolCalculate;
     m_supports_augmented_libraries_svr4_read = eLazyBoolCalculate;
+    m_supports_conditional_breakpoints = eLazyBoolCalculate;
+    m_supports_breakpoint_hit_counts = eLazyBoolCalculate;
+    m_supports_multi_breakpoints = eLazyBoolCalculate;
     m_supports_qProcessInfoPID = true;
     m_supports_qfProcessInfo = true;
     m_supports_qUserName = true;
@@ -342,6 +371,9 @@ void GDBRemoteCommunicationClient::GetRemoteQSupported() {
   m_supports_qXfer_libraries_svr4_read = eLazyBoolNo;
   m_supports_augmented_libraries_svr4_read = eLazyBoolNo;
   m_supports_qXfer_features_read = eLazyBoolNo;
+  m_supports_conditional_breakpoints = eLazyBoolNo;
+  m_supports_breakpoint_hit_counts = eLazyBoolNo;
+  m_supports_multi_breakpoints = eLazyBoolNo;
   m_max_packet_size = UINT64_MAX; // It's supposed to always be there, but if
                                   // not, we assume no limit
 
@@ -377,6 +409,12 @@ void GDBRemoteCommunicationClient::GetRemoteQSupported() {
       m_supports_qXfer_libraries_read = eLazyBoolYes;
     if (::strstr(response_cstr, "qXfer:features:read+"))
       m_supports_qXfer_features_read = eLazyBoolYes;
+    if (::strstr(response_cstr, "ConditionalBreakpoints+"))
+      m_supports_conditional_breakpoints = eLazyBoolYes;
+    if (::strstr(response_cstr, "BreakpointHitCounts+"))
+      m_supports_breakpoint_hit_counts = eLazyBoolYes;
+    if (::strstr(response_cstr, "MultiBreakpoints+"))
+      m_supports_multi_breakpoints = eLazyBoolYes;
 
     // Look for a list of compressions in the features list e.g.
     // qXfer:features:read+;PacketSize=20000;qEcho+;SupportedCompressions=zlib-deflate,lzma
@@ -469,6 +507,7 @@ bool GDBRemoteCommunicationClient::GetVContSupported(char flavor) {
     m_supports_vCont_C = eLazyBoolNo;
     m_supports_vCont_s = eLazyBoolNo;
     m_supports_vCont_S = eLazyBoolNo;
+    m_supports_vCont_r = eLazyBoolNo;
     if (SendPacketAndWaitForResponse("vCont?", response, false) ==
         PacketResult::Success) {
       const char *response_cstr = response.GetStringRef().c_str();
@@ -484,6 +523,9 @@ bool GDBRemoteCommunicationClient::GetVContSupported(char flavor) {
       if (::strstr(response_cstr, ";S"))
         m_supports_vCont_S = eLazyBoolYes;
 
+      if (::strstr(response_cstr, ";r"))
+        m_supports_vCont_r = eLazyBoolYes;
+
       if (m_supports_vCont_c == eLazyBoolYes &&
           m_supports_vCont_C == eLazyBoolYes &&
           m_supports_vCont_s == eLazyBoolYes &&
@@ -513,6 +555,8 @@ bool GDBRemoteCommunicationClient::GetVContSupported(char flavor) {
     return m_supports_vCont_s;
   case 'S':
     return m_supports_vCont_S;
+  case 'r':
+    return m_supports_vCont_r;
   default:
     break;
   }
@@ -2526,7 +2570,8 @@ bool GDBRemoteCommunicationClient::GetThreadStopInfo(
 }
 
 uint8_t GDBRemoteCommunicationClient::SendGDBStoppointTypePacket(
-    GDBStoppointType type, bool insert, addr_t addr, uint32_t length) {
+    GDBStoppointType type, bool insert, addr_t addr, uint32_t length,
+    const GDBStoppointStopOptions &options) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
   if (log)
     log->Printf("GDBRemoteCommunicationClient::%s() %s at addr = 0x%" PRIx64,
@@ -2536,19 +2581,24 @@ uint8_t GDBRemoteCommunicationClient::SendGDBStoppointTypePacket(
   if (!SupportsGDBStoppointPacket(type))
     return UINT8_MAX;
   // Construct the breakpoint packet
-  char packet[64];
-  const int packet_len =
-      ::snprintf(packet, sizeof(packet), "%c%i,%" PRIx64 ",%x",
-                 insert ? 'Z' : 'z', type, addr, length);
-  // Check we haven't overwritten the end of the packet buffer
-  assert(packet_len + 1 < (int)sizeof(packet));
-  UNUSED_IF_ASSERT_DISABLED(packet_len);
+  StreamString packet;
+  packet.Printf("%c%i,%" PRIx64 ",%x", insert ? 'Z' : 'z', type, addr, length);
+  // Append the conditions as a "cond_list" of agent expressions
+  for (const AgentExpression &condition : options.conditions) {
+    packet.Printf(";X%" PRIx64 ",", (uint64_t)condition.GetSize());
+    packet.PutBytesAsRawHex8(condition.GetBytes().data(),
+                             condition.GetSize());
+  }
+  if (options.ignore_count != 0)
+    packet.Printf(";ignore:%" PRIx32, options.ignore_count);
+  if (options.auto_continue)
+    packet.PutCString(";auto-continue");
   StringExtractorGDBRemote response;
   // Make sure the response is either "OK", "EXX" where XX are two hex digits,
   // or "" (unsupported)
   response.SetResponseValidatorToOKErrorNotSupported();
   // Try to send the breakpoint packet, and check that it was correctly sent
-  if (SendPacketAndWaitForResponse(packet, response, true) ==
+  if (SendPacketAndWaitForResponse(packet.GetString(), response, true) ==
       PacketResult::Success) {
     // Receive and OK packet when the breakpoint successfully placed
     if (response.IsOKResponse())
@@ -2586,6 +2636,136 @@ uint8_t GDBRemoteCommunicationClient::SendGDBStoppointTypePacket(
   return UINT8_MAX;
 }
 
+void GDBRemoteCommunicationClient::SendSoftwareBreakpointPackets(
+    bool insert, llvm::ArrayRef<addr_t> addrs, uint32_t length,
+    std::vector<uint8_t> &error_nos) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+  if (log)
+    log->Printf("GDBRemoteCommunicationClient::%s() %s %zu breakpoints",
+                __FUNCTION__, insert ? "add" : "remove", addrs.size());
+
+  error_nos.assign(addrs.size(), UINT8_MAX);
+  size_t num_done = 0;
+
+  if (GetMultiBreakpointsSupported()) {
+    // Put as many addresses in each packet as the stub can take.
+    const uint64_t max_packet_size =
+        std::min<uint64_t>(GetRemoteMaxPacketSize(), 0x4000);
+    while (num_done < addrs.size()) {
+      StreamString packet;
+      packet.Printf("%s%i,%x:", insert ? "_Z" : "_z", eBreakpointSoftware,
+                    length);
+      size_t end = num_done;
+      do {
+        packet.Printf("%s%" PRIx64, end == num_done ? "" : ";", addrs[end]);
+        ++end;
+      } while (end < addrs.size() && packet.GetSize() + 32 < max_packet_size);
+
+      StringExtractorGDBRemote response;
+      if (SendPacketAndWaitForResponse(packet.GetString(), response, true) !=
+          PacketResult::Success)
+        return;
+      if (response.IsUnsupportedResponse()) {
+        m_supports_multi_breakpoints = eLazyBoolNo;
+        break;
+      }
+      // There is an "OK" or "EXX" for each address.
+      llvm::SmallVector<llvm::StringRef, 64> results;
+      response.GetStringRef().split(results, ';');
+      if (results.size() != end - num_done)
+        return;
+      for (llvm::StringRef result : results) {
+        uint8_t error_no = UINT8_MAX;
+        if (result == "OK")
+          error_no = 0;
+        else if (result.consume_front("E"))
+          result.getAsInteger(16, error_no);
+        error_nos[num_done++] = error_no;
+      }
+    }
+  }
+
+  if (num_done == addrs.size() ||
+      !SupportsGDBStoppointPacket(eBreakpointSoftware))
+    return;
+
+  // With acks on every packet has to wait for its reply anyway.
+  if (GetSendAcks()) {
+    for (; num_done < addrs.size(); ++num_done)
+      error_nos[num_done] = SendGDBStoppointTypePacket(
+          eBreakpointSoftware, insert, addrs[num_done], length);
+    return;
+  }
+
+  // Otherwise keep a window of packets in flight so the round trips overlap,
+  // without letting the replies back up far enough to block the stub.
+  Lock lock(*this, true);
+  if (!lock)
+    return;
+  const size_t max_in_flight = 64;
+  size_t num_sent = num_done;
+  while (num_done < addrs.size()) {
+    while (num_sent < addrs.size() && num_sent - num_done < max_in_flight) {
+      StreamString packet;
+      packet.Printf("%c%i,%" PRIx64 ",%x", insert ? 'Z' : 'z',
+                    eBreakpointSoftware, addrs[num_sent], length);
+      if (SendPacketNoLock(packet.GetString()) != PacketResult::Success)
+        break;
+      ++num_sent;
+    }
+    if (num_sent == num_done)
+      return;
+
+    StringExtractorGDBRemote response;
+    response.SetResponseValidatorToOKErrorNotSupported();
+    if (ReadPacket(response, GetPacketTimeout(), true) !=
+        PacketResult::Success) {
+      // The replies still in flight would be taken for the replies to
+      // whatever we send next, so the connection can't be used any more.
+      if (log)
+        log->Printf("GDBRemoteCommunicationClient::%s() lost the reply to "
+                    "breakpoint %zu of %zu, disconnecting",
+                    __FUNCTION__, num_done, addrs.size());
+      Disconnect();
+      return;
+    }
+    uint8_t error_no = UINT8_MAX;
+    if (response.IsOKResponse())
+      error_no = 0;
+    else if (response.IsErrorResponse())
+      error_no = response.GetError();
+    else if (response.IsUnsupportedResponse())
+      m_supports_z0 = false;
+    error_nos[num_done++] = error_no;
+  }
+}
+
+bool GDBRemoteCommunicationClient::GetBreakpointHitCount(
+    addr_t addr, uint64_t &skipped_hits, uint32_t &ignore_count) {
+  if (!GetBreakpointHitCountsSupported())
+    return false;
+
+  StreamString packet;
+  packet.Printf("qBreakpointHitCount:%" PRIx64, addr);
+  StringExtractorGDBRemote response;
+  if (SendPacketAndWaitForResponse(packet.GetString(), response, false) !=
+          PacketResult::Success ||
+      !response.IsNormalResponse())
+    return false;
+
+  bool got_hits = false;
+  bool got_ignore = false;
+  llvm::StringRef name;
+  llvm::StringRef value;
+  while (response.GetNameColonValue(name, value)) {
+    if (name == "hits")
+      got_hits = !value.getAsInteger(16, skipped_hits);
+    else if (name == "ignore")
+      got_ignore = !value.getAsInteger(16, ignore_count);
+  }
+  return got_hits && got_ignore;
+}
+
 size_t GDBRemoteCommunicationClient::GetCurrentThreadIDs(
     std::vector<lldb::tid_t> &thread_ids, bool &sequence_mutex_unavailable) {
   thread_ids.clear();
@@ -24,6 +24,7 @@
 // Project includes
 #include "lldb/Core/ArchSpec.h"
 #include "lldb/Target/Process.h"
+#include "lldb/Utility/AgentExpression.h"
 #include "lldb/Utility/StreamGDBRemote.h"
 #include "lldb/Utility/StructuredData.h"
 
@@ -32,6 +33,26 @@
 namespace lldb_private {
 namespace process_gdb_remote {
 
+// What a stub can decide about a software breakpoint hit by itself, see
+// GetConditionalBreakpointsSupported() and GetBreakpointHitCountsSupported().
+struct GDBStoppointStopOptions {
+  // Only stop if one of these evaluates to non-zero.
+  std::vector<AgentExpression> conditions;
+  // Skip this many hits first.
+  uint32_t ignore_count = 0;
+  // Only count the hits, never stop.
+  bool auto_continue = false;
+
+  bool operator==(const GDBStoppointStopOptions &rhs) const {
+    return conditions == rhs.conditions && ignore_count == rhs.ignore_count &&
+           auto_continue == rhs.auto_continue;
+  }
+
+  bool operator!=(const GDBStoppointStopOptions &rhs) const {
+    return !(*this == rhs);
+  }
+};
+
 class GDBRemoteCommunicationClient : public GDBRemoteClientBase {
 public:
   GDBRemoteCommunicationClient();
@@ -319,7 +340,39 @@ public:
       GDBStoppointType type, // Type of breakpoint or watchpoint
       bool insert,           // Insert or remove?
       lldb::addr_t addr,     // Address of breakpoint or watchpoint
-      uint32_t length);      // Byte Size of breakpoint or watchpoint
+      uint32_t length,       // Byte Size of breakpoint or watchpoint
+      // What the stub decides by itself, for software breakpoints only
+      const GDBStoppointStopOptions &options = GDBStoppointStopOptions());
+
+  //------------------------------------------------------------------
+  /// Insert or remove software breakpoints without stop options at all of
+  /// \a addrs, as SendGDBStoppointTypePacket would one at a time.
+  ///
+  /// They go out in "_Z0" or "_z0" packets that hold many breakpoints each
+  /// if the stub supports them, and otherwise as "Z0" or "z0" packets sent
+  /// without waiting for each reply when acks are off.
+  ///
+  /// @param[out] error_nos
+  ///     What SendGDBStoppointTypePacket would have returned for the
+  ///     matching address.  UINT8_MAX when the reply was missing or
+  ///     malformed, in which case the stub may or may not have acted on
+  ///     the request and it must not be sent again.
+  //------------------------------------------------------------------
+  void SendSoftwareBreakpointPackets(bool insert,
+                                     llvm::ArrayRef<lldb::addr_t> addrs,
+                                     uint32_t length,
+                                     std::vector<uint8_t> &error_nos);
+
+  //------------------------------------------------------------------
+  /// Get the hits of the software breakpoint at \a addr the stub didn't
+  /// report but that count as hits, and its remaining ignore count.
+  ///
+  /// @return
+  ///     False if the stub doesn't support "qBreakpointHitCount" or has
+  ///     no breakpoint at \a addr.
+  //------------------------------------------------------------------
+  bool GetBreakpointHitCount(lldb::addr_t addr, uint64_t &skipped_hits,
+                             uint32_t &ignore_count);
 
   bool SetNonStopMode(const bool enable);
 
@@ -340,6 +393,12 @@ public:
 
   bool GetQXferAuxvReadSupported();
 
+  bool GetConditionalBreakpointsSupported();
+
+  bool GetBreakpointHitCountsSupported();
+
+  bool GetMultiBreakpointsSupported();
+
   void EnableErrorStringInPacket();
 
   bool GetQXferLibrariesReadSupported();
@@ -527,6 +586,7 @@ protected:
   LazyBool m_supports_vCont_C;
   LazyBool m_supports_vCont_s;
   LazyBool m_supports_vCont_S;
+  LazyBool m_supports_vCont_r;
   LazyBool m_qHostInfo_is_valid;
   LazyBool m_curr_pid_is_valid;
   LazyBool m_qProcessInfo_is_valid;
@@ -547,6 +607,9 @@ protected:
   LazyBool m_supports_qXfer_libraries_svr4_read;
   LazyBool m_supports_qXfer_features_read;
   LazyBool m_supports_augmented_libraries_svr4_read;
+  LazyBool m_supports_conditional_breakpoints;
+  LazyBool m_supports_breakpoint_hit_counts;
+  LazyBool m_supports_multi_breakpoints;
   LazyBool m_supports_jThreadExtendedInfo;
   LazyBool m_supports_jLoadedDynamicLibrariesInfos;
   LazyBool m_supports_jGetSharedCacheInfo;
@@ -841,6 +841,11 @@ GDBRemoteCommunicationServerCommon::Handle_qSupported(
 #if defined(__linux__) || defined(__NetBSD__)
   response.PutCString(";QPassSignals+");
   response.PutCString(";qXfer:auxv:read+");
+  response.PutCString(";MultiBreakpoints+");
+#endif
+#if defined(__linux__)
+  response.PutCString(";ConditionalBreakpoints+");
+  response.PutCString(";BreakpointHitCounts+");
 #endif
 
   return SendPacketNoLock(response.GetString());
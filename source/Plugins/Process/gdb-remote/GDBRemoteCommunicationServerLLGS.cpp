@@ -36,6 +36,7 @@
 #include "lldb/Interpreter/Args.h"
 #include "lldb/Target/FileAction.h"
 #include "lldb/Target/MemoryRegionInfo.h"
+#include "lldb/Utility/AgentExpression.h"
 #include "lldb/Utility/DataBuffer.h"
 #include "lldb/Utility/Endian.h"
 #include "lldb/Utility/JSON.h"
@@ -152,6 +153,9 @@ void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_qWatchpointSupportInfo,
       &GDBRemoteCommunicationServerLLGS::Handle_qWatchpointSupportInfo);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_qBreakpointHitCount,
+      &GDBRemoteCommunicationServerLLGS::Handle_qBreakpointHitCount);
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_qXfer_auxv_read,
       &GDBRemoteCommunicationServerLLGS::Handle_qXfer_auxv_read);
@@ -176,6 +180,10 @@ void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
                                 &GDBRemoteCommunicationServerLLGS::Handle_Z);
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_z,
                                 &GDBRemoteCommunicationServerLLGS::Handle_z);
+  RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType__Z,
+                                &GDBRemoteCommunicationServerLLGS::Handle__Z);
+  RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType__z,
+                                &GDBRemoteCommunicationServerLLGS::Handle__z);
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_QPassSignals,
       &GDBRemoteCommunicationServerLLGS::Handle_QPassSignals);
@@ -1508,6 +1516,8 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont_actions(
     StringExtractorGDBRemote &packet) {
   StreamString response;
   response.Printf("vCont;c;C;s;S");
+  if (m_debugged_process_up && m_debugged_process_up->SupportsRangeStepping())
+    response.PutCString(";r");
 
   return SendPacketNoLock(response.GetString());
 }
@@ -1558,6 +1568,8 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont(
     thread_action.tid = LLDB_INVALID_THREAD_ID;
     thread_action.state = eStateInvalid;
     thread_action.signal = 0;
+    thread_action.range_start = LLDB_INVALID_ADDRESS;
+    thread_action.range_end = LLDB_INVALID_ADDRESS;
 
     const char action = packet.GetChar();
     switch (action) {
@@ -1585,6 +1597,22 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont(
       thread_action.state = eStateStepping;
       break;
 
+    case 'r':
+      // Step while the pc stays in [start, end).
+      thread_action.range_start =
+          packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+      if (packet.GetChar() != ',')
+        return SendIllFormedResponse(
+            packet, "Malformed range in vCont packet r action");
+      thread_action.range_end =
+          packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+      if (thread_action.range_start == LLDB_INVALID_ADDRESS ||
+          thread_action.range_end == LLDB_INVALID_ADDRESS)
+        return SendIllFormedResponse(
+            packet, "Could not parse range in vCont packet r action");
+      thread_action.state = eStateStepping;
+      break;
+
     default:
       return SendIllFormedResponse(packet, "Unsupported vCont action");
       break;
@@ -2605,9 +2633,47 @@ GDBRemoteCommunicationServerLLGS::Handle_Z(StringExtractorGDBRemote &packet) {
         packet, "Malformed Z packet, failed to parse size argument");
 
   if (want_breakpoint) {
+    // Parse out the optional condition list, each condition is an agent
+    // expression of the form "X<len>,<bytes>", followed by our own
+    // "ignore:<count>" and "auto-continue" options.
+    std::vector<AgentExpression> conditions;
+    uint32_t ignore_count = 0;
+    bool auto_continue = false;
+    while (packet.GetBytesLeft() && packet.PeekChar() == ';') {
+      packet.GetChar();
+      llvm::StringRef option = packet.Peek();
+      if (option.startswith("ignore:")) {
+        packet.SetFilePos(packet.GetFilePos() + strlen("ignore:"));
+        ignore_count = packet.GetHexMaxU32(false, 0);
+        continue;
+      }
+      if (option.startswith("auto-continue")) {
+        packet.SetFilePos(packet.GetFilePos() + strlen("auto-continue"));
+        auto_continue = true;
+        continue;
+      }
+      if (packet.PeekChar() != 'X')
+        break; // Ignore the command list, we don't support it.
+      packet.GetChar();
+      const uint32_t expr_len = packet.GetHexMaxU32(false, 0);
+      if (expr_len == 0 || packet.GetChar() != ',')
+        return SendIllFormedResponse(packet,
+                                     "Malformed Z packet condition list");
+      std::vector<uint8_t> expr_bytes(expr_len);
+      if (packet.GetHexBytes(expr_bytes, 0) != expr_len)
+        return SendIllFormedResponse(packet, "Truncated Z packet condition");
+      AgentExpression condition(expr_bytes);
+      if (condition.Validate().Fail())
+        return SendIllFormedResponse(packet, "Invalid Z packet condition");
+      conditions.push_back(std::move(condition));
+    }
+
     // Try to set the breakpoint.
-    const Status error =
+    Status error =
         m_debugged_process_up->SetBreakpoint(addr, size, want_hardware);
+    if (error.Success() && !want_hardware)
+      error = m_debugged_process_up->SetBreakpointStopOptions(
+          addr, std::move(conditions), ignore_count, auto_continue);
     if (error.Success())
       return SendOKResponse();
     Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
@@ -2714,6 +2780,103 @@ GDBRemoteCommunicationServerLLGS::Handle_z(StringExtractorGDBRemote &packet) {
   }
 }
 
+// Parse the "0,<kind>:<addr>;<addr>..." list of software breakpoints that
+// follows "_Z" or "_z".
+static bool ParseBreakpointList(StringExtractorGDBRemote &packet,
+                                std::vector<lldb::addr_t> &addrs,
+                                uint32_t &size_hint) {
+  packet.SetFilePos(strlen("_Z"));
+  if (packet.GetS32(eStoppointInvalid) != eBreakpointSoftware ||
+      packet.GetChar() != ',')
+    return false;
+  size_hint = packet.GetHexMaxU32(false, std::numeric_limits<uint32_t>::max());
+  if (size_hint == std::numeric_limits<uint32_t>::max() ||
+      packet.GetChar() != ':')
+    return false;
+  while (packet.GetBytesLeft()) {
+    if (!addrs.empty() && packet.GetChar() != ';')
+      return false;
+    const lldb::addr_t addr = packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+    if (addr == LLDB_INVALID_ADDRESS)
+      return false;
+    addrs.push_back(addr);
+  }
+  return !addrs.empty();
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle__Z(StringExtractorGDBRemote &packet) {
+  // Ensure we have a process.
+  if (!m_debugged_process_up ||
+      (m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)) {
+    Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+    LLDB_LOG(log, "failed, no process available");
+    return SendErrorResponse(0x15);
+  }
+
+  std::vector<lldb::addr_t> addrs;
+  uint32_t size_hint = 0;
+  if (!ParseBreakpointList(packet, addrs, size_hint))
+    return SendIllFormedResponse(packet, "Malformed _Z packet");
+
+  // Set all the breakpoints at once so the ones that share a page are
+  // written together, then reply with a result for each of them.
+  std::vector<Status> errors;
+  m_debugged_process_up->SetBreakpoints(addrs, size_hint, false, errors);
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+  StreamString response;
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    // Like Z0, a breakpoint set without options doesn't skip any hits.
+    Status error = errors[i];
+    if (error.Success())
+      error = m_debugged_process_up->SetBreakpointStopOptions(addrs[i], {}, 0,
+                                                              false);
+    if (i != 0)
+      response.PutChar(';');
+    if (error.Success()) {
+      response.PutCString("OK");
+    } else {
+      LLDB_LOG(log, "pid {0} failed to set breakpoint at {1:x}: {2}",
+               m_debugged_process_up->GetID(), addrs[i], error);
+      response.PutCString("E09");
+    }
+  }
+  return SendPacketNoLock(response.GetString());
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle__z(StringExtractorGDBRemote &packet) {
+  // Ensure we have a process.
+  if (!m_debugged_process_up ||
+      (m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)) {
+    Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+    LLDB_LOG(log, "failed, no process available");
+    return SendErrorResponse(0x15);
+  }
+
+  std::vector<lldb::addr_t> addrs;
+  uint32_t size_hint = 0;
+  if (!ParseBreakpointList(packet, addrs, size_hint))
+    return SendIllFormedResponse(packet, "Malformed _z packet");
+
+  std::vector<Status> errors;
+  m_debugged_process_up->RemoveBreakpoints(addrs, false, errors);
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+  StreamString response;
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    if (i != 0)
+      response.PutChar(';');
+    if (errors[i].Success()) {
+      response.PutCString("OK");
+    } else {
+      LLDB_LOG(log, "pid {0} failed to remove breakpoint at {1:x}: {2}",
+               m_debugged_process_up->GetID(), addrs[i], errors[i]);
+      response.PutCString("E09");
+    }
+  }
+  return SendPacketNoLock(response.GetString());
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_s(StringExtractorGDBRemote &packet) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
@@ -3131,6 +3294,33 @@ GDBRemoteCommunicationServerLLGS::Handle_qWatchpointSupportInfo(
   return SendPacketNoLock(response.GetString());
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_qBreakpointHitCount(
+    StringExtractorGDBRemote &packet) {
+  // Fail if we don't have a current process.
+  if (!m_debugged_process_up ||
+      m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)
+    return SendErrorResponse(0x15);
+
+  packet.SetFilePos(strlen("qBreakpointHitCount:"));
+  if (packet.GetBytesLeft() < 1)
+    return SendIllFormedResponse(
+        packet, "Too short qBreakpointHitCount packet, missing address");
+  const lldb::addr_t addr = packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+
+  uint64_t skipped_hits = 0;
+  uint32_t ignore_count = 0;
+  Status error = m_debugged_process_up->GetBreakpointHitCounts(
+      addr, skipped_hits, ignore_count);
+  if (error.Fail())
+    return SendErrorResponse(0x09);
+
+  StreamGDBRemote response;
+  response.Printf("hits:%" PRIx64 ";ignore:%" PRIx32 ";", skipped_hits,
+                  ignore_count);
+  return SendPacketNoLock(response.GetString());
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_qFileLoadAddress(
     StringExtractorGDBRemote &packet) {
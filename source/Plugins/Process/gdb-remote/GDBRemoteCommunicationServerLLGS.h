@@ -186,6 +186,10 @@ protected:
 
   PacketResult Handle_z(StringExtractorGDBRemote &packet);
 
+  PacketResult Handle__Z(StringExtractorGDBRemote &packet);
+
+  PacketResult Handle__z(StringExtractorGDBRemote &packet);
+
   PacketResult Handle_s(StringExtractorGDBRemote &packet);
 
   PacketResult Handle_qXfer_auxv_read(StringExtractorGDBRemote &packet);
@@ -212,6 +216,8 @@ protected:
 
   PacketResult Handle_qWatchpointSupportInfo(StringExtractorGDBRemote &packet);
 
+  PacketResult Handle_qBreakpointHitCount(StringExtractorGDBRemote &packet);
+
   PacketResult Handle_qFileLoadAddress(StringExtractorGDBRemote &packet);
 
   PacketResult Handle_QPassSignals(StringExtractorGDBRemote &packet);
@@ -0,0 +1,872 @@
+//===-- GDBRemoteConditionCompiler.cpp --------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// C Includes
+// C++ Includes
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+
+// Other libraries and framework includes
+#include "llvm/ADT/StringSwitch.h"
+
+// Project includes
+#include "Plugins/Process/Utility/DynamicRegisterInfo.h"
+#include "lldb/Core/Address.h"
+#include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
+#include "lldb/Core/dwarf.h"
+#include "lldb/Expression/DWARFExpression.h"
+#include "lldb/Symbol/Block.h"
+#include "lldb/Symbol/CompileUnit.h"
+#include "lldb/Symbol/CompilerDeclContext.h"
+#include "lldb/Symbol/Function.h"
+#include "lldb/Symbol/SymbolContext.h"
+#include "lldb/Symbol/Type.h"
+#include "lldb/Symbol/Variable.h"
+#include "lldb/Symbol/VariableList.h"
+#include "lldb/Target/Language.h"
+#include "lldb/Target/Target.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/Log.h"
+
+#include "GDBRemoteConditionCompiler.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::process_gdb_remote;
+
+namespace {
+
+// The C type of a value.  Only integers are supported, and values on the
+// agent expression stack are always kept sign or zero extended from the
+// width of their type to 64 bits.
+struct ValueType {
+  uint8_t bits;
+  bool is_signed;
+};
+
+const ValueType g_int_type = {32, true};
+
+ValueType Promote(ValueType type) {
+  if (type.bits < g_int_type.bits)
+    return g_int_type;
+  return type;
+}
+
+// The usual arithmetic conversions.
+ValueType GetCommonType(ValueType lhs, ValueType rhs) {
+  lhs = Promote(lhs);
+  rhs = Promote(rhs);
+  if (lhs.bits == rhs.bits)
+    return {lhs.bits, lhs.is_signed && rhs.is_signed};
+  return lhs.bits > rhs.bits ? lhs : rhs;
+}
+
+struct Node;
+typedef std::unique_ptr<Node> NodeUP;
+
+struct Node {
+  enum Kind { eConstant, eRegister, eMemory, eUnary, eBinary };
+
+  Kind kind;
+  ValueType type;
+  // The type the operands are converted to before the operation.
+  ValueType operand_type;
+  // The constant for eConstant.  For eMemory, the address or, if reg_num is
+  // valid, the offset from the register.
+  uint64_t value = 0;
+  uint32_t reg_num = LLDB_INVALID_REGNUM;
+  std::string op;
+  NodeUP lhs;
+  NodeUP rhs;
+};
+
+NodeUP MakeConstant(uint64_t value, ValueType type) {
+  NodeUP node(new Node());
+  node->kind = Node::eConstant;
+  node->type = type;
+  node->value = value;
+  return node;
+}
+
+int GetBinaryPrecedence(llvm::StringRef op) {
+  return llvm::StringSwitch<int>(op)
+      .Case("||", 1)
+      .Case("&&", 2)
+      .Case("|", 3)
+      .Case("^", 4)
+      .Case("&", 5)
+      .Cases("==", "!=", 6)
+      .Cases("<", ">", "<=", ">=", 7)
+      .Cases("<<", ">>", 8)
+      .Cases("+", "-", 9)
+      .Cases("*", "/", "%", 10)
+      .Default(-1);
+}
+
+bool IsComparison(llvm::StringRef op) {
+  return GetBinaryPrecedence(op) == 6 || GetBinaryPrecedence(op) == 7;
+}
+
+NodeUP MakeBinary(llvm::StringRef op, NodeUP lhs, NodeUP rhs) {
+  NodeUP node(new Node());
+  node->kind = Node::eBinary;
+  node->op = op.str();
+  if (op == "&&" || op == "||") {
+    node->type = g_int_type;
+  } else if (op == "<<" || op == ">>") {
+    node->operand_type = Promote(lhs->type);
+    node->type = node->operand_type;
+  } else if (IsComparison(op)) {
+    node->operand_type = GetCommonType(lhs->type, rhs->type);
+    node->type = g_int_type;
+  } else {
+    node->operand_type = GetCommonType(lhs->type, rhs->type);
+    node->type = node->operand_type;
+  }
+  node->lhs = std::move(lhs);
+  node->rhs = std::move(rhs);
+  return node;
+}
+
+NodeUP MakeUnary(llvm::StringRef op, NodeUP operand) {
+  NodeUP node(new Node());
+  node->kind = Node::eUnary;
+  node->op = op.str();
+  if (op == "!") {
+    node->operand_type = operand->type;
+    node->type = g_int_type;
+  } else {
+    node->operand_type = Promote(operand->type);
+    node->type = node->operand_type;
+  }
+  node->lhs = std::move(operand);
+  return node;
+}
+
+//----------------------------------------------------------------------
+// A recursive descent parser for C integer expressions.
+//----------------------------------------------------------------------
+class ConditionParser {
+public:
+  typedef std::function<NodeUP(llvm::StringRef name)> LookupCallback;
+
+  ConditionParser(llvm::StringRef text, LookupCallback lookup_variable,
+                  LookupCallback lookup_register)
+      : m_text(text), m_lookup_variable(std::move(lookup_variable)),
+        m_lookup_register(std::move(lookup_register)) {}
+
+  NodeUP Parse() {
+    Lex();
+    NodeUP node = ParseBinary(1);
+    if (!node || m_token_kind != eTokenEnd)
+      return nullptr;
+    return node;
+  }
+
+private:
+  enum TokenKind {
+    eTokenEnd,
+    eTokenNumber,
+    eTokenIdentifier,
+    eTokenRegister,
+    eTokenPunctuator,
+    eTokenInvalid
+  };
+
+  // Nesting is limited so a hostile condition can't blow the stack.
+  static const unsigned g_max_depth = 64;
+
+  static bool IsIdentifierChar(char c) {
+    return isalnum(static_cast<unsigned char>(c)) || c == '_';
+  }
+
+  void Lex() {
+    while (m_pos < m_text.size() &&
+           isspace(static_cast<unsigned char>(m_text[m_pos])))
+      ++m_pos;
+
+    if (m_pos >= m_text.size()) {
+      m_token_kind = eTokenEnd;
+      m_token = llvm::StringRef();
+      return;
+    }
+
+    const size_t start = m_pos;
+    const char c = m_text[m_pos];
+    if (isdigit(static_cast<unsigned char>(c))) {
+      LexNumber();
+    } else if (c == '\'') {
+      LexCharacter();
+    } else if (IsIdentifierChar(c) || c == '$') {
+      ++m_pos;
+      while (m_pos < m_text.size() && IsIdentifierChar(m_text[m_pos]))
+        ++m_pos;
+      m_token_kind = c == '$' ? eTokenRegister : eTokenIdentifier;
+      if (c == '$')
+        m_token = m_text.slice(start + 1, m_pos);
+      else
+        m_token = m_text.slice(start, m_pos);
+      if (m_token.empty())
+        m_token_kind = eTokenInvalid;
+    } else {
+      static const char *g_punctuators[] = {
+          "&&", "||", "==", "!=", "<=", ">=", "<<", ">>", "<", ">", "+",
+          "-",  "*",  "/",  "%",  "&",  "|",  "^",  "!",  "~", "(", ")"};
+      m_token_kind = eTokenInvalid;
+      for (const char *punctuator : g_punctuators) {
+        if (m_text.substr(m_pos).startswith(punctuator)) {
+          m_token_kind = eTokenPunctuator;
+          m_token = m_text.substr(m_pos, strlen(punctuator));
+          m_pos += m_token.size();
+          break;
+        }
+      }
+    }
+  }
+
+  void LexNumber() {
+    llvm::StringRef rest = m_text.substr(m_pos);
+    // Octal and hex literals may have an unsigned type without a suffix.
+    const bool is_decimal = rest.size() == 1 || rest[0] != '0' ||
+                            !isalnum(static_cast<unsigned char>(rest[1]));
+    uint64_t value = 0;
+    m_token_kind = eTokenInvalid;
+    if (rest.consumeInteger(0, value))
+      return;
+
+    bool is_unsigned = false;
+    bool is_long = false;
+    while (!rest.empty() && strchr("uUlL", rest.front())) {
+      if (tolower(rest.front()) == 'u')
+        is_unsigned = true;
+      else
+        is_long = true;
+      rest = rest.drop_front();
+    }
+    if (!rest.empty() &&
+        (IsIdentifierChar(rest.front()) || rest.front() == '.'))
+      return;
+    m_pos = m_text.size() - rest.size();
+
+    const uint64_t int_max = std::numeric_limits<int32_t>::max();
+    const uint64_t uint_max = std::numeric_limits<uint32_t>::max();
+    const uint64_t long_max = std::numeric_limits<int64_t>::max();
+    if (!is_unsigned && !is_long && value <= int_max)
+      m_number_type = {32, true};
+    else if (!is_long && (is_unsigned || !is_decimal) && value <= uint_max)
+      m_number_type = {32, false};
+    else if (!is_unsigned && value <= long_max)
+      m_number_type = {64, true};
+    else if (is_unsigned || !is_decimal)
+      m_number_type = {64, false};
+    else
+      return;
+
+    m_number = value;
+    m_token_kind = eTokenNumber;
+  }
+
+  void LexCharacter() {
+    llvm::StringRef rest = m_text.substr(m_pos);
+    m_token_kind = eTokenInvalid;
+    char value;
+    size_t length;
+    if (rest.size() >= 3 && rest[1] != '\\' && rest[2] == '\'') {
+      value = rest[1];
+      length = 3;
+    } else if (rest.size() >= 4 && rest[1] == '\\' && rest[3] == '\'') {
+      switch (rest[2]) {
+      case '0':
+        value = '\0';
+        break;
+      case 'n':
+        value = '\n';
+        break;
+      case 't':
+        value = '\t';
+        break;
+      case '\\':
+      case '\'':
+        value = rest[2];
+        break;
+      default:
+        return;
+      }
+      length = 4;
+    } else {
+      return;
+    }
+
+    // Character literals have type int, with the value of the char.
+    m_number = static_cast<uint64_t>(static_cast<int64_t>(value));
+    m_number_type = g_int_type;
+    m_token_kind = eTokenNumber;
+    m_pos += length;
+  }
+
+  bool IsPunctuator(llvm::StringRef punctuator) const {
+    return m_token_kind == eTokenPunctuator && m_token == punctuator;
+  }
+
+  NodeUP ParseBinary(int min_precedence) {
+    if (++m_depth > g_max_depth)
+      return nullptr;
+
+    NodeUP lhs = ParseUnary();
+    while (lhs && m_token_kind == eTokenPunctuator) {
+      const int precedence = GetBinaryPrecedence(m_token);
+      if (precedence < min_precedence)
+        break;
+      const std::string op = m_token.str();
+      Lex();
+      NodeUP rhs = ParseBinary(precedence + 1);
+      if (!rhs)
+        return nullptr;
+      lhs = MakeBinary(op, std::move(lhs), std::move(rhs));
+    }
+
+    --m_depth;
+    return lhs;
+  }
+
+  NodeUP ParseUnary() {
+    if (IsPunctuator("!") || IsPunctuator("~") || IsPunctuator("-") ||
+        IsPunctuator("+")) {
+      const std::string op = m_token.str();
+      Lex();
+      if (++m_depth > g_max_depth)
+        return nullptr;
+      NodeUP operand = ParseUnary();
+      --m_depth;
+      if (!operand)
+        return nullptr;
+      return MakeUnary(op, std::move(operand));
+    }
+    return ParsePrimary();
+  }
+
+  NodeUP ParsePrimary() {
+    NodeUP node;
+    switch (m_token_kind) {
+    case eTokenNumber:
+      node = MakeConstant(m_number, m_number_type);
+      break;
+    case eTokenIdentifier:
+      if (m_token == "true" || m_token == "false")
+        node = MakeConstant(m_token == "true", g_int_type);
+      else
+        node = m_lookup_variable(m_token);
+      break;
+    case eTokenRegister:
+      node = m_lookup_register(m_token);
+      break;
+    case eTokenPunctuator:
+      if (m_token != "(")
+        return nullptr;
+      Lex();
+      node = ParseBinary(1);
+      if (!node || !IsPunctuator(")"))
+        return nullptr;
+      break;
+    default:
+      return nullptr;
+    }
+
+    if (node)
+      Lex();
+    return node;
+  }
+
+  llvm::StringRef m_text;
+  size_t m_pos = 0;
+  unsigned m_depth = 0;
+  TokenKind m_token_kind = eTokenEnd;
+  llvm::StringRef m_token;
+  uint64_t m_number = 0;
+  ValueType m_number_type = g_int_type;
+  LookupCallback m_lookup_variable;
+  LookupCallback m_lookup_register;
+};
+
+//----------------------------------------------------------------------
+// Code generation
+//----------------------------------------------------------------------
+void EmitNormalize(AgentExpression &expr, ValueType type) {
+  if (type.bits < 64)
+    expr.AppendExtend(type.bits, type.is_signed);
+}
+
+void EmitConvert(AgentExpression &expr, ValueType from, ValueType to) {
+  if (to.bits < 64 && (from.bits > to.bits || from.is_signed != to.is_signed))
+    expr.AppendExtend(to.bits, to.is_signed);
+}
+
+// Leave 1 on the stack if the value on top of it is non-zero, 0 otherwise.
+void EmitBool(AgentExpression &expr) {
+  expr.AppendOpcode(AgentExpression::eOpLogNot);
+  expr.AppendOpcode(AgentExpression::eOpLogNot);
+}
+
+void Emit(AgentExpression &expr, const Node &node);
+
+void EmitLogical(AgentExpression &expr, const Node &node) {
+  // The right hand side is only evaluated when needed, like in C, so it can
+  // safely read memory the left hand side checked for.
+  const bool is_and = node.op == "&&";
+  Emit(expr, *node.lhs);
+  if (is_and)
+    expr.AppendOpcode(AgentExpression::eOpLogNot);
+  const size_t short_circuit_patch =
+      expr.AppendGoto(AgentExpression::eOpIfGoto);
+  Emit(expr, *node.rhs);
+  EmitBool(expr);
+  const size_t end_patch = expr.AppendGoto(AgentExpression::eOpGoto);
+  expr.PatchGoto(short_circuit_patch, expr.GetSize());
+  expr.AppendConstant(is_and ? 0 : 1);
+  expr.PatchGoto(end_patch, expr.GetSize());
+}
+
+void EmitBinary(AgentExpression &expr, const Node &node) {
+  if (node.op == "&&" || node.op == "||") {
+    EmitLogical(expr, node);
+    return;
+  }
+
+  const bool is_shift = node.op == "<<" || node.op == ">>";
+  Emit(expr, *node.lhs);
+  EmitConvert(expr, node.lhs->type, node.operand_type);
+  Emit(expr, *node.rhs);
+  if (!is_shift)
+    EmitConvert(expr, node.rhs->type, node.operand_type);
+
+  const bool is_signed = node.operand_type.is_signed;
+  const llvm::StringRef op = node.op;
+  if (op == "+") {
+    expr.AppendOpcode(AgentExpression::eOpAdd);
+    EmitNormalize(expr, node.type);
+  } else if (op == "-") {
+    expr.AppendOpcode(AgentExpression::eOpSub);
+    EmitNormalize(expr, node.type);
+  } else if (op == "*") {
+    expr.AppendOpcode(AgentExpression::eOpMul);
+    EmitNormalize(expr, node.type);
+  } else if (op == "/") {
+    expr.AppendOpcode(is_signed ? AgentExpression::eOpDivSigned
+                                : AgentExpression::eOpDivUnsigned);
+  } else if (op == "%") {
+    expr.AppendOpcode(is_signed ? AgentExpression::eOpRemSigned
+                                : AgentExpression::eOpRemUnsigned);
+  } else if (op == "<<") {
+    expr.AppendOpcode(AgentExpression::eOpLsh);
+    EmitNormalize(expr, node.type);
+  } else if (op == ">>") {
+    expr.AppendOpcode(is_signed ? AgentExpression::eOpRshSigned
+                                : AgentExpression::eOpRshUnsigned);
+  } else if (op == "&") {
+    expr.AppendOpcode(AgentExpression::eOpBitAnd);
+  } else if (op == "|") {
+    expr.AppendOpcode(AgentExpression::eOpBitOr);
+  } else if (op == "^") {
+    expr.AppendOpcode(AgentExpression::eOpBitXor);
+  } else if (op == "==" || op == "!=") {
+    expr.AppendOpcode(AgentExpression::eOpEqual);
+    if (op == "!=")
+      expr.AppendOpcode(AgentExpression::eOpLogNot);
+  } else {
+    // a > b is b < a, a <= b is !(b < a) and a >= b is !(a < b).
+    if (op == ">" || op == "<=")
+      expr.AppendOpcode(AgentExpression::eOpSwap);
+    expr.AppendOpcode(is_signed ? AgentExpression::eOpLessSigned
+                                : AgentExpression::eOpLessUnsigned);
+    if (op == "<=" || op == ">=")
+      expr.AppendOpcode(AgentExpression::eOpLogNot);
+  }
+}
+
+void Emit(AgentExpression &expr, const Node &node) {
+  switch (node.kind) {
+  case Node::eConstant:
+    expr.AppendConstant(node.value);
+    break;
+
+  case Node::eRegister:
+    expr.AppendRegister(node.reg_num);
+    EmitNormalize(expr, node.type);
+    break;
+
+  case Node::eMemory:
+    if (node.reg_num != LLDB_INVALID_REGNUM) {
+      expr.AppendRegister(node.reg_num);
+      if (node.value != 0) {
+        expr.AppendConstant(node.value);
+        expr.AppendOpcode(AgentExpression::eOpAdd);
+      }
+    } else {
+      expr.AppendConstant(node.value);
+    }
+    expr.AppendReference(node.type.bits / 8);
+    if (node.type.is_signed)
+      EmitNormalize(expr, node.type);
+    break;
+
+  case Node::eUnary:
+    Emit(expr, *node.lhs);
+    EmitConvert(expr, node.lhs->type, node.operand_type);
+    if (node.op == "!") {
+      expr.AppendOpcode(AgentExpression::eOpLogNot);
+    } else if (node.op == "~") {
+      expr.AppendOpcode(AgentExpression::eOpBitNot);
+      EmitNormalize(expr, node.type);
+    } else if (node.op == "-") {
+      expr.AppendConstant(0);
+      expr.AppendOpcode(AgentExpression::eOpSwap);
+      expr.AppendOpcode(AgentExpression::eOpSub);
+      EmitNormalize(expr, node.type);
+    }
+    break;
+
+  case Node::eBinary:
+    EmitBinary(expr, node);
+    break;
+  }
+}
+
+//----------------------------------------------------------------------
+// Variable locations
+//----------------------------------------------------------------------
+
+// The DWARF locations we can turn into agent expressions: a register, a
+// register plus an offset, or a fixed address.
+struct SimpleLocation {
+  enum Kind {
+    eInvalid,
+    eRegister,
+    eRegisterOffset,
+    eFrameBaseOffset,
+    eAddress
+  };
+
+  Kind kind = eInvalid;
+  uint32_t reg_num = LLDB_INVALID_REGNUM;
+  int64_t offset = 0;
+  addr_t file_addr = LLDB_INVALID_ADDRESS;
+};
+
+SimpleLocation ParseSimpleLocation(const DWARFExpression &dwarf_expr) {
+  SimpleLocation location;
+  DataExtractor data;
+  if (dwarf_expr.IsLocationList() || !dwarf_expr.GetExpressionData(data))
+    return location;
+
+  lldb::offset_t offset = 0;
+  const uint8_t op = data.GetU8(&offset);
+  if (op >= DW_OP_reg0 && op <= DW_OP_reg31) {
+    location.kind = SimpleLocation::eRegister;
+    location.reg_num = op - DW_OP_reg0;
+  } else if (op == DW_OP_regx) {
+    location.kind = SimpleLocation::eRegister;
+    location.reg_num = data.GetULEB128(&offset);
+  } else if (op >= DW_OP_breg0 && op <= DW_OP_breg31) {
+    location.kind = SimpleLocation::eRegisterOffset;
+    location.reg_num = op - DW_OP_breg0;
+    location.offset = data.GetSLEB128(&offset);
+  } else if (op == DW_OP_bregx) {
+    location.kind = SimpleLocation::eRegisterOffset;
+    location.reg_num = data.GetULEB128(&offset);
+    location.offset = data.GetSLEB128(&offset);
+  } else if (op == DW_OP_fbreg) {
+    location.kind = SimpleLocation::eFrameBaseOffset;
+    location.offset = data.GetSLEB128(&offset);
+  } else if (op == DW_OP_addr) {
+    location.kind = SimpleLocation::eAddress;
+    location.file_addr = data.GetAddress(&offset);
+  }
+
+  // Anything after the first operation, like DW_OP_piece, DW_OP_deref or
+  // DW_OP_stack_value, is more than we handle.
+  if (offset != data.GetByteSize())
+    location.kind = SimpleLocation::eInvalid;
+  return location;
+}
+
+typedef GDBRemoteConditionCompiler::Operand Operand;
+
+NodeUP MakeOperand(const Operand &operand) {
+  NodeUP node(new Node());
+  switch (operand.kind) {
+  case Operand::eInvalid:
+    return nullptr;
+  case Operand::eRegister:
+    node->kind = Node::eRegister;
+    break;
+  case Operand::eMemory:
+    node->kind = Node::eMemory;
+    break;
+  }
+  node->type = {operand.bits, operand.is_signed};
+  node->reg_num = operand.reg_num;
+  node->value = operand.value;
+  return node;
+}
+
+// The names visible at an address in the target.
+class TargetScope : public GDBRemoteConditionCompiler::Scope {
+public:
+  TargetScope(Target &target, const DynamicRegisterInfo &register_info,
+              const Address &address, const SymbolContext &sc)
+      : m_target(target), m_register_info(register_info), m_address(address),
+        m_sc(sc) {}
+
+  bool FindLocal(llvm::StringRef name, Operand &operand) override {
+    if (!m_sc.block)
+      return false;
+    VariableList local_vars;
+    m_sc.block->AppendVariables(true, true, true,
+                                [](Variable *) { return true; }, &local_vars);
+    VariableSP var_sp = local_vars.FindVariable(ConstString(name));
+    if (!var_sp)
+      return false;
+    if (var_sp->LocationIsValidForAddress(m_address))
+      GetOperand(*var_sp, operand);
+    return true;
+  }
+
+  bool HasImplicitScope() override {
+    // Methods can name members of "this" or "self" without qualification.
+    if (m_sc.block) {
+      CompilerDeclContext decl_ctx = m_sc.block->GetDeclContext();
+      if (decl_ctx.IsValid() &&
+          decl_ctx.IsClassMethod(nullptr, nullptr, nullptr))
+        return true;
+    }
+    // Functions in a namespace or class see the names in it first.
+    if (m_sc.function) {
+      llvm::StringRef func_name =
+          m_sc.function->GetNameNoArguments().GetStringRef();
+      if (func_name.contains("::") || func_name.startswith("-[") ||
+          func_name.startswith("+["))
+        return true;
+    }
+    return false;
+  }
+
+  bool FindGlobal(llvm::StringRef name, Operand &operand) override {
+    ConstString const_name(name);
+    VariableSP var_sp;
+    VariableListSP cu_vars = m_sc.comp_unit->GetVariableList(true);
+    if (cu_vars)
+      var_sp = cu_vars->FindVariable(const_name);
+    if (!var_sp) {
+      VariableList global_vars;
+      if (m_target.GetImages().FindGlobalVariables(const_name, true, 2,
+                                                   global_vars) != 1)
+        return false;
+      var_sp = global_vars.GetVariableAtIndex(0);
+    }
+    if (!var_sp)
+      return false;
+    GetOperand(*var_sp, operand);
+    return true;
+  }
+
+  bool FindRegister(llvm::StringRef name, Operand &operand) override {
+    const size_t num_regs = m_register_info.GetNumRegisters();
+    for (uint32_t i = 0; i < num_regs; ++i) {
+      const RegisterInfo *reg_info = m_register_info.GetRegisterInfoAtIndex(i);
+      if (!reg_info || reg_info->byte_size == 0 || reg_info->byte_size > 8 ||
+          reg_info->kinds[eRegisterKindProcessPlugin] >
+              std::numeric_limits<uint16_t>::max())
+        continue;
+      if ((reg_info->name && name == reg_info->name) ||
+          (reg_info->alt_name && name == reg_info->alt_name)) {
+        operand.kind = Operand::eRegister;
+        operand.bits = reg_info->byte_size * 8;
+        operand.is_signed = false;
+        operand.reg_num = reg_info->kinds[eRegisterKindProcessPlugin];
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  // Map a register in the given numbering to the stub's numbering.
+  bool GetRemoteRegister(uint32_t kind, uint32_t reg_num,
+                         uint32_t &remote_reg_num, uint8_t &bits) {
+    const uint32_t lldb_reg_num =
+        m_register_info.ConvertRegisterKindToRegisterNumber(kind, reg_num);
+    if (lldb_reg_num == LLDB_INVALID_REGNUM)
+      return false;
+    const RegisterInfo *reg_info =
+        m_register_info.GetRegisterInfoAtIndex(lldb_reg_num);
+    if (!reg_info || reg_info->byte_size == 0 || reg_info->byte_size > 8 ||
+        reg_info->kinds[eRegisterKindProcessPlugin] >
+            std::numeric_limits<uint16_t>::max())
+      return false;
+    remote_reg_num = reg_info->kinds[eRegisterKindProcessPlugin];
+    bits = reg_info->byte_size * 8;
+    return true;
+  }
+
+  // Fill in \a operand for \a var, leaving it invalid if we can't read it.
+  void GetOperand(Variable &var, Operand &operand) {
+    operand.kind = Operand::eInvalid;
+    if (!var.GetType())
+      return;
+
+    // Only integers, enums and pointers.
+    CompilerType type = var.GetType()->GetFullCompilerType().GetCanonicalType();
+    bool is_signed = false;
+    if (!type.IsIntegerOrEnumerationType(is_signed)) {
+      if (!type.IsPointerType())
+        return;
+      is_signed = false;
+    }
+    const uint64_t byte_size = type.GetByteSize(nullptr);
+    if (byte_size != 1 && byte_size != 2 && byte_size != 4 && byte_size != 8)
+      return;
+
+    Operand result;
+    result.bits = byte_size * 8;
+    result.is_signed = is_signed;
+
+    DWARFExpression &dwarf_expr = var.LocationExpression();
+    const uint32_t reg_kind = dwarf_expr.GetRegisterKind();
+    SimpleLocation location = ParseSimpleLocation(dwarf_expr);
+    uint8_t reg_bits = 0;
+    switch (location.kind) {
+    case SimpleLocation::eInvalid:
+      return;
+
+    case SimpleLocation::eRegister:
+      if (!GetRemoteRegister(reg_kind, location.reg_num, result.reg_num,
+                             reg_bits) ||
+          reg_bits < result.bits)
+        return;
+      result.kind = Operand::eRegister;
+      break;
+
+    case SimpleLocation::eRegisterOffset:
+      if (!GetRemoteRegister(reg_kind, location.reg_num, result.reg_num,
+                             reg_bits))
+        return;
+      result.kind = Operand::eMemory;
+      result.value = location.offset;
+      break;
+
+    case SimpleLocation::eFrameBaseOffset: {
+      // The frame base must be a register, or a register plus an offset.
+      if (!m_sc.function)
+        return;
+      DWARFExpression &frame_base = m_sc.function->GetFrameBaseExpression();
+      SimpleLocation base = ParseSimpleLocation(frame_base);
+      if (base.kind != SimpleLocation::eRegister &&
+          base.kind != SimpleLocation::eRegisterOffset)
+        return;
+      if (!GetRemoteRegister(frame_base.GetRegisterKind(), base.reg_num,
+                             result.reg_num, reg_bits))
+        return;
+      result.kind = Operand::eMemory;
+      result.value = location.offset + base.offset;
+      break;
+    }
+
+    case SimpleLocation::eAddress: {
+      SymbolContext var_sc;
+      var.CalculateSymbolContext(&var_sc);
+      Address so_addr;
+      if (!var_sc.module_sp ||
+          !var_sc.module_sp->ResolveFileAddress(location.file_addr, so_addr))
+        return;
+      const addr_t load_addr = so_addr.GetLoadAddress(&m_target);
+      if (load_addr == LLDB_INVALID_ADDRESS)
+        return;
+      result.kind = Operand::eMemory;
+      result.value = load_addr;
+      break;
+    }
+    }
+    operand = result;
+  }
+
+  Target &m_target;
+  const DynamicRegisterInfo &m_register_info;
+  const Address &m_address;
+  const SymbolContext &m_sc;
+};
+
+} // namespace
+
+GDBRemoteConditionCompiler::GDBRemoteConditionCompiler(
+    Target &target, const DynamicRegisterInfo &register_info)
+    : m_target(target), m_register_info(register_info) {}
+
+bool GDBRemoteConditionCompiler::Compile(llvm::StringRef condition,
+                                         const Address &address,
+                                         AgentExpression &expr) {
+  SymbolContext sc;
+  address.CalculateSymbolContext(&sc, eSymbolContextEverything);
+  if (!sc.comp_unit)
+    return false;
+
+  // The parser only speaks C.
+  const LanguageType language = sc.comp_unit->GetLanguage();
+  if (!Language::LanguageIsC(language) &&
+      !Language::LanguageIsCPlusPlus(language) &&
+      !Language::LanguageIsObjC(language))
+    return false;
+
+  TargetScope scope(m_target, m_register_info, address, sc);
+  return Compile(condition, scope, expr);
+}
+
+bool GDBRemoteConditionCompiler::Compile(llvm::StringRef condition,
+                                         Scope &scope, AgentExpression &expr) {
+  Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+
+  auto lookup_register = [&scope](llvm::StringRef name) -> NodeUP {
+    Operand operand;
+    if (!scope.FindRegister(name, operand))
+      return nullptr;
+    return MakeOperand(operand);
+  };
+
+  auto lookup_variable = [&scope](llvm::StringRef name) -> NodeUP {
+    Operand operand;
+    if (scope.FindLocal(name, operand))
+      return MakeOperand(operand);
+    // Clang would look in "this", "self" and the enclosing namespaces before
+    // the globals, and we can't, so let the expression parser have it.
+    if (scope.HasImplicitScope() || !scope.FindGlobal(name, operand))
+      return nullptr;
+    return MakeOperand(operand);
+  };
+
+  ConditionParser parser(condition, lookup_variable, lookup_register);
+  NodeUP root = parser.Parse();
+  if (!root) {
+    if (log)
+      log->Printf("GDBRemoteConditionCompiler::%s can't compile \"%s\"",
+                  __FUNCTION__, condition.str().c_str());
+    return false;
+  }
+
+  AgentExpression compiled;
+  Emit(compiled, *root);
+  compiled.AppendOpcode(AgentExpression::eOpEnd);
+  if (compiled.GetSize() > std::numeric_limits<uint16_t>::max() ||
+      compiled.Validate().Fail())
+    return false;
+
+  expr = std::move(compiled);
+  return true;
+}
@@ -0,0 +1,122 @@
+//===-- GDBRemoteConditionCompiler.h ----------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_GDBRemoteConditionCompiler_h_
+#define liblldb_GDBRemoteConditionCompiler_h_
+
+// C Includes
+// C++ Includes
+// Other libraries and framework includes
+#include "llvm/ADT/StringRef.h"
+
+// Project includes
+#include "lldb/Utility/AgentExpression.h"
+#include "lldb/lldb-private.h"
+
+class DynamicRegisterInfo;
+
+namespace lldb_private {
+namespace process_gdb_remote {
+
+//----------------------------------------------------------------------
+/// @class GDBRemoteConditionCompiler GDBRemoteConditionCompiler.h
+/// @brief Compile simple breakpoint conditions to agent expressions.
+///
+/// A stub that supports the "ConditionalBreakpoints" feature evaluates
+/// breakpoint conditions itself and only stops the process when one of
+/// them is true, which saves a round trip to the debugger for every hit.
+///
+/// This compiles the conditions that don't need the expression parser:
+/// integer arithmetic, comparisons and logical operators over literals,
+/// registers ("$rax") and scalar variables that live at a fixed address,
+/// in a register or at an offset from a register.  Anything else is left
+/// for the debugger to evaluate when the breakpoint is reported.
+//----------------------------------------------------------------------
+class GDBRemoteConditionCompiler {
+public:
+  //------------------------------------------------------------------
+  /// A name in a condition, resolved to something the stub can read.
+  //------------------------------------------------------------------
+  struct Operand {
+    enum Kind {
+      eInvalid,  ///< Found, but not something we can compile.
+      eRegister, ///< The value of register \a reg_num.
+      eMemory    ///< Memory at \a value, plus register \a reg_num if valid.
+    };
+
+    Kind kind = eInvalid;
+    uint8_t bits = 0;
+    bool is_signed = false;
+    /// The register in the stub's numbering.
+    uint32_t reg_num = LLDB_INVALID_REGNUM;
+    uint64_t value = 0;
+  };
+
+  //------------------------------------------------------------------
+  /// The names visible at the breakpoint's address.
+  //------------------------------------------------------------------
+  class Scope {
+  public:
+    virtual ~Scope() = default;
+
+    //------------------------------------------------------------------
+    /// Look \a name up among the locals and arguments of the enclosing
+    /// blocks.
+    ///
+    /// @return
+    ///     True if the name is a local, even if \a operand can't be
+    ///     compiled.
+    //------------------------------------------------------------------
+    virtual bool FindLocal(llvm::StringRef name, Operand &operand) = 0;
+
+    //------------------------------------------------------------------
+    /// Whether a name that isn't a local could also be a member of
+    /// "this" or "self", or live in an enclosing namespace or class.
+    //------------------------------------------------------------------
+    virtual bool HasImplicitScope() = 0;
+
+    virtual bool FindGlobal(llvm::StringRef name, Operand &operand) = 0;
+
+    virtual bool FindRegister(llvm::StringRef name, Operand &operand) = 0;
+  };
+
+  GDBRemoteConditionCompiler(Target &target,
+                             const DynamicRegisterInfo &register_info);
+
+  //------------------------------------------------------------------
+  /// Compile \a condition as it would be evaluated at \a address.
+  ///
+  /// @return
+  ///     False if the condition uses anything that can't be compiled.
+  //------------------------------------------------------------------
+  bool Compile(llvm::StringRef condition, const Address &address,
+               AgentExpression &expr);
+
+  //------------------------------------------------------------------
+  /// Compile \a condition with the names in \a scope.
+  ///
+  /// Names that aren't locals are only compiled when \a scope has no
+  /// implicit scope, since a member of "this" or "self" or a name in an
+  /// enclosing namespace would shadow the global we can see.  Those
+  /// conditions are left to the expression parser.
+  //------------------------------------------------------------------
+  static bool Compile(llvm::StringRef condition, Scope &scope,
+                      AgentExpression &expr);
+
+private:
+  Target &m_target;
+  const DynamicRegisterInfo &m_register_info;
+
+  DISALLOW_COPY_AND_ASSIGN(GDBRemoteConditionCompiler);
+};
+
+} // namespace process_gdb_remote
+} // namespace lldb_private
+
+#endif // liblldb_GDBRemoteConditionCompiler_h_
@@ -28,6 +28,7 @@
 #include <mutex>
 #include <sstream>
 
+#include "lldb/Breakpoint/BreakpointLocation.h"
 #include "lldb/Breakpoint/Watchpoint.h"
 #include "lldb/Core/ArchSpec.h"
 #include "lldb/Core/Debugger.h"
@@ -64,12 +65,14 @@
 #include "lldb/Target/Target.h"
 #include "lldb/Target/TargetList.h"
 #include "lldb/Target/ThreadPlanCallFunction.h"
+#include "lldb/Target/ThreadSpec.h"
 #include "lldb/Utility/CleanUp.h"
 #include "lldb/Utility/FileSpec.h"
 #include "lldb/Utility/StreamString.h"
 #include "lldb/Utility/Timer.h"
 
 // Project includes
+#include "GDBRemoteConditionCompiler.h"
 #include "GDBRemoteRegisterContext.h"
 #include "Plugins/Platform/MacOSX/PlatformRemoteiOS.h"
 #include "Plugins/Process/Utility/GDBRemoteSignals.h"
@@ -1281,6 +1284,7 @@ Status ProcessGDBRemote::WillResume() {
   m_continue_C_tids.clear();
   m_continue_s_tids.clear();
   m_continue_S_tids.clear();
+  m_step_ranges.clear();
   m_jstopinfo_sp.reset();
   m_jthreadsinfo_sp.reset();
   return Status();
@@ -1292,6 +1296,8 @@ Status ProcessGDBRemote::DoResume() {
   if (log)
     log->Printf("ProcessGDBRemote::Resume()");
 
+  UpdateBreakpointSiteStopOptions();
+
   ListenerSP listener_sp(
       Listener::MakeListener("gdb-remote.resume-packet-sent"));
   if (listener_sp->StartListeningForEvents(
@@ -1339,11 +1345,21 @@ Status ProcessGDBRemote::DoResume() {
 
         if (!continue_packet_error && !m_continue_s_tids.empty()) {
           if (m_gdb_comm.GetVContSupported('s')) {
+            const bool range_step = m_gdb_comm.GetVContSupported('r');
             for (tid_collection::const_iterator
                      t_pos = m_continue_s_tids.begin(),
                      t_end = m_continue_s_tids.end();
-                 t_pos != t_end; ++t_pos)
-              continue_packet.Printf(";s:%4.4" PRIx64, *t_pos);
+                 t_pos != t_end; ++t_pos) {
+              // Let the stub step through the range itself instead of
+              // stopping after every instruction.
+              auto range_pos = m_step_ranges.find(*t_pos);
+              if (range_step && range_pos != m_step_ranges.end())
+                continue_packet.Printf(";r%" PRIx64 ",%" PRIx64 ":%4.4" PRIx64,
+                                       range_pos->second.first,
+                                       range_pos->second.second, *t_pos);
+              else
+                continue_packet.Printf(";s:%4.4" PRIx64, *t_pos);
+            }
           } else
             continue_packet_error = true;
         }
@@ -2427,6 +2443,10 @@ void ProcessGDBRemote::RefreshStateAfterStop() {
   // Let all threads recover from stopping and do any clean up based
   // on the previous thread state (if any).
   m_thread_list_real.RefreshStateAfterStop();
+
+  // Bring the hit and ignore counts up to date before the stop is
+  // evaluated, the stub may have skipped hits since we last looked.
+  SyncBreakpointHitCounts();
 }
 
 Status ProcessGDBRemote::DoHalt(bool &caused_stop) {
@@ -3007,13 +3027,27 @@ Status ProcessGDBRemote::EnableBreakpointSite(BreakpointSite *bp_site) {
   // skip over software breakpoints.
   if (m_gdb_comm.SupportsGDBStoppointPacket(eBreakpointSoftware) &&
       (!bp_site->HardwareRequired())) {
-    // Try to send off a software breakpoint packet ($Z0)
+    // Try to send off a software breakpoint packet ($Z0), with what the
+    // stub can decide about the hits itself
+    GDBStoppointStopOptions options = GetBreakpointSiteStopOptions(*bp_site);
     uint8_t error_no = m_gdb_comm.SendGDBStoppointTypePacket(
-        eBreakpointSoftware, true, addr, bp_op_size);
+        eBreakpointSoftware, true, addr, bp_op_size, options);
+    if (error_no != 0 && options != GDBStoppointStopOptions() &&
+        m_gdb_comm.SupportsGDBStoppointPacket(eBreakpointSoftware)) {
+      // The stub didn't like the options, we can always handle them here
+      options = GDBStoppointStopOptions();
+      error_no = m_gdb_comm.SendGDBStoppointTypePacket(eBreakpointSoftware,
+                                                       true, addr, bp_op_size);
+    }
     if (error_no == 0) {
       // The breakpoint was placed successfully
       bp_site->SetEnabled(true);
       bp_site->SetType(BreakpointSite::eExternal);
+      BreakpointSiteStopState &state = m_bp_site_stop_states[site_id];
+      state = BreakpointSiteStopState();
+      if (options.ignore_count != 0 || options.auto_continue)
+        state.counted_location_wp = bp_site->GetOwnerAtIndex(0);
+      state.options = std::move(options);
       return error;
     }
 
@@ -3134,9 +3168,16 @@ Status ProcessGDBRemote::DisableBreakpointSite(BreakpointSite *bp_site) {
       else
         stoppoint_type = eBreakpointSoftware;
 
+      // The stub forgets the hits it skipped along with the breakpoint
+      auto pos = m_bp_site_stop_states.find(site_id);
+      if (pos != m_bp_site_stop_states.end())
+        SyncBreakpointSiteHitCounts(*bp_site, pos->second);
+
       if (m_gdb_comm.SendGDBStoppointTypePacket(stoppoint_type, false, addr,
                                                 bp_op_size))
         error.SetErrorToGenericError();
+      else
+        m_bp_site_stop_states.erase(site_id);
     } break;
     }
     if (error.Success())
@@ -3154,6 +3195,278 @@ Status ProcessGDBRemote::DisableBreakpointSite(BreakpointSite *bp_site) {
   return error;
 }
 
+void ProcessGDBRemote::EnableBreakpointSites(
+    llvm::ArrayRef<BreakpointSite *> bp_sites, std::vector<Status> &errors) {
+  errors.assign(bp_sites.size(), Status());
+
+  // Software breakpoints the stub has no stop options for are sent
+  // together, grouped by the size of their trap.  The rest go through
+  // EnableBreakpointSite.
+  std::map<size_t, std::vector<size_t>> batches;
+  for (size_t i = 0; i < bp_sites.size(); ++i) {
+    BreakpointSite *bp_site = bp_sites[i];
+    if (bp_site->IsEnabled())
+      continue;
+    if (m_gdb_comm.SupportsGDBStoppointPacket(eBreakpointSoftware) &&
+        !bp_site->HardwareRequired() &&
+        GetBreakpointSiteStopOptions(*bp_site) == GDBStoppointStopOptions())
+      batches[GetSoftwareBreakpointTrapOpcode(bp_site)].push_back(i);
+    else
+      errors[i] = EnableBreakpointSite(bp_site);
+  }
+
+  for (const auto &batch : batches) {
+    std::vector<addr_t> addrs;
+    for (size_t i : batch.second)
+      addrs.push_back(bp_sites[i]->GetLoadAddress());
+    std::vector<uint8_t> error_nos;
+    m_gdb_comm.SendSoftwareBreakpointPackets(true, addrs, batch.first,
+                                             error_nos);
+    for (size_t j = 0; j < batch.second.size(); ++j) {
+      const size_t i = batch.second[j];
+      BreakpointSite *bp_site = bp_sites[i];
+      if (error_nos[j] == 0) {
+        bp_site->SetEnabled(true);
+        bp_site->SetType(BreakpointSite::eExternal);
+        m_bp_site_stop_states[bp_site->GetID()] = BreakpointSiteStopState();
+      } else if (error_nos[j] == UINT8_MAX &&
+                 !m_gdb_comm.SupportsGDBStoppointPacket(eBreakpointSoftware)) {
+        // The stub doesn't take software breakpoints at all, let
+        // EnableBreakpointSite try the other kinds.
+        errors[i] = EnableBreakpointSite(bp_site);
+      } else if (error_nos[j] == UINT8_MAX) {
+        // We don't know whether the stub inserted it, and sending it again
+        // could insert it twice.
+        errors[i].SetErrorString("error: no valid reply to the breakpoint "
+                                 "request");
+      } else {
+        errors[i].SetErrorStringWithFormat(
+            "error: %d sending the breakpoint request", error_nos[j]);
+      }
+    }
+  }
+}
+
+void ProcessGDBRemote::DisableBreakpointSites(
+    llvm::ArrayRef<BreakpointSite *> bp_sites, std::vector<Status> &errors) {
+  errors.assign(bp_sites.size(), Status());
+
+  // Sites the stub doesn't count hits for can be removed together, the
+  // others need their hit counts fetched first.
+  std::map<size_t, std::vector<size_t>> batches;
+  for (size_t i = 0; i < bp_sites.size(); ++i) {
+    BreakpointSite *bp_site = bp_sites[i];
+    auto pos = m_bp_site_stop_states.find(bp_site->GetID());
+    if (bp_site->IsEnabled() &&
+        bp_site->GetType() == BreakpointSite::eExternal &&
+        !bp_site->IsHardware() &&
+        (pos == m_bp_site_stop_states.end() ||
+         pos->second.counted_location_wp.expired()))
+      batches[GetSoftwareBreakpointTrapOpcode(bp_site)].push_back(i);
+    else
+      errors[i] = DisableBreakpointSite(bp_site);
+  }
+
+  for (const auto &batch : batches) {
+    std::vector<addr_t> addrs;
+    for (size_t i : batch.second)
+      addrs.push_back(bp_sites[i]->GetLoadAddress());
+    std::vector<uint8_t> error_nos;
+    m_gdb_comm.SendSoftwareBreakpointPackets(false, addrs, batch.first,
+                                             error_nos);
+    for (size_t j = 0; j < batch.second.size(); ++j) {
+      const size_t i = batch.second[j];
+      BreakpointSite *bp_site = bp_sites[i];
+      if (error_nos[j] == 0) {
+        bp_site->SetEnabled(false);
+        m_bp_site_stop_states.erase(bp_site->GetID());
+      } else {
+        errors[i].SetErrorToGenericError();
+      }
+    }
+  }
+}
+
+const AgentExpression *
+ProcessGDBRemote::CompileBreakpointCondition(BreakpointLocation &loc,
+                                             const char *condition) {
+  auto key = std::make_pair(loc.GetLoadAddress(), std::string(condition));
+  auto pos = m_compiled_conditions.find(key);
+  if (pos == m_compiled_conditions.end()) {
+    GDBRemoteConditionCompiler compiler(GetTarget(), m_register_info);
+    AgentExpression expr;
+    llvm::Optional<AgentExpression> compiled;
+    if (compiler.Compile(condition, loc.GetAddress(), expr))
+      compiled = std::move(expr);
+    pos = m_compiled_conditions.emplace(key, std::move(compiled)).first;
+  }
+  return pos->second.getPointer();
+}
+
+GDBStoppointStopOptions
+ProcessGDBRemote::GetBreakpointSiteStopOptions(BreakpointSite &bp_site) {
+  GDBStoppointStopOptions options;
+  const bool use_conditions = m_gdb_comm.GetConditionalBreakpointsSupported();
+  const bool use_hit_counts = m_gdb_comm.GetBreakpointHitCountsSupported();
+  const size_t num_owners = bp_site.GetNumberOfOwners();
+  if (bp_site.IsHardware() || num_owners == 0 ||
+      (!use_conditions && !use_hit_counts))
+    return options;
+
+  std::vector<AgentExpression> conditions;
+  bool compiled_all = use_conditions;
+  bool has_ignore_count = false;
+  for (size_t i = 0; i < num_owners; ++i) {
+    BreakpointLocationSP loc_sp = bp_site.GetOwnerAtIndex(i);
+    if (!loc_sp)
+      return {};
+    const ThreadSpec *thread_spec =
+        loc_sp->GetOptionsSpecifyingKind(BreakpointOptions::eThreadSpec)
+            ->GetThreadSpecNoCreate();
+    if (thread_spec && thread_spec->HasSpecification())
+      return {};
+    if (loc_sp->GetIgnoreCount() != 0 ||
+        loc_sp->GetBreakpoint().GetIgnoreCount() != 0)
+      has_ignore_count = true;
+
+    if (!compiled_all)
+      continue;
+    const char *condition_text = loc_sp->GetConditionText();
+    const AgentExpression *condition =
+        condition_text && condition_text[0]
+            ? CompileBreakpointCondition(*loc_sp, condition_text)
+            : nullptr;
+    if (condition)
+      conditions.push_back(*condition);
+    else
+      compiled_all = false;
+  }
+
+  BreakpointLocationSP loc_sp = bp_site.GetOwnerAtIndex(0);
+  Breakpoint &bp = loc_sp->GetBreakpoint();
+  if (has_ignore_count) {
+    // Ignore counts are checked before the conditions, so without the stub
+    // doing it every hit needs to be reported.  The breakpoint's own ignore
+    // count is shared by all its locations.
+    if (!use_hit_counts || num_owners != 1 ||
+        (bp.GetIgnoreCount() != 0 && bp.GetNumLocations() != 1))
+      return {};
+    // Hits ignored by the location also use up the breakpoint's count.
+    options.ignore_count =
+        std::max(loc_sp->GetIgnoreCount(), bp.GetIgnoreCount());
+  }
+
+  if (compiled_all)
+    options.conditions = std::move(conditions);
+
+  // An auto-continue breakpoint that has nothing to run only needs its hits
+  // counted, as long as the stub can tell which hits count.
+  if (use_hit_counts && num_owners == 1 && loc_sp->IsAutoContinue() &&
+      !bp.IsOneShot() &&
+      !loc_sp->GetOptionsSpecifyingKind(BreakpointOptions::eCallback)
+           ->HasCallback()) {
+    const char *condition_text = loc_sp->GetConditionText();
+    if (!condition_text || !condition_text[0] || compiled_all)
+      options.auto_continue = true;
+  }
+  return options;
+}
+
+void ProcessGDBRemote::UpdateBreakpointSiteStopOptions() {
+  if (!m_gdb_comm.GetConditionalBreakpointsSupported() &&
+      !m_gdb_comm.GetBreakpointHitCountsSupported())
+    return;
+
+  Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_BREAKPOINTS));
+  GetBreakpointSiteList().ForEach([this, log](BreakpointSite *bp_site) {
+    if (!bp_site->IsEnabled() ||
+        bp_site->GetType() != BreakpointSite::eExternal ||
+        bp_site->IsHardware())
+      return;
+
+    GDBStoppointStopOptions options = GetBreakpointSiteStopOptions(*bp_site);
+    BreakpointSiteStopState &state = m_bp_site_stop_states[bp_site->GetID()];
+    // The hits the stub ignored since the breakpoint was inserted are
+    // already accounted for on our side.
+    GDBStoppointStopOptions stub_options = state.options;
+    stub_options.ignore_count -= state.reported_ignored;
+    if (options == stub_options)
+      return;
+
+    // Owners or options changed since the breakpoint was inserted, so
+    // replace it with one that has the new options.
+    const addr_t addr = bp_site->GetLoadAddress();
+    const size_t bp_op_size = GetSoftwareBreakpointTrapOpcode(bp_site);
+    if (log)
+      log->Printf("ProcessGDBRemote::%s updating stop options for breakpoint "
+                  "site %" PRIu64 " at 0x%" PRIx64,
+                  __FUNCTION__, (uint64_t)bp_site->GetID(), addr);
+    SyncBreakpointSiteHitCounts(*bp_site, state);
+    if (m_gdb_comm.SendGDBStoppointTypePacket(eBreakpointSoftware, false, addr,
+                                              bp_op_size))
+      return;
+    state = BreakpointSiteStopState();
+    if (m_gdb_comm.SendGDBStoppointTypePacket(eBreakpointSoftware, true, addr,
+                                              bp_op_size, options) == 0) {
+      if (options.ignore_count != 0 || options.auto_continue)
+        state.counted_location_wp = bp_site->GetOwnerAtIndex(0);
+      state.options = std::move(options);
+      return;
+    }
+    if (m_gdb_comm.SendGDBStoppointTypePacket(eBreakpointSoftware, true, addr,
+                                              bp_op_size)) {
+      if (log)
+        log->Printf("ProcessGDBRemote::%s failed to reinsert breakpoint site "
+                    "%" PRIu64,
+                    __FUNCTION__, (uint64_t)bp_site->GetID());
+      bp_site->SetEnabled(false);
+      m_bp_site_stop_states.erase(bp_site->GetID());
+    }
+  });
+}
+
+void ProcessGDBRemote::SyncBreakpointSiteHitCounts(
+    BreakpointSite &bp_site, BreakpointSiteStopState &state) {
+  BreakpointLocationSP loc_sp = state.counted_location_wp.lock();
+  if (!loc_sp)
+    return;
+
+  uint64_t skipped_hits = 0;
+  uint32_t ignore_count = 0;
+  if (!m_gdb_comm.GetBreakpointHitCount(bp_site.GetLoadAddress(), skipped_hits,
+                                        ignore_count))
+    return;
+
+  const uint32_t ignored =
+      state.options.ignore_count -
+      std::min(ignore_count, state.options.ignore_count);
+  if (skipped_hits <= state.reported_hits && ignored <= state.reported_ignored)
+    return;
+
+  Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_BREAKPOINTS));
+  if (log)
+    log->Printf("ProcessGDBRemote::%s breakpoint site %" PRIu64
+                " skipped %" PRIu64 " hits, %" PRIu32 " of them ignored",
+                __FUNCTION__, (uint64_t)bp_site.GetID(),
+                skipped_hits - state.reported_hits,
+                ignored - state.reported_ignored);
+  loc_sp->AddSkippedHits(skipped_hits - state.reported_hits,
+                         ignored - state.reported_ignored);
+  state.reported_hits = skipped_hits;
+  state.reported_ignored = ignored;
+}
+
+void ProcessGDBRemote::SyncBreakpointHitCounts() {
+  for (auto &entry : m_bp_site_stop_states) {
+    BreakpointSiteStopState &state = entry.second;
+    if (state.counted_location_wp.expired())
+      continue;
+    BreakpointSiteSP bp_site_sp = GetBreakpointSiteList().FindByID(entry.first);
+    if (bp_site_sp)
+      SyncBreakpointSiteHitCounts(*bp_site_sp, state);
+  }
+}
+
 // Pre-requisite: wp != NULL.
 static GDBStoppointType GetGDBStoppointType(Watchpoint *wp) {
   assert(wp);
@@ -4779,6 +5092,10 @@ void ProcessGDBRemote::ModulesDidLoad(ModuleList &module_list) {
   // do anything
   Process::ModulesDidLoad(module_list);
 
+  // Compiled breakpoint conditions may refer to globals the new modules
+  // define or now resolve to different load addresses.
+  m_compiled_conditions.clear();
+
   // After loading shared libraries, we can ask our remote GDB server if
   // it needs any symbols.
   m_gdb_comm.ServeSymbolLookups(this);
@@ -28,6 +28,7 @@
 #include "lldb/Host/HostThread.h"
 #include "lldb/Target/Process.h"
 #include "lldb/Target/Thread.h"
+#include "lldb/Utility/AgentExpression.h"
 #include "lldb/Utility/ConstString.h"
 #include "lldb/Utility/Status.h"
 #include "lldb/Utility/StreamGDBRemote.h"
@@ -41,6 +42,7 @@
 #include "GDBRemoteRegisterContext.h"
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 
 namespace lldb_private {
 namespace process_gdb_remote {
@@ -169,6 +171,12 @@ public:
 
   Status DisableBreakpointSite(BreakpointSite *bp_site) override;
 
+  void EnableBreakpointSites(llvm::ArrayRef<BreakpointSite *> bp_sites,
+                             std::vector<Status> &errors) override;
+
+  void DisableBreakpointSites(llvm::ArrayRef<BreakpointSite *> bp_sites,
+                              std::vector<Status> &errors) override;
+
   //----------------------------------------------------------------------
   // Process Watchpoints
   //----------------------------------------------------------------------
@@ -278,6 +286,8 @@ protected:
   std::recursive_mutex m_async_thread_state_mutex;
   typedef std::vector<lldb::tid_t> tid_collection;
   typedef std::vector<std::pair<lldb::tid_t, int>> tid_sig_collection;
+  typedef std::map<lldb::tid_t, std::pair<lldb::addr_t, lldb::addr_t>>
+      tid_range_map;
   typedef std::map<lldb::addr_t, lldb::addr_t> MMapMap;
   typedef std::map<uint32_t, std::string> ExpeditedRegisterMap;
   tid_collection m_thread_ids; // Thread IDs for all threads. This list gets
@@ -293,6 +303,7 @@ protected:
   tid_sig_collection m_continue_C_tids;       // 'C' for continue with signal
   tid_collection m_continue_s_tids;           // 's' for step
   tid_sig_collection m_continue_S_tids;       // 'S' for step with signal
+  tid_range_map m_step_ranges; // Ranges 's' threads may step through with 'r'
   uint64_t m_max_memory_size; // The maximum number of bytes to read/write when
                               // reading and writing memory
   uint64_t m_remote_stub_max_memory_size; // The maximum memory size the remote
@@ -422,6 +433,52 @@ private:
   std::string m_partial_profile_data;
   std::map<uint64_t, uint32_t> m_thread_id_to_used_usec_map;
   uint64_t m_last_signals_version = 0;
+  // Breakpoint conditions compiled for the stub, keyed by the address and
+  // the condition text.  None if the condition can't be compiled.
+  std::map<std::pair<lldb::addr_t, std::string>,
+           llvm::Optional<AgentExpression>>
+      m_compiled_conditions;
+  // What the stub decides by itself for each "Z0" breakpoint site.
+  struct BreakpointSiteStopState {
+    // The options sent with the "Z0" packet.
+    GDBStoppointStopOptions options;
+    // The location the stub counts hits for, if any.
+    lldb::BreakpointLocationWP counted_location_wp;
+    // The skipped and ignored hits already added to that location.
+    uint64_t reported_hits = 0;
+    uint32_t reported_ignored = 0;
+  };
+  std::map<lldb::user_id_t, BreakpointSiteStopState> m_bp_site_stop_states;
+
+  const AgentExpression *CompileBreakpointCondition(BreakpointLocation &loc,
+                                                    const char *condition);
+
+  //------------------------------------------------------------------
+  /// Get what the stub can decide about the hits of \a bp_site by
+  /// itself.
+  ///
+  /// The stub may only skip a hit that every owner would ignore: owners
+  /// need conditions we can compile, and no thread specification.
+  /// Ignore counts and auto-continue are only handed to the stub for a
+  /// site with a single owner, since the stub counts the hits it skips
+  /// for the whole site.
+  //------------------------------------------------------------------
+  GDBStoppointStopOptions GetBreakpointSiteStopOptions(BreakpointSite &bp_site);
+
+  //------------------------------------------------------------------
+  /// Resend the breakpoint sites whose stop options changed since they
+  /// were inserted.
+  //------------------------------------------------------------------
+  void UpdateBreakpointSiteStopOptions();
+
+  //------------------------------------------------------------------
+  /// Fetch the hits the stub skipped for \a bp_site and add them to the
+  /// location that owns it.
+  //------------------------------------------------------------------
+  void SyncBreakpointSiteHitCounts(BreakpointSite &bp_site,
+                                   BreakpointSiteStopState &state);
+
+  void SyncBreakpointHitCounts();
 
   static bool NewThreadNotifyBreakpointHit(void *baton,
                                            StoppointCallbackContext *context,
@@ -18,6 +18,7 @@
 #include "lldb/Target/StopInfo.h"
 #include "lldb/Target/SystemRuntime.h"
 #include "lldb/Target/Target.h"
+#include "lldb/Target/ThreadPlan.h"
 #include "lldb/Target/UnixSignals.h"
 #include "lldb/Target/Unwind.h"
 #include "lldb/Utility/DataExtractor.h"
@@ -262,8 +263,13 @@ void ThreadGDBRemote::WillResume(StateType resume_state) {
     case eStateStepping:
       if (gdb_process->GetUnixSignals()->SignalIsValid(signo))
         gdb_process->m_continue_S_tids.push_back(std::make_pair(tid, signo));
-      else
+      else {
         gdb_process->m_continue_s_tids.push_back(tid);
+        lldb::addr_t range_start, range_end;
+        ThreadPlan *plan = GetCurrentPlan();
+        if (plan && plan->GetStepRange(range_start, range_end))
+          gdb_process->m_step_ranges[tid] = {range_start, range_end};
+      }
       break;
 
     default:
@@ -17,6 +17,7 @@
 
 // C includes
 // C++ includes
+#include <algorithm>
 #include <map>
 
 using namespace lldb_private;
@@ -67,6 +68,7 @@ MinidumpParser::MinidumpParser(
     const lldb::DataBufferSP &data_buf_sp, const MinidumpHeader *header,
     llvm::DenseMap<uint32_t, MinidumpLocationDescriptor> &&directory_map)
     : m_data_sp(data_buf_sp), m_header(header), m_directory_map(directory_map) {
+  ParseMemoryRanges();
 }
 
 llvm::ArrayRef<uint8_t> MinidumpParser::GetData() {
@@ -304,33 +306,24 @@ const MinidumpExceptionStream *MinidumpParser::GetExceptionStream() {
   return MinidumpExceptionStream::Parse(data);
 }
 
-llvm::Optional<minidump::Range>
-MinidumpParser::FindMemoryRange(lldb::addr_t addr) {
+void MinidumpParser::ParseMemoryRanges() {
   llvm::ArrayRef<uint8_t> data = GetStream(MinidumpStreamType::MemoryList);
   llvm::ArrayRef<uint8_t> data64 = GetStream(MinidumpStreamType::Memory64List);
 
-  if (data.empty() && data64.empty())
-    return llvm::None;
-
   if (!data.empty()) {
     llvm::ArrayRef<MinidumpMemoryDescriptor> memory_list =
         MinidumpMemoryDescriptor::ParseMemoryList(data);
 
-    if (memory_list.empty())
-      return llvm::None;
-
     for (const auto &memory_desc : memory_list) {
       const MinidumpLocationDescriptor &loc_desc = memory_desc.memory;
       const lldb::addr_t range_start = memory_desc.start_of_memory_range;
       const size_t range_size = loc_desc.data_size;
 
       if (loc_desc.rva + loc_desc.data_size > GetData().size())
-        return llvm::None;
+        continue;
 
-      if (range_start <= addr && addr < range_start + range_size) {
-        return minidump::Range(range_start,
-                               GetData().slice(loc_desc.rva, range_size));
-      }
+      m_memory_ranges.emplace_back(range_start,
+                                   GetData().slice(loc_desc.rva, range_size));
     }
   }
 
@@ -345,33 +338,68 @@ MinidumpParser::FindMemoryRange(lldb::addr_t addr) {
     std::tie(memory64_list, base_rva) =
         MinidumpMemoryDescriptor64::ParseMemory64List(data64);
 
-    if (memory64_list.empty())
-      return llvm::None;
-
     for (const auto &memory_desc64 : memory64_list) {
       const lldb::addr_t range_start = memory_desc64.start_of_memory_range;
       const size_t range_size = memory_desc64.data_size;
 
+      // The data for all the ranges is laid out contiguously, so once one
+      // range runs off the end of the file all the following ones do too.
       if (base_rva + range_size > GetData().size())
-        return llvm::None;
+        break;
 
-      if (range_start <= addr && addr < range_start + range_size) {
-        return minidump::Range(range_start,
-                               GetData().slice(base_rva, range_size));
-      }
+      m_memory_ranges.emplace_back(range_start,
+                                   GetData().slice(base_rva, range_size));
       base_rva += range_size;
     }
   }
 
-  return llvm::None;
+  // Sort the ranges so they can be binary searched.  The stable sort keeps a
+  // MemoryList range ahead of a Memory64List range with the same start.
+  std::stable_sort(m_memory_ranges.begin(), m_memory_ranges.end(),
+                   [](const Range &lhs, const Range &rhs) {
+                     return lhs.start < rhs.start;
+                   });
+
+  // Ranges can overlap, for example a MemoryList copy of a stack inside a
+  // Memory64List region, so a range can extend past later ones.
+  lldb::addr_t max_end = 0;
+  m_memory_range_max_ends.reserve(m_memory_ranges.size());
+  for (const Range &range : m_memory_ranges) {
+    max_end = std::max(max_end, range.start + range.range_ref.size());
+    m_memory_range_max_ends.push_back(max_end);
+  }
+}
+
+llvm::Optional<minidump::Range>
+MinidumpParser::FindMemoryRange(lldb::addr_t addr) {
+  // Find the first range that starts after addr.  Any of the ranges before
+  // it can contain addr if the ranges overlap, so walk back until no earlier
+  // range reaches past addr.  Of the ranges that contain addr, pick the one
+  // that extends furthest, so that reads get as much as possible.
+  auto pos = std::upper_bound(m_memory_ranges.begin(), m_memory_ranges.end(),
+                              addr, [](lldb::addr_t addr, const Range &range) {
+                                return addr < range.start;
+                              });
+  size_t best = m_memory_ranges.size();
+  lldb::addr_t best_end = addr;
+  for (size_t i = pos - m_memory_ranges.begin(); i > 0; --i) {
+    if (m_memory_range_max_ends[i - 1] <= best_end)
+      break;
+    const Range &range = m_memory_ranges[i - 1];
+    const lldb::addr_t end = range.start + range.range_ref.size();
+    if (end > best_end) {
+      best = i - 1;
+      best_end = end;
+    }
+  }
+
+  if (best == m_memory_ranges.size())
+    return llvm::None;
+  return m_memory_ranges[best];
 }
 
 llvm::ArrayRef<uint8_t> MinidumpParser::GetMemory(lldb::addr_t addr,
                                                   size_t size) {
-  // I don't have a sense of how frequently this is called or how many memory
-  // ranges a Minidump typically has, so I'm not sure if searching for the
-  // appropriate range linearly each time is stupid.  Perhaps we should build
-  // an index for faster lookups.
   llvm::Optional<minidump::Range> range = FindMemoryRange(addr);
   if (!range)
     return {};
@@ -389,12 +417,55 @@ llvm::ArrayRef<uint8_t> MinidumpParser::GetMemory(lldb::addr_t addr,
   return range->range_ref.slice(offset, overlap);
 }
 
+llvm::Optional<MemoryRegionInfo>
+MinidumpParser::GetMemoryRegionInfoFromMemoryRanges(lldb::addr_t load_addr) {
+  if (m_memory_ranges.empty())
+    return llvm::None;
+
+  MemoryRegionInfo info;
+  const auto yes = MemoryRegionInfo::eYes;
+  const auto dont_know = MemoryRegionInfo::eDontKnow;
+
+  llvm::Optional<minidump::Range> range = FindMemoryRange(load_addr);
+  if (range) {
+    // The memory lists don't record permissions, but the memory was readable
+    // when the dump was taken.
+    info.GetRange().SetRangeBase(range->start);
+    info.GetRange().SetRangeEnd(range->start + range->range_ref.size());
+    info.SetReadable(yes);
+    info.SetWritable(dont_know);
+    info.SetExecutable(dont_know);
+    info.SetMapped(yes);
+    return info;
+  }
+
+  // The memory lists usually leave out code and other pages that can be
+  // read back from the modules, so a gap doesn't mean the memory wasn't
+  // mapped. Describe it as unknown up to the next range or
+  // LLDB_INVALID_ADDRESS.
+  auto next = std::upper_bound(m_memory_ranges.begin(), m_memory_ranges.end(),
+                               load_addr,
+                               [](lldb::addr_t addr, const Range &range) {
+                                 return addr < range.start;
+                               });
+  info.GetRange().SetRangeBase(load_addr);
+  info.GetRange().SetRangeEnd(next != m_memory_ranges.end()
+                                  ? next->start
+                                  : LLDB_INVALID_ADDRESS);
+  info.SetReadable(dont_know);
+  info.SetWritable(dont_know);
+  info.SetExecutable(dont_know);
+  info.SetMapped(dont_know);
+  return info;
+}
+
 llvm::Optional<MemoryRegionInfo>
 MinidumpParser::GetMemoryRegionInfo(lldb::addr_t load_addr) {
   MemoryRegionInfo info;
   llvm::ArrayRef<uint8_t> data = GetStream(MinidumpStreamType::MemoryInfoList);
+  // Without a MemoryInfoList, describe the captured memory ranges instead.
   if (data.empty())
-    return llvm::None;
+    return GetMemoryRegionInfoFromMemoryRanges(load_addr);
 
   std::vector<const MinidumpMemoryInfo *> mem_info_list =
       MinidumpMemoryInfo::ParseMemoryInfoList(data);
@@ -29,6 +29,7 @@
 // C++ includes
 #include <cstring>
 #include <unordered_map>
+#include <vector>
 
 namespace lldb_private {
 
@@ -85,12 +86,25 @@ public:
 
   llvm::ArrayRef<uint8_t> GetMemory(lldb::addr_t addr, size_t size);
 
+  // All the memory ranges captured in the MemoryList and Memory64List
+  // streams, sorted by start address.
+  llvm::ArrayRef<Range> GetMemoryRanges() { return m_memory_ranges; }
+
   llvm::Optional<MemoryRegionInfo> GetMemoryRegionInfo(lldb::addr_t);
 
 private:
+  void ParseMemoryRanges();
+
+  llvm::Optional<MemoryRegionInfo>
+  GetMemoryRegionInfoFromMemoryRanges(lldb::addr_t load_addr);
+
   lldb::DataBufferSP m_data_sp;
   const MinidumpHeader *m_header;
   llvm::DenseMap<uint32_t, MinidumpLocationDescriptor> m_directory_map;
+  std::vector<Range> m_memory_ranges;
+  // The highest end address of m_memory_ranges[0] through [i], so that
+  // FindMemoryRange knows when no earlier range can contain an address.
+  std::vector<lldb::addr_t> m_memory_range_max_ends;
 
   MinidumpParser(
       const lldb::DataBufferSP &data_buf_sp, const MinidumpHeader *header,
@@ -178,15 +178,11 @@ bool DWARFCallFrameInfo::GetAddressRange(Address addr, AddressRange &range) {
       module_sp->GetObjectFile() != &m_objfile)
     return false;
 
-  if (m_section_sp.get() == nullptr || m_section_sp->IsEncrypted())
-    return false;
-  GetFDEIndex();
-  FDEEntryMap::Entry *fde_entry =
-      m_fde_index.FindEntryThatContains(addr.GetFileAddress());
-  if (!fde_entry)
+  FDEEntryMap::Entry fde_entry;
+  if (!GetFDEEntryByFileAddress(addr.GetFileAddress(), fde_entry))
     return false;
 
-  range = AddressRange(fde_entry->base, fde_entry->size,
+  range = AddressRange(fde_entry.base, fde_entry.size,
                        m_objfile.GetSectionList());
   return true;
 }
@@ -196,6 +192,12 @@ bool DWARFCallFrameInfo::GetFDEEntryByFileAddress(
   if (m_section_sp.get() == nullptr || m_section_sp->IsEncrypted())
     return false;
 
+  // If the section hasn't been indexed yet and the .eh_frame_hdr has a
+  // binary search table, use that instead of scanning every FDE.  The table
+  // covers every FDE in the section, so a miss is authoritative.
+  if (!m_fde_index_initialized && HasEHFrameHdrTable())
+    return GetFDEEntryFromEHFrameHdr(file_addr, fde_entry);
+
   GetFDEIndex();
 
   if (m_fde_index.IsEmpty())
@@ -230,6 +232,7 @@ void DWARFCallFrameInfo::GetFunctionAddressAndSizeVector(
 
 const DWARFCallFrameInfo::CIE *
 DWARFCallFrameInfo::GetCIE(dw_offset_t cie_offset) {
+  std::lock_guard<std::mutex> guard(m_cie_map_mutex);
   cie_map_t::iterator pos = m_cie_map.find(cie_offset);
 
   if (pos != m_cie_map.end()) {
@@ -239,7 +242,30 @@ DWARFCallFrameInfo::GetCIE(dw_offset_t cie_offset) {
 
     return pos->second.get();
   }
-  return nullptr;
+
+  // CIEs are noted as the FDE index is built.  FDEs found through the
+  // .eh_frame_hdr table may refer to CIEs we haven't seen yet, so parse
+  // those on demand, but only if there really is a CIE at this offset.
+  if (m_cfi_data_initialized == false)
+    GetCFIData();
+  lldb::offset_t offset = cie_offset;
+  if (!m_cfi_data.ValidOffsetForDataOfSize(offset, CFI_HEADER_SIZE))
+    return nullptr;
+  dw_offset_t cie_id;
+  uint32_t length = m_cfi_data.GetU32(&offset);
+  if (length == UINT32_MAX) {
+    length = m_cfi_data.GetU64(&offset);
+    cie_id = m_cfi_data.GetU64(&offset);
+  } else {
+    cie_id = m_cfi_data.GetU32(&offset);
+  }
+  if (length == 0 || !((m_type == DWARF && cie_id == UINT32_MAX) ||
+                       (m_type == EH && cie_id == 0ul)))
+    return nullptr;
+
+  CIESP cie_sp = ParseCIE(cie_offset);
+  m_cie_map[cie_offset] = cie_sp;
+  return cie_sp.get();
 }
 
 DWARFCallFrameInfo::CIESP
@@ -410,6 +436,17 @@ void DWARFCallFrameInfo::GetCFIData() {
     m_cfi_data_initialized = true;
   }
 }
+// ARM/Thumb FDEs may have the Thumb bit set in their start addresses.
+static bool ShouldClearAddressZerothBit(ObjectFile &objfile) {
+  ArchSpec arch;
+  if (objfile.GetArchitecture(arch)) {
+    if (arch.GetTriple().getArch() == llvm::Triple::arm ||
+        arch.GetTriple().getArch() == llvm::Triple::thumb)
+      return true;
+  }
+  return false;
+}
+
 // Scan through the eh_frame or debug_frame section looking for FDEs and noting
 // the start/end addresses
 // of the functions and a pointer back to the function's FDE for later
@@ -432,13 +469,7 @@ void DWARFCallFrameInfo::GetFDEIndex() {
   Timer scoped_timer(func_cat, "%s - %s", LLVM_PRETTY_FUNCTION,
                      m_objfile.GetFileSpec().GetFilename().AsCString(""));
 
-  bool clear_address_zeroth_bit = false;
-  ArchSpec arch;
-  if (m_objfile.GetArchitecture(arch)) {
-    if (arch.GetTriple().getArch() == llvm::Triple::arm ||
-        arch.GetTriple().getArch() == llvm::Triple::thumb)
-      clear_address_zeroth_bit = true;
-  }
+  const bool clear_address_zeroth_bit = ShouldClearAddressZerothBit(m_objfile);
 
   lldb::offset_t offset = 0;
   if (m_cfi_data_initialized == false)
@@ -484,7 +515,10 @@ void DWARFCallFrameInfo::GetFDEIndex() {
         return;
       }
 
-      m_cie_map[current_entry] = std::move(cie_sp);
+      {
+        std::lock_guard<std::mutex> cie_guard(m_cie_map_mutex);
+        m_cie_map[current_entry] = std::move(cie_sp);
+      }
       offset = next_entry;
       continue;
     }
@@ -533,6 +567,154 @@ void DWARFCallFrameInfo::GetFDEIndex() {
   m_fde_index_initialized = true;
 }
 
+// Read the .eh_frame_hdr section.  Its header is followed by a table of
+// (initial location, FDE address) pairs sorted by initial location, which
+// lets us find the FDE for an address with a binary search.  We only use the
+// table when its entries have the fixed size encoding that the linkers emit
+// (DW_EH_PE_datarel | DW_EH_PE_sdata4) and it describes our eh_frame section.
+
+bool DWARFCallFrameInfo::HasEHFrameHdrTable() {
+  std::lock_guard<std::mutex> guard(m_fde_index_mutex);
+
+  if (m_eh_frame_hdr_initialized)
+    return m_eh_frame_hdr_fde_count > 0;
+  m_eh_frame_hdr_initialized = true;
+
+  if (m_type != EH || m_eh_frame_hdr_sp.get() == nullptr ||
+      m_eh_frame_hdr_sp->IsEncrypted())
+    return false;
+
+  m_objfile.ReadSectionData(m_eh_frame_hdr_sp.get(), m_eh_frame_hdr_data);
+
+  lldb::offset_t offset = 0;
+  if (!m_eh_frame_hdr_data.ValidOffsetForDataOfSize(offset, 4))
+    return false;
+  const uint8_t version = m_eh_frame_hdr_data.GetU8(&offset);
+  const uint8_t eh_frame_ptr_enc = m_eh_frame_hdr_data.GetU8(&offset);
+  const uint8_t fde_count_enc = m_eh_frame_hdr_data.GetU8(&offset);
+  const uint8_t table_enc = m_eh_frame_hdr_data.GetU8(&offset);
+  if (version != 1 || eh_frame_ptr_enc == DW_EH_PE_omit ||
+      fde_count_enc == DW_EH_PE_omit ||
+      table_enc != (DW_EH_PE_datarel | DW_EH_PE_sdata4))
+    return false;
+
+  const lldb::addr_t hdr_addr = m_eh_frame_hdr_sp->GetFileAddress();
+  const lldb::addr_t eh_frame_ptr =
+      GetGNUEHPointer(m_eh_frame_hdr_data, &offset, eh_frame_ptr_enc, hdr_addr,
+                      LLDB_INVALID_ADDRESS, hdr_addr);
+  if (eh_frame_ptr != m_section_sp->GetFileAddress())
+    return false;
+
+  const uint64_t fde_count =
+      GetGNUEHPointer(m_eh_frame_hdr_data, &offset, fde_count_enc, hdr_addr,
+                      LLDB_INVALID_ADDRESS, hdr_addr);
+  if (fde_count == 0 || fde_count > UINT32_MAX ||
+      !m_eh_frame_hdr_data.ValidOffsetForDataOfSize(offset, fde_count * 8))
+    return false;
+
+  m_eh_frame_hdr_table_offset = offset;
+  m_eh_frame_hdr_fde_count = fde_count;
+  return true;
+}
+
+bool DWARFCallFrameInfo::GetFDEEntryFromEHFrameHdr(
+    addr_t file_addr, FDEEntryMap::Entry &fde_entry) {
+  std::lock_guard<std::mutex> guard(m_fde_index_mutex);
+
+  if (m_eh_frame_hdr_fde_count == 0)
+    return false;
+
+  const bool clear_address_zeroth_bit = ShouldClearAddressZerothBit(m_objfile);
+  const lldb::addr_t hdr_addr = m_eh_frame_hdr_sp->GetFileAddress();
+
+  // Find the last entry whose initial location is <= file_addr.
+  uint32_t low = 0;
+  uint32_t high = m_eh_frame_hdr_fde_count;
+  while (low < high) {
+    const uint32_t mid = low + (high - low) / 2;
+    lldb::offset_t offset = m_eh_frame_hdr_table_offset + mid * 8ull;
+    lldb::addr_t initial_loc =
+        hdr_addr + (int32_t)m_eh_frame_hdr_data.GetU32(&offset);
+    if (clear_address_zeroth_bit)
+      initial_loc &= ~1ull;
+    if (initial_loc <= file_addr)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  if (low == 0)
+    return false;
+
+  lldb::offset_t offset = m_eh_frame_hdr_table_offset + (low - 1) * 8ull + 4;
+  const lldb::addr_t fde_addr =
+      hdr_addr + (int32_t)m_eh_frame_hdr_data.GetU32(&offset);
+  const lldb::addr_t eh_frame_addr = m_section_sp->GetFileAddress();
+  if (fde_addr < eh_frame_addr)
+    return false;
+
+  FDEEntryMap::Entry fde;
+  if (!ParseFDEAddressRange(fde_addr - eh_frame_addr, clear_address_zeroth_bit,
+                            fde) ||
+      !fde.Contains(file_addr))
+    return false;
+
+  fde_entry = fde;
+  return true;
+}
+
+bool DWARFCallFrameInfo::ParseFDEAddressRange(dw_offset_t fde_offset,
+                                              bool clear_address_zeroth_bit,
+                                              FDEEntryMap::Entry &fde_entry) {
+  if (m_cfi_data_initialized == false)
+    GetCFIData();
+
+  lldb::offset_t offset = fde_offset;
+  if (!m_cfi_data.ValidOffsetForDataOfSize(offset, CFI_HEADER_SIZE))
+    return false;
+
+  const dw_offset_t current_entry = offset;
+  dw_offset_t cie_id, cie_offset;
+  uint32_t len = m_cfi_data.GetU32(&offset);
+  bool is_64bit = (len == UINT32_MAX);
+  if (is_64bit) {
+    len = m_cfi_data.GetU64(&offset);
+    cie_id = m_cfi_data.GetU64(&offset);
+    cie_offset = current_entry + 12 - cie_id;
+  } else {
+    cie_id = m_cfi_data.GetU32(&offset);
+    cie_offset = current_entry + 4 - cie_id;
+  }
+
+  // This is a CIE (or a terminator), not an FDE.
+  if ((cie_id == 0 && m_type == EH) || cie_id == UINT32_MAX || len == 0)
+    return false;
+
+  if (m_type == DWARF)
+    cie_offset = cie_id;
+
+  if (cie_offset > m_cfi_data.GetByteSize())
+    return false;
+
+  const CIE *cie = GetCIE(cie_offset);
+  if (!cie)
+    return false;
+
+  const lldb::addr_t pc_rel_addr = m_section_sp->GetFileAddress();
+  const lldb::addr_t text_addr = LLDB_INVALID_ADDRESS;
+  const lldb::addr_t data_addr = LLDB_INVALID_ADDRESS;
+
+  lldb::addr_t addr = GetGNUEHPointer(m_cfi_data, &offset, cie->ptr_encoding,
+                                      pc_rel_addr, text_addr, data_addr);
+  if (clear_address_zeroth_bit)
+    addr &= ~1ull;
+
+  lldb::addr_t length = GetGNUEHPointer(
+      m_cfi_data, &offset, cie->ptr_encoding & DW_EH_PE_MASK_ENCODING,
+      pc_rel_addr, text_addr, data_addr);
+  fde_entry = FDEEntryMap::Entry(addr, length, current_entry);
+  return true;
+}
+
 bool DWARFCallFrameInfo::FDEToUnwindPlan(dw_offset_t dwarf_offset,
                                          Address startaddr,
                                          UnwindPlan &unwind_plan) {
@@ -54,6 +54,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -102,6 +103,7 @@
 #include "lldb/Utility/FileSpec.h"
 #include "lldb/Utility/LLDBAssert.h"
 #include "lldb/Utility/Log.h"
+#include "lldb/Utility/TaskPool.h"
 
 #include "Plugins/Platform/MacOSX/PlatformDarwin.h"
 #include "Plugins/SymbolFile/DWARF/DWARFASTParserSwift.h"
@@ -1089,6 +1091,27 @@ static bool IsDeviceSupport(const char *path) {
 }
 }
 
+// Return the directory the ClangImporter should build its modules in, or an
+// empty string to use Clang's default cache, which is private to the user.
+// Clang names the modules in the cache by a hash of their configuration, so
+// one directory can be shared by all the contexts, and by later sessions
+// which then don't build the modules again.
+static std::string GetClangModuleCachePath(Target *target) {
+  FileSpec module_cache;
+  if (target)
+    module_cache = target->GetModuleCachePath();
+  else if (TargetPropertiesSP properties_sp = Target::GetGlobalProperties())
+    module_cache = properties_sp->GetModuleCachePath();
+
+  if (!module_cache)
+    return std::string();
+
+  std::string module_cache_path = module_cache.GetPath();
+  if (llvm::sys::fs::create_directories(module_cache_path))
+    return std::string();
+  return module_cache_path;
+}
+
 SwiftASTContext::SwiftASTContext(const char *triple, Target *target)
     : TypeSystem(TypeSystem::eKindSwift), m_source_manager_ap(),
       m_diagnostic_engine_ap(), m_ast_context_ap(), m_ir_gen_module_ap(),
@@ -1104,17 +1127,11 @@ SwiftASTContext::SwiftASTContext(const char *triple, Target *target)
       m_initialized_clang_importer_options(false),
       m_reported_fatal_error(false), m_fatal_errors(), m_negative_type_cache(),
       m_extra_type_info_cache(), m_swift_type_map() {
-  // Set the module-cache path if it has been specified:
-  if (target) {
-    FileSpec &module_cache = target->GetModuleCachePath();
-    if (module_cache && module_cache.Exists()) {
-
-      std::string module_cache_path = module_cache.GetPath();
-      llvm::StringRef module_cache_ref(module_cache_path);
-      m_compiler_invocation_ap->setClangModuleCachePath(module_cache_ref);
-    }
+  std::string module_cache_path = GetClangModuleCachePath(target);
+  if (!module_cache_path.empty())
+    m_compiler_invocation_ap->setClangModuleCachePath(module_cache_path);
+  if (target)
     m_target_wp = target->shared_from_this();
-  }
 
   if (triple)
     SetTriple(triple);
@@ -1547,6 +1564,19 @@ lldb::TypeSystemSP SwiftASTContext::CreateInstance(lldb::LanguageType language,
         handled_sdk_path = true;
       }
 
+      // Creating the SwiftASTContext of an image deserializes its Swift
+      // modules and builds the Clang modules they import. Each of those
+      // contexts has its own swift::ASTContext and is only created under its
+      // module's lock, so create them all at once rather than one by one in
+      // the loops below.
+      if (target->GetParallelSwiftModuleLoad(nullptr)) {
+        TaskMapOverInt(0, num_images, [target](size_t mi) {
+          ModuleSP module_sp = target->GetImages().GetModuleAtIndex(mi);
+          if (module_sp)
+            module_sp->GetTypeSystemForLanguage(lldb::eLanguageTypeSwift);
+        });
+      }
+
       Status module_error;
       for (size_t mi = 0; mi != num_images; ++mi) {
         ModuleSP module_sp = target->GetImages().GetModuleAtIndex(mi);
@@ -3545,6 +3575,14 @@ void SwiftASTContext::LoadModule(swift::ModuleDecl *swift_module,
                                  Process &process, Status &error) {
   VALID_OR_RETURN_VOID();
 
+  // Every expression imports the modules of its compile unit again. Once
+  // the link libraries of a module are loaded they stay loaded, so don't
+  // walk its imports and search the target's images for them each time.
+  SwiftLanguageRuntime *swift_runtime = process.GetSwiftLanguageRuntime();
+  std::string module_name = swift_module->getName().str().str();
+  if (swift_runtime && swift_runtime->IsInLinkedModuleCache(module_name))
+    return;
+
   Status current_error;
   auto addLinkLibrary = [&](swift::LinkLibrary link_lib) {
     Status load_image_error;
@@ -3720,6 +3758,8 @@ void SwiftASTContext::LoadModule(swift::ModuleDecl *swift_module,
                                            addLinkLibrary);
                                      });
   error = current_error;
+  if (swift_runtime && error.Success())
+    swift_runtime->AddToLinkedModuleCache(module_name);
 }
 
 bool SwiftASTContext::LoadLibraryUsingPaths(
@@ -54,6 +54,11 @@ void UnwindTable::Initialize() {
   if (sect.get()) {
     m_eh_frame_up.reset(
         new DWARFCallFrameInfo(m_object_file, sect, DWARFCallFrameInfo::EH));
+
+    static ConstString g_sect_name_eh_frame_hdr(".eh_frame_hdr");
+    SectionSP hdr_sect = sl->FindSectionByName(g_sect_name_eh_frame_hdr);
+    if (hdr_sect)
+      m_eh_frame_up->SetEHFrameHdrSection(hdr_sect);
   }
 
   sect = sl->FindSectionByType(eSectionTypeDWARFDebugFrame, true);
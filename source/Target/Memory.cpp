@@ -11,6 +11,7 @@
 // C Includes
 #include <inttypes.h>
 // C++ Includes
+#include <algorithm>
 // Other libraries and framework includes
 // Project includes
 #include "lldb/Core/RangeMap.h"
@@ -343,16 +344,33 @@ void AllocatedMemoryCache::Clear() {
   m_memory_map.clear();
 }
 
+// Every block costs an allocation in the inferior, which usually means
+// running a function in it, so grow the cache by at least this much at a
+// time. Expressions allocate many small, short lived buffers, and this lets
+// a tight evaluation loop reuse one block instead of asking for a page per
+// allocation.
+static const size_t g_min_allocated_block_size = 64 * 1024;
+
 AllocatedMemoryCache::AllocatedBlockSP
 AllocatedMemoryCache::AllocatePage(uint32_t byte_size, uint32_t permissions,
                                    uint32_t chunk_size, Status &error) {
   AllocatedBlockSP block_sp;
   const size_t page_size = 4096;
   const size_t num_pages = (byte_size + page_size - 1) / page_size;
-  const size_t page_byte_size = num_pages * page_size;
+  const size_t needed_byte_size = num_pages * page_size;
+  size_t page_byte_size =
+      std::max<size_t>(needed_byte_size, g_min_allocated_block_size);
 
   addr_t addr = m_process.DoAllocateMemory(page_byte_size, permissions, error);
 
+  // Fall back to just the pages we need if the inferior can't give us a
+  // whole block.
+  if (addr == LLDB_INVALID_ADDRESS && page_byte_size > needed_byte_size) {
+    error.Clear();
+    page_byte_size = needed_byte_size;
+    addr = m_process.DoAllocateMemory(page_byte_size, permissions, error);
+  }
+
   Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_PROCESS));
   if (log) {
     log->Printf("Process::DoAllocateMemory (byte_size = 0x%8.8" PRIx32
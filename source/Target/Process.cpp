@@ -21,10 +21,13 @@
 #include "lldb/Breakpoint/BreakpointLocation.h"
 #include "lldb/Breakpoint/StoppointCallbackContext.h"
 #include "lldb/Core/Debugger.h"
+#include "lldb/Core/Disassembler.h"
+#include "lldb/Core/EmulateInstruction.h"
 #include "lldb/Core/Event.h"
 #include "lldb/Core/Module.h"
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Core/PluginManager.h"
+#include "lldb/Core/RegisterValue.h"
 #include "lldb/Core/State.h"
 #include "lldb/Core/StreamFile.h"
 #include "lldb/Expression/DiagnosticManager.h"
@@ -148,6 +151,12 @@ static PropertyDefinition g_properties[] = {
     {"stop-on-exec", OptionValue::eTypeBoolean, true, true,
      nullptr, nullptr,
      "If true, stop when a shared library is loaded or unloaded."},
+    {"displaced-stepping", OptionValue::eTypeBoolean, true, true, nullptr,
+     nullptr, "If true, step threads over breakpoints by running a copy of "
+              "the instruction under the breakpoint from another address, so "
+              "the other threads can keep running.  Instructions whose "
+              "behavior depends on their address are still stepped in "
+              "place."},
     {nullptr, OptionValue::eTypeInvalid, false, 0, nullptr, nullptr, nullptr}};
 
 enum {
@@ -160,7 +169,8 @@ enum {
   ePropertyDetachKeepsStopped,
   ePropertyMemCacheLineSize,
   ePropertyWarningOptimization,
-  ePropertyStopOnExec
+  ePropertyStopOnExec,
+  ePropertyDisplacedStepping
 };
 
 ProcessProperties::ProcessProperties(lldb_private::Process *process)
@@ -283,6 +293,12 @@ bool ProcessProperties::GetStopOnExec() const {
       nullptr, idx, g_properties[idx].default_uint_value != 0);
 }
 
+bool ProcessProperties::GetDisplacedStepping() const {
+  const uint32_t idx = ePropertyDisplacedStepping;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_properties[idx].default_uint_value != 0);
+}
+
 void ProcessInstanceInfo::Dump(Stream &s, Platform *platform) const {
   const char *cstr;
   if (m_pid != LLDB_INVALID_PROCESS_ID)
@@ -753,8 +769,9 @@ Process::Process(lldb::TargetSP target_sp, ListenerSP listener_sp,
       m_stdin_forward(false), m_stdout_data(), m_stderr_data(),
       m_profile_data_comm_mutex(), m_profile_data(), m_iohandler_sync(0),
       m_memory_cache(*this), m_allocated_memory_cache(*this),
-      m_should_detach(false), m_next_event_action_ap(), m_public_run_lock(),
-      m_private_run_lock(), m_stop_info_override_callback(nullptr),
+      m_displaced_step_memory_allocated(false), m_should_detach(false),
+      m_next_event_action_ap(), m_public_run_lock(), m_private_run_lock(),
+      m_stop_info_override_callback(nullptr),
       m_finalizing(false), m_finalize_called(false),
       m_clear_thread_plans_on_stop(false), m_force_next_event_delivery(false),
       m_destroy_in_process(false), m_destroy_complete(false),
@@ -1956,8 +1973,12 @@ void Process::DisableAllBreakpointSites() {
 Status Process::ClearBreakpointSiteByID(lldb::user_id_t break_id) {
   Status error(DisableBreakpointSiteByID(break_id));
 
-  if (error.Success())
+  if (error.Success()) {
+    BreakpointSiteSP bp_site_sp = m_breakpoint_site_list.FindByID(break_id);
+    if (bp_site_sp)
+      ReleaseDisplacedStepCopy(bp_site_sp->GetLoadAddress());
     m_breakpoint_site_list.Remove(break_id);
+  }
 
   return error;
 }
@@ -1989,12 +2010,7 @@ Status Process::EnableBreakpointSiteByID(lldb::user_id_t break_id) {
   return error;
 }
 
-lldb::break_id_t
-Process::CreateBreakpointSite(const BreakpointLocationSP &owner,
-                              bool use_hardware) {
-  addr_t load_addr = LLDB_INVALID_ADDRESS;
-
-  bool show_error = true;
+bool Process::ShouldReportBreakpointSiteErrors() {
   switch (GetState()) {
   case eStateInvalid:
   case eStateUnloaded:
@@ -2003,17 +2019,21 @@ Process::CreateBreakpointSite(const BreakpointLocationSP &owner,
   case eStateLaunching:
   case eStateDetached:
   case eStateExited:
-    show_error = false;
-    break;
+    return false;
 
   case eStateStopped:
   case eStateRunning:
   case eStateStepping:
   case eStateCrashed:
   case eStateSuspended:
-    show_error = IsAlive();
-    break;
+    return IsAlive();
   }
+  return true;
+}
+
+addr_t Process::GetBreakpointSiteLoadAddress(const BreakpointLocationSP &owner,
+                                             bool show_error) {
+  addr_t load_addr = LLDB_INVALID_ADDRESS;
 
   // Reset the IsIndirect flag here, in case the location changes from
   // pointing to a indirect symbol to a regular symbol.
@@ -2032,7 +2052,7 @@ Process::CreateBreakpointSite(const BreakpointLocationSP &owner,
             symbol->GetLoadAddress(&GetTarget()),
             owner->GetBreakpoint().GetID(), owner->GetID(),
             error.AsCString() ? error.AsCString() : "unknown error");
-        return LLDB_INVALID_BREAK_ID;
+        return LLDB_INVALID_ADDRESS;
       }
       Address resolved_address(load_addr);
       load_addr = resolved_address.GetOpcodeLoadAddress(&GetTarget());
@@ -2042,6 +2062,15 @@ Process::CreateBreakpointSite(const BreakpointLocationSP &owner,
   } else
     load_addr = owner->GetAddress().GetOpcodeLoadAddress(&GetTarget());
 
+  return load_addr;
+}
+
+lldb::break_id_t
+Process::CreateBreakpointSite(const BreakpointLocationSP &owner,
+                              bool use_hardware) {
+  const bool show_error = ShouldReportBreakpointSiteErrors();
+  addr_t load_addr = GetBreakpointSiteLoadAddress(owner, show_error);
+
   if (load_addr != LLDB_INVALID_ADDRESS) {
     BreakpointSiteSP bp_site_sp;
 
@@ -2080,6 +2109,65 @@ Process::CreateBreakpointSite(const BreakpointLocationSP &owner,
   return LLDB_INVALID_BREAK_ID;
 }
 
+void Process::CreateBreakpointSites(
+    llvm::ArrayRef<BreakpointLocationSP> owners) {
+  const bool show_error = ShouldReportBreakpointSiteErrors();
+
+  // Owners of existing sites are added right away, the new sites are only
+  // added to the site list once they have been enabled.
+  std::map<addr_t, BreakpointSiteSP> new_sites;
+  for (const BreakpointLocationSP &owner : owners) {
+    addr_t load_addr = GetBreakpointSiteLoadAddress(owner, show_error);
+    if (load_addr == LLDB_INVALID_ADDRESS)
+      continue;
+
+    BreakpointSiteSP bp_site_sp =
+        m_breakpoint_site_list.FindByAddress(load_addr);
+    if (bp_site_sp) {
+      bp_site_sp->AddOwner(owner);
+      owner->SetBreakpointSite(bp_site_sp);
+      continue;
+    }
+
+    BreakpointSiteSP &new_site_sp = new_sites[load_addr];
+    if (new_site_sp)
+      new_site_sp->AddOwner(owner);
+    else
+      new_site_sp.reset(
+          new BreakpointSite(&m_breakpoint_site_list, owner, load_addr,
+                             owner->GetBreakpoint().IsHardware()));
+  }
+  if (new_sites.empty())
+    return;
+
+  std::vector<BreakpointSite *> bp_sites;
+  for (const auto &entry : new_sites)
+    bp_sites.push_back(entry.second.get());
+  std::vector<Status> errors;
+  EnableBreakpointSites(bp_sites, errors);
+
+  size_t i = 0;
+  for (const auto &entry : new_sites) {
+    BreakpointSiteSP bp_site_sp = entry.second;
+    const Status &error = errors[i++];
+    const size_t num_owners = bp_site_sp->GetNumberOfOwners();
+    if (error.Success()) {
+      m_breakpoint_site_list.Add(bp_site_sp);
+      for (size_t j = 0; j < num_owners; ++j)
+        bp_site_sp->GetOwnerAtIndex(j)->SetBreakpointSite(bp_site_sp);
+    } else if (show_error) {
+      for (size_t j = 0; j < num_owners; ++j) {
+        BreakpointLocationSP owner = bp_site_sp->GetOwnerAtIndex(j);
+        GetTarget().GetDebugger().GetErrorFile()->Printf(
+            "warning: failed to set breakpoint site at 0x%" PRIx64
+            " for breakpoint %i.%i: %s\n",
+            entry.first, owner->GetBreakpoint().GetID(), owner->GetID(),
+            error.AsCString() ? error.AsCString() : "unknown error");
+      }
+    }
+  }
+}
+
 void Process::RemoveOwnerFromBreakpointSite(lldb::user_id_t owner_id,
                                             lldb::user_id_t owner_loc_id,
                                             BreakpointSiteSP &bp_site_sp) {
@@ -2088,37 +2176,77 @@ void Process::RemoveOwnerFromBreakpointSite(lldb::user_id_t owner_id,
     // Don't try to disable the site if we don't have a live process anymore.
     if (IsAlive())
       DisableBreakpointSite(bp_site_sp.get());
+    ReleaseDisplacedStepCopy(bp_site_sp->GetLoadAddress());
+    m_breakpoint_site_list.RemoveByAddress(bp_site_sp->GetLoadAddress());
+  }
+}
+
+void Process::RemoveOwnersFromBreakpointSites(
+    llvm::ArrayRef<BreakpointLocationSP> owners) {
+  std::vector<BreakpointSiteSP> unowned_sites;
+  for (const BreakpointLocationSP &owner : owners) {
+    BreakpointSiteSP bp_site_sp;
+    bp_site_sp.swap(owner->m_bp_site_sp);
+    if (bp_site_sp &&
+        bp_site_sp->RemoveOwner(owner->GetBreakpoint().GetID(),
+                                owner->GetID()) == 0)
+      unowned_sites.push_back(bp_site_sp);
+  }
+  if (unowned_sites.empty())
+    return;
+
+  // Don't try to disable the sites if we don't have a live process anymore.
+  if (IsAlive()) {
+    std::vector<BreakpointSite *> bp_sites;
+    for (const BreakpointSiteSP &bp_site_sp : unowned_sites)
+      bp_sites.push_back(bp_site_sp.get());
+    std::vector<Status> errors;
+    DisableBreakpointSites(bp_sites, errors);
+  }
+  for (const BreakpointSiteSP &bp_site_sp : unowned_sites) {
+    ReleaseDisplacedStepCopy(bp_site_sp->GetLoadAddress());
     m_breakpoint_site_list.RemoveByAddress(bp_site_sp->GetLoadAddress());
   }
 }
 
+void Process::EnableBreakpointSites(llvm::ArrayRef<BreakpointSite *> bp_sites,
+                                    std::vector<Status> &errors) {
+  errors.clear();
+  for (BreakpointSite *bp_site : bp_sites)
+    errors.push_back(EnableBreakpointSite(bp_site));
+}
+
+void Process::DisableBreakpointSites(llvm::ArrayRef<BreakpointSite *> bp_sites,
+                                     std::vector<Status> &errors) {
+  errors.clear();
+  for (BreakpointSite *bp_site : bp_sites)
+    errors.push_back(DisableBreakpointSite(bp_site));
+}
+
 size_t Process::RemoveBreakpointOpcodesFromBuffer(addr_t bp_addr, size_t size,
                                                   uint8_t *buf) const {
   size_t bytes_removed = 0;
-  BreakpointSiteList bp_sites_in_range;
-
-  if (m_breakpoint_site_list.FindInRange(bp_addr, bp_addr + size,
-                                         bp_sites_in_range)) {
-    bp_sites_in_range.ForEach([bp_addr, size,
-                               buf](BreakpointSite *bp_site) -> void {
-      if (bp_site->GetType() == BreakpointSite::eSoftware) {
-        addr_t intersect_addr;
-        size_t intersect_size;
-        size_t opcode_offset;
-        if (bp_site->IntersectsRange(bp_addr, size, &intersect_addr,
-                                     &intersect_size, &opcode_offset)) {
-          assert(bp_addr <= intersect_addr && intersect_addr < bp_addr + size);
-          assert(bp_addr < intersect_addr + intersect_size &&
-                 intersect_addr + intersect_size <= bp_addr + size);
-          assert(opcode_offset + intersect_size <= bp_site->GetByteSize());
-          size_t buf_offset = intersect_addr - bp_addr;
-          ::memcpy(buf + buf_offset,
-                   bp_site->GetSavedOpcodeBytes() + opcode_offset,
-                   intersect_size);
+
+  m_breakpoint_site_list.ForEachInRange(
+      bp_addr, bp_addr + size, [bp_addr, size, buf](BreakpointSite *bp_site) {
+        if (bp_site->GetType() == BreakpointSite::eSoftware) {
+          addr_t intersect_addr;
+          size_t intersect_size;
+          size_t opcode_offset;
+          if (bp_site->IntersectsRange(bp_addr, size, &intersect_addr,
+                                       &intersect_size, &opcode_offset)) {
+            assert(bp_addr <= intersect_addr &&
+                   intersect_addr < bp_addr + size);
+            assert(bp_addr < intersect_addr + intersect_size &&
+                   intersect_addr + intersect_size <= bp_addr + size);
+            assert(opcode_offset + intersect_size <= bp_site->GetByteSize());
+            size_t buf_offset = intersect_addr - bp_addr;
+            ::memcpy(buf + buf_offset,
+                     bp_site->GetSavedOpcodeBytes() + opcode_offset,
+                     intersect_size);
+          }
         }
-      }
-    });
-  }
+      });
   return bytes_removed;
 }
 
@@ -2555,20 +2683,14 @@ size_t Process::WriteMemory(addr_t addr, const void *buf, size_t size,
   // (enabled software breakpoints) any software traps (breakpoints) that we
   // may have placed in our tasks memory.
 
-  BreakpointSiteList bp_sites_in_range;
-
-  if (m_breakpoint_site_list.FindInRange(addr, addr + size,
-                                         bp_sites_in_range)) {
-    // No breakpoint sites overlap
-    if (bp_sites_in_range.IsEmpty())
-      return WriteMemoryPrivate(addr, buf, size, error);
-    else {
-      const uint8_t *ubuf = (const uint8_t *)buf;
-      uint64_t bytes_written = 0;
-
-      bp_sites_in_range.ForEach([this, addr, size, &bytes_written, &ubuf,
-                                 &error](BreakpointSite *bp) -> void {
+  const uint8_t *ubuf = (const uint8_t *)buf;
+  uint64_t bytes_written = 0;
+  bool found_bp_sites = false;
 
+  m_breakpoint_site_list.ForEachInRange(
+      addr, addr + size, [this, addr, size, &bytes_written, &ubuf, &error,
+                          &found_bp_sites](BreakpointSite *bp) {
+        found_bp_sites = true;
         if (error.Success()) {
           addr_t intersect_addr;
           size_t intersect_size;
@@ -2607,13 +2729,13 @@ size_t Process::WriteMemory(addr_t addr, const void *buf, size_t size,
         }
       });
 
-      if (bytes_written < size)
-        WriteMemoryPrivate(addr + bytes_written, ubuf + bytes_written,
-                           size - bytes_written, error);
-    }
-  } else {
+  // No breakpoint sites overlap
+  if (!found_bp_sites)
     return WriteMemoryPrivate(addr, buf, size, error);
-  }
+
+  if (bytes_written < size)
+    WriteMemoryPrivate(addr + bytes_written, ubuf + bytes_written,
+                       size - bytes_written, error);
 
   // Write any remaining bytes after the last breakpoint if we have any left
   return 0; // bytes_written;
@@ -2699,6 +2821,191 @@ addr_t Process::CallocateMemory(size_t size, uint32_t permissions,
   return return_addr;
 }
 
+// Displaced step copies are made in slots this big, carved out of one
+// allocation of g_displaced_step_memory_size bytes.
+static const size_t g_displaced_step_slot_size = 32;
+static const size_t g_displaced_step_memory_size = 4096;
+
+static size_t ReadMemoryForPCUse(EmulateInstruction *instruction, void *baton,
+                                 const EmulateInstruction::Context &context,
+                                 lldb::addr_t addr, void *dst, size_t length) {
+  // Only which registers the instruction uses matters, not what it computes.
+  ::memset(dst, 0, length);
+  return length;
+}
+
+static size_t WriteMemoryForPCUse(EmulateInstruction *instruction, void *baton,
+                                  const EmulateInstruction::Context &context,
+                                  lldb::addr_t addr, const void *src,
+                                  size_t length) {
+  return length;
+}
+
+static bool ReadRegisterForPCUse(EmulateInstruction *instruction, void *baton,
+                                 const RegisterInfo *reg_info,
+                                 RegisterValue &reg_value) {
+  if (reg_info->kinds[eRegisterKindGeneric] == LLDB_REGNUM_GENERIC_PC)
+    *static_cast<bool *>(baton) = true;
+  reg_value.SetUInt64(0);
+  return true;
+}
+
+static bool WriteRegisterForPCUse(EmulateInstruction *instruction, void *baton,
+                                  const EmulateInstruction::Context &context,
+                                  const RegisterInfo *reg_info,
+                                  const RegisterValue &reg_value) {
+  if (reg_info->kinds[eRegisterKindGeneric] == LLDB_REGNUM_GENERIC_PC)
+    *static_cast<bool *>(baton) = true;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// Returns the size of the instruction at the start of \a bytes if it does
+// the same thing when run from any address, and zero otherwise.
+//----------------------------------------------------------------------
+static uint32_t GetDisplaceableInstructionSize(const ArchSpec &arch,
+                                               lldb::addr_t addr,
+                                               const uint8_t *bytes,
+                                               size_t length) {
+  DisassemblerSP disassembler_sp = Disassembler::DisassembleBytes(
+      arch, nullptr, nullptr, Address(addr), bytes, length, 1, false);
+  if (!disassembler_sp)
+    return 0;
+  InstructionSP inst_sp =
+      disassembler_sp->GetInstructionList().GetInstructionAtIndex(0);
+  if (!inst_sp)
+    return 0;
+
+  const uint32_t size = inst_sp->GetOpcode().GetByteSize();
+  if (size == 0 || size > length)
+    return 0;
+
+  // A branch taken from the copy would land relative to the copy, and a
+  // delay slot would run from the copy too.
+  if (inst_sp->DoesBranch() || inst_sp->HasDelaySlot())
+    return 0;
+
+  switch (arch.GetMachine()) {
+  case llvm::Triple::x86:
+  case llvm::Triple::x86_64: {
+    // Apart from branches, x86 instructions only depend on their address
+    // through %rip relative operands.
+    const char *operands = inst_sp->GetOperands(nullptr);
+    if (!operands || llvm::StringRef(operands).contains("rip"))
+      return 0;
+    return size;
+  }
+
+  case llvm::Triple::aarch64: {
+    // adr, adrp and literal loads read the pc without being branches, so
+    // emulate the instruction to see whether it touches the pc.  The
+    // emulator doesn't know every instruction, and the ones it doesn't know
+    // get stepped in place.
+    bool uses_pc = false;
+    if (!inst_sp->Emulate(arch, eEmulateInstructionOptionIgnoreConditions,
+                          &uses_pc, ReadMemoryForPCUse, WriteMemoryForPCUse,
+                          ReadRegisterForPCUse, WriteRegisterForPCUse))
+      return 0;
+    return uses_pc ? 0 : size;
+  }
+
+  default:
+    return 0;
+  }
+}
+
+void Process::PrepareDisplacedStepCopy(lldb::addr_t addr) {
+  if (!GetDisplacedStepping() ||
+      m_displaced_step_copies.find(addr) != m_displaced_step_copies.end())
+    return;
+
+  Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_STEP));
+
+  if (!m_displaced_step_memory_allocated) {
+    m_displaced_step_memory_allocated = true;
+    // The copies only need to be executable, we write them with
+    // WriteMemory.
+    Status error;
+    lldb::addr_t memory = AllocateMemory(
+        g_displaced_step_memory_size,
+        lldb::ePermissionsReadable | lldb::ePermissionsExecutable, error);
+    if (memory == LLDB_INVALID_ADDRESS) {
+      if (log)
+        log->Printf("Process::%s no memory for displaced stepping: %s",
+                    __FUNCTION__, error.AsCString());
+    } else {
+      for (size_t offset = g_displaced_step_memory_size; offset > 0;
+           offset -= g_displaced_step_slot_size)
+        m_displaced_step_free_slots.push_back(memory + offset -
+                                              g_displaced_step_slot_size);
+    }
+  }
+
+  // Don't remember running out of slots, one may be released later.
+  if (m_displaced_step_free_slots.empty())
+    return;
+
+  DisplacedStepCopy copy = {LLDB_INVALID_ADDRESS, 0};
+  const ArchSpec &arch = GetTarget().GetArchitecture();
+  uint8_t bytes[g_displaced_step_slot_size];
+  size_t length = arch.GetMaximumOpcodeByteSize();
+  if (length == 0 || length > sizeof(bytes))
+    length = sizeof(bytes);
+
+  // ReadMemory hides breakpoint traps, so this reads the original
+  // instruction.
+  Status error;
+  length = ReadMemory(addr, bytes, length, error);
+  const uint32_t inst_size =
+      GetDisplaceableInstructionSize(arch, addr, bytes, length);
+  if (inst_size != 0) {
+    const lldb::addr_t slot = m_displaced_step_free_slots.back();
+    if (WriteMemory(slot, bytes, inst_size, error) == inst_size) {
+      m_displaced_step_free_slots.pop_back();
+      copy.addr = slot;
+      copy.size = inst_size;
+    }
+  }
+
+  if (log) {
+    if (copy.addr == LLDB_INVALID_ADDRESS)
+      log->Printf("Process::%s instruction at 0x%" PRIx64
+                  " can't be displaced",
+                  __FUNCTION__, addr);
+    else
+      log->Printf("Process::%s copied instruction at 0x%" PRIx64
+                  " to 0x%" PRIx64,
+                  __FUNCTION__, addr, copy.addr);
+  }
+
+  m_displaced_step_copies[addr] = copy;
+}
+
+lldb::addr_t Process::GetDisplacedStepCopy(lldb::addr_t addr,
+                                           uint32_t &size) const {
+  size = 0;
+  if (!GetDisplacedStepping())
+    return LLDB_INVALID_ADDRESS;
+
+  auto pos = m_displaced_step_copies.find(addr);
+  if (pos == m_displaced_step_copies.end())
+    return LLDB_INVALID_ADDRESS;
+  size = pos->second.size;
+  return pos->second.addr;
+}
+
+void Process::ReleaseDisplacedStepCopy(lldb::addr_t addr) {
+  auto pos = m_displaced_step_copies.find(addr);
+  if (pos == m_displaced_step_copies.end())
+    return;
+  // A thread that was interrupted before it stepped the copy may still be
+  // sitting in it, so hand this slot out last.
+  if (pos->second.addr != LLDB_INVALID_ADDRESS)
+    m_displaced_step_free_slots.insert(m_displaced_step_free_slots.begin(),
+                                       pos->second.addr);
+  m_displaced_step_copies.erase(pos);
+}
+
 bool Process::CanJIT() {
   if (m_can_jit == eCanJITDontKnow) {
     Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_PROCESS));
@@ -6005,6 +6312,9 @@ void Process::DidExec() {
   m_jit_loaders_ap.reset();
   m_image_tokens.clear();
   m_allocated_memory_cache.Clear();
+  m_displaced_step_copies.clear();
+  m_displaced_step_free_slots.clear();
+  m_displaced_step_memory_allocated = false;
   m_language_runtimes.clear();
   m_instrumentation_runtimes.clear();
   m_thread_list.DiscardThreadPlans();
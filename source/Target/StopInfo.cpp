@@ -548,6 +548,17 @@ protected:
               __FUNCTION__, m_value);
       }
 
+      // Stepping off a user breakpoint may use a copy of its instruction.
+      // Making the first one can run code in the process, which we can do
+      // now but not once the process is being resumed.
+      if (!internal_breakpoint && !HasTargetRunSinceMe()) {
+        ProcessSP process_sp(thread_sp->GetProcess());
+        BreakpointSiteSP site_sp(
+            process_sp->GetBreakpointSiteList().FindByID(m_value));
+        if (site_sp)
+          process_sp->PrepareDisplacedStepCopy(site_sp->GetLoadAddress());
+      }
+
       if ((m_should_stop == false || internal_breakpoint)
           && thread_sp->CompletedPlanOverridesBreakpoint()) {
         
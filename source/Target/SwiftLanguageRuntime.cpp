@@ -3466,6 +3466,16 @@ bool SwiftLanguageRuntime::IsInLibraryNegativeCache(const char *library_name) {
   return m_library_negative_cache.count(library_name) == 1;
 }
 
+void SwiftLanguageRuntime::AddToLinkedModuleCache(llvm::StringRef module_name) {
+  std::lock_guard<std::mutex> locker(m_negative_cache_mutex);
+  m_linked_module_cache.insert(module_name.str());
+}
+
+bool SwiftLanguageRuntime::IsInLinkedModuleCache(llvm::StringRef module_name) {
+  std::lock_guard<std::mutex> locker(m_negative_cache_mutex);
+  return m_linked_module_cache.count(module_name.str()) == 1;
+}
+
 lldb::addr_t
 SwiftLanguageRuntime::MaskMaybeBridgedPointer(lldb::addr_t addr,
                                               lldb::addr_t *masked_bits) {
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 // C Includes
+#include <ctype.h>
 // C++ Includes
 #include <mutex>
 // Other libraries and framework includes
@@ -49,6 +50,7 @@
 #include "lldb/Symbol/Symbol.h"
 #include "lldb/Symbol/SymbolFile.h"
 #include "lldb/Symbol/SymbolVendor.h"
+#include "lldb/Symbol/Variable.h"
 #include "lldb/Target/Language.h"
 #include "lldb/Target/LanguageRuntime.h"
 #include "lldb/Target/ObjCLanguageRuntime.h"
@@ -179,6 +181,7 @@ void Target::DeleteCurrentProcess() {
     m_process_sp->Finalize();
 
     CleanupProcess();
+    ClearUserExpressionCache();
 
     m_process_sp.reset();
   }
@@ -261,6 +264,7 @@ void Target::Destroy() {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
   m_valid = false;
   DeleteCurrentProcess();
+  ClearUserExpressionCache();
   m_platform_sp.reset();
   m_arch.Clear();
   ClearModules(true);
@@ -1386,6 +1390,7 @@ void Target::DidExec() {
   // When a process exec's we need to know about it so we can do some cleanup.
   m_breakpoint_list.RemoveInvalidLocations(m_arch);
   m_internal_breakpoint_list.RemoveInvalidLocations(m_arch);
+  ClearUserExpressionCache();
 }
 
 void Target::SetExecutableModule(ModuleSP &executable_sp,
@@ -1560,6 +1565,19 @@ void Target::ModuleUpdated(const ModuleList &module_list,
   }
 }
 
+// Expressions add and remove the modules holding their own JIT code, which
+// doesn't change how other expressions parse.
+static bool ModuleListIsAllJIT(ModuleList &module_list) {
+  const size_t num_modules = module_list.GetSize();
+  for (size_t i = 0; i < num_modules; ++i) {
+    ModuleSP module_sp(module_list.GetModuleAtIndex(i));
+    ObjectFile *objfile = module_sp ? module_sp->GetObjectFile() : nullptr;
+    if (!objfile || objfile->GetType() != ObjectFile::eTypeJIT)
+      return false;
+  }
+  return true;
+}
+
 void Target::ModulesDidLoad(ModuleList &module_list) {
   if (m_valid && module_list.GetSize()) {
     m_breakpoint_list.UpdateBreakpoints(module_list, true, false);
@@ -1574,6 +1592,8 @@ void Target::ModulesDidLoad(ModuleList &module_list) {
     if (swift_ast_ctx)
       swift_ast_ctx->ModulesDidLoad(module_list);
     module_list.ClearModuleDependentCaches();
+    if (!ModuleListIsAllJIT(module_list))
+      ClearUserExpressionCache();
     BroadcastEvent(eBroadcastBitModulesLoaded,
                    new TargetEventData(this->shared_from_this(), module_list));
   }
@@ -1603,6 +1623,8 @@ void Target::ModulesDidUnload(ModuleList &module_list, bool delete_locations) {
     m_breakpoint_list.UpdateBreakpoints(module_list, false, delete_locations);
     m_internal_breakpoint_list.UpdateBreakpoints(module_list, false,
                                                  delete_locations);
+    if (!ModuleListIsAllJIT(module_list))
+      ClearUserExpressionCache();
     BroadcastEvent(eBroadcastBitModulesUnloaded,
                    new TargetEventData(this->shared_from_this(), module_list));
   }
@@ -2150,6 +2172,9 @@ TypeSystem *Target::GetScratchTypeSystemForLanguage(
           }
         }
         m_scratch_type_system_map.RemoveTypeSystemsForLanguage(language);
+        // Cached Swift expressions were compiled against the discarded
+        // context.
+        ClearUserExpressionCache();
         type_system = m_scratch_type_system_map.GetTypeSystemForLanguage(
             language, this, create_on_demand, compiler_options);
 
@@ -2242,6 +2267,44 @@ UserExpression *Target::GetUserExpressionForLanguage(
   return user_expr;
 }
 
+lldb::UserExpressionSP
+Target::GetCachedUserExpression(llvm::StringRef key,
+                                ExecutionContext &exe_ctx) {
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  auto range = m_user_expression_cache.equal_range(key.str());
+  for (auto pos = range.first; pos != range.second; ++pos) {
+    if (pos->second->MatchesContext(exe_ctx)) {
+      lldb::UserExpressionSP user_expression_sp = pos->second;
+      m_user_expression_cache.erase(pos);
+      return user_expression_sp;
+    }
+  }
+  return lldb::UserExpressionSP();
+}
+
+void Target::CacheUserExpression(
+    llvm::StringRef key, const lldb::UserExpressionSP &user_expression_sp) {
+  // Every cached expression keeps its code and data allocated in the
+  // inferior, so only hold on to the ones a watch window is likely to
+  // cycle through.
+  static const size_t g_max_cached_expressions = 64;
+  UserExpressionCache evicted_expressions;
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  if (m_user_expression_cache.size() >= g_max_cached_expressions)
+    evicted_expressions.swap(m_user_expression_cache);
+  m_user_expression_cache.emplace(key.str(), user_expression_sp);
+}
+
+void Target::ClearUserExpressionCache() {
+  UserExpressionCache user_expression_cache;
+  {
+    std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+    user_expression_cache.swap(m_user_expression_cache);
+  }
+  // The expressions are destroyed here, outside of the lock, since that
+  // removes their JIT modules from the target.
+}
+
 FunctionCaller *Target::GetFunctionCallerForLanguage(
     lldb::LanguageType language, const CompilerType &return_type,
     const Address &function_address, const ValueList &arg_value_list,
@@ -2393,6 +2456,111 @@ Target *Target::GetTargetFromContexts(const ExecutionContext *exe_ctx_ptr,
   return target;
 }
 
+// Check whether \a expr is a variable name followed by member accesses and
+// constant subscripts, optionally dereferenced or with its address taken.
+// StackFrame::GetValueForVariableExpressionPath evaluates these the same way
+// the expression parser would, without compiling anything.
+static bool IsSimpleVariablePath(llvm::StringRef expr) {
+  if (expr.startswith("*") || expr.startswith("&"))
+    expr = expr.drop_front();
+
+  auto consume_identifier = [&expr]() -> bool {
+    if (expr.empty() || !(isalpha(expr[0]) || expr[0] == '_'))
+      return false;
+    size_t len = 1;
+    while (len < expr.size() && (isalnum(expr[len]) || expr[len] == '_'))
+      ++len;
+    expr = expr.drop_front(len);
+    return true;
+  };
+
+  if (!consume_identifier())
+    return false;
+  while (!expr.empty()) {
+    if (expr.consume_front(".") || expr.consume_front("->")) {
+      if (!consume_identifier())
+        return false;
+    } else if (expr.consume_front("[")) {
+      size_t len = 0;
+      while (len < expr.size() && isdigit(expr[len]))
+        ++len;
+      if (len == 0)
+        return false;
+      expr = expr.drop_front(len);
+      if (!expr.consume_front("]"))
+        return false;
+    } else
+      return false;
+  }
+  return true;
+}
+
+lldb::ValueObjectSP
+Target::EvaluateVariablePath(llvm::StringRef expr, ExecutionContext &exe_ctx,
+                             const EvaluateExpressionOptions &options) {
+  StackFrame *frame = exe_ctx.GetFramePtr();
+  if (!frame || !IsSimpleVariablePath(expr))
+    return ValueObjectSP();
+
+  // Leave anything that could change the meaning of the text, or asks for
+  // more than the value, to the expression parser.
+  if (options.DoesCoerceToId() || options.GetResultIsInternal() ||
+      options.GetExecutionPolicy() == eExecutionPolicyTopLevel)
+    return ValueObjectSP();
+  const char *target_prefix = GetExpressionPrefixContentsAsCString();
+  const char *option_prefix = options.GetPrefix();
+  if ((target_prefix && target_prefix[0]) ||
+      (option_prefix && option_prefix[0]))
+    return ValueObjectSP();
+
+  lldb::LanguageType language = options.GetLanguage();
+  if (language == eLanguageTypeUnknown)
+    language = GetLanguage();
+  if (language == eLanguageTypeUnknown)
+    language = frame->GetLanguage();
+  if (!Language::LanguageIsC(language) &&
+      !Language::LanguageIsCPlusPlus(language) &&
+      !Language::LanguageIsObjC(language))
+    return ValueObjectSP();
+
+  // These are the same restrictions the expression parser follows: no
+  // synthetic children, and '.' can't be used on pointers.
+  const uint32_t path_options =
+      StackFrame::eExpressionPathOptionCheckPtrVsMember |
+      StackFrame::eExpressionPathOptionsNoSyntheticChildren |
+      StackFrame::eExpressionPathOptionsNoSyntheticArrayRange;
+  VariableSP var_sp;
+  Status error;
+  ValueObjectSP valobj_sp = frame->GetValueForVariableExpressionPath(
+      expr, eNoDynamicValues, path_options, var_sp, error);
+  if (error.Fail() || !valobj_sp || !var_sp)
+    return ValueObjectSP();
+
+  // Inside a method, Clang looks a name up in the class before the file
+  // scope, so a global found here may be shadowed by a member.  Only locals
+  // and arguments are sure to be what the expression parser would find.
+  const ValueType var_scope = var_sp->GetScope();
+  if (var_scope != eValueTypeVariableLocal &&
+      var_scope != eValueTypeVariableArgument) {
+    SymbolContext sc =
+        frame->GetSymbolContext(eSymbolContextFunction | eSymbolContextBlock);
+    lldb::LanguageType method_language = eLanguageTypeUnknown;
+    bool is_instance_method = false;
+    ConstString method_object_name;
+    if (sc.GetFunctionMethodInfo(method_language, is_instance_method,
+                                 method_object_name))
+      return ValueObjectSP();
+  }
+
+  // A persistent copy of a bit-field or a reference doesn't have the value
+  // the expression parser would produce.
+  if (valobj_sp->IsBitfield() ||
+      valobj_sp->GetCompilerType().IsReferenceType())
+    return ValueObjectSP();
+
+  return valobj_sp->Persist();
+}
+
 ExpressionResults Target::EvaluateExpression(
     llvm::StringRef expr, ExecutionContextScope *exe_scope,
     lldb::ValueObjectSP &result_valobj_sp,
@@ -2431,6 +2599,14 @@ ExpressionResults Target::EvaluateExpression(
   if (persistent_var_sp) {
     result_valobj_sp = persistent_var_sp->GetValueObject();
     execution_results = eExpressionCompleted;
+  } else if ((result_valobj_sp =
+                  EvaluateVariablePath(expr.trim(), exe_ctx, options))) {
+    Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS));
+    if (log)
+      log->Printf("== [Target::EvaluateExpression] Evaluated %s as a "
+                  "variable path without the expression parser ==",
+                  expr.str().c_str());
+    execution_results = eExpressionCompleted;
   } else {
     const char *prefix = GetExpressionPrefixContentsAsCString();
     Status error;
@@ -3573,6 +3749,10 @@ static PropertyDefinition g_properties[] = {
      nullptr, "Print the fixed expression text."},
     {"save-jit-objects", OptionValue::eTypeBoolean, false, false, nullptr,
      nullptr, "Save intermediate object files generated by the LLVM JIT"},
+    {"cache-jit-objects", OptionValue::eTypeBoolean, false, true, nullptr,
+     nullptr, "Cache the object code of LLDB's helper functions in the "
+              "user's cache directory, so that later sessions don't have to "
+              "compile them again."},
     {"max-children-count", OptionValue::eTypeSInt64, false, 256, nullptr,
      nullptr, "Maximum number of children to expand in any level of depth."},
     {"max-string-summary-length", OptionValue::eTypeSInt64, false, 1024,
@@ -3679,7 +3859,9 @@ static PropertyDefinition g_properties[] = {
     {"sdk-path", OptionValue::eTypeFileSpec, false, 0, nullptr, nullptr,
      "The path to the SDK used to build the current target."},
     {"module-cache-path", OptionValue::eTypeFileSpec, false, 0, nullptr,
-     nullptr, "The path to the module-cache directory."},
+     nullptr, "The path to the directory where the Clang modules built for "
+              "Swift are cached.  If not set, Clang's default module cache "
+              "for the current user is used."},
     {"display-runtime-support-values", OptionValue::eTypeBoolean, false, false,
      nullptr, nullptr, "If true, LLDB will show variables that are meant to "
                        "support the operation of a language's runtime "
@@ -3707,6 +3889,7 @@ enum {
   ePropertyAutoApplyFixIts,
   ePropertyNotifyAboutFixIts,
   ePropertySaveObjects,
+  ePropertyCacheObjects,
   ePropertyMaxChildrenCount,
   ePropertyMaxSummaryLength,
   ePropertyMaxMemReadSize,
@@ -3838,9 +4021,24 @@ static PropertyDefinition g_experimental_properties[]{
      "This will fix symbol resolution when there are name collisions between "
      "ivars and local variables.  "
      "But it can make expressions run much more slowly."},
+    {"lazy-type-import", OptionValue::eTypeBoolean, true, true, nullptr,
+     nullptr,
+     "If true, expressions import the types of variables and named types as "
+     "forward declarations and only complete them when the expression parser "
+     "needs their definitions.  Turn this off to complete every type as soon "
+     "as it is found."},
+    {"parallel-swift-module-load", OptionValue::eTypeBoolean, true, true,
+     nullptr, nullptr,
+     "If true, the Swift AST contexts of all the target's images are created "
+     "in parallel before the Swift expression context is set up.  Turn this "
+     "off to load the Swift modules of each image one at a time."},
     {nullptr, OptionValue::eTypeInvalid, true, 0, nullptr, nullptr, nullptr}};
 
-enum { ePropertyInjectLocalVars = 0 };
+enum {
+  ePropertyInjectLocalVars = 0,
+  ePropertyLazyTypeImport,
+  ePropertyParallelSwiftModuleLoad
+};
 
 class TargetExperimentalOptionValueProperties : public OptionValueProperties {
 public:
@@ -3951,6 +4149,31 @@ void TargetProperties::SetInjectLocalVariables(ExecutionContext *exe_ctx,
                                             true);
 }
 
+bool TargetProperties::GetLazyTypeImport(ExecutionContext *exe_ctx) const {
+  const Property *exp_property = m_collection_sp->GetPropertyAtIndex(
+      exe_ctx, false, ePropertyExperimental);
+  OptionValueProperties *exp_values =
+      exp_property->GetValue()->GetAsProperties();
+  if (exp_values)
+    return exp_values->GetPropertyAtIndexAsBoolean(
+        exe_ctx, ePropertyLazyTypeImport, true);
+  else
+    return true;
+}
+
+bool TargetProperties::GetParallelSwiftModuleLoad(
+    ExecutionContext *exe_ctx) const {
+  const Property *exp_property = m_collection_sp->GetPropertyAtIndex(
+      exe_ctx, false, ePropertyExperimental);
+  OptionValueProperties *exp_values =
+      exp_property->GetValue()->GetAsProperties();
+  if (exp_values)
+    return exp_values->GetPropertyAtIndexAsBoolean(
+        exe_ctx, ePropertyParallelSwiftModuleLoad, true);
+  else
+    return true;
+}
+
 ArchSpec TargetProperties::GetDefaultArchitecture() const {
   OptionValueArch *value = m_collection_sp->GetPropertyAtIndexAsOptionValueArch(
       nullptr, ePropertyDefaultArch);
@@ -4187,6 +4410,12 @@ bool TargetProperties::GetEnableSaveObjects() const {
       nullptr, idx, g_properties[idx].default_uint_value != 0);
 }
 
+bool TargetProperties::GetEnableCacheObjects() const {
+  const uint32_t idx = ePropertyCacheObjects;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_properties[idx].default_uint_value != 0);
+}
+
 bool TargetProperties::GetEnableSyntheticValue() const {
   const uint32_t idx = ePropertyEnableSynthetic;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
@@ -23,6 +23,7 @@
 #include "lldb/Target/ThreadPlan.h"
 #include "lldb/Utility/LLDBAssert.h"
 #include "lldb/Utility/Log.h"
+#include "lldb/Utility/TaskPool.h"
 
 using namespace lldb;
 using namespace lldb_private;
@@ -79,6 +80,41 @@ void ThreadList::PopExpressionExecutionThread(lldb::tid_t tid) {
   m_expression_tid_stack.pop_back();
 }
 
+void ThreadList::ComputeStackFrames(const std::vector<lldb::tid_t> &tids,
+                                    uint32_t end_idx) {
+  // Unwinding must not race with the process resuming.
+  if (!StateIsStoppedState(m_process->GetState(), false))
+    return;
+
+  // Collect the threads up front so the workers never need the thread list
+  // mutex.
+  std::vector<ThreadSP> threads;
+  {
+    std::lock_guard<std::recursive_mutex> guard(GetMutex());
+    for (lldb::tid_t tid : tids) {
+      ThreadSP thread_sp = FindThreadByID(tid, false);
+      if (thread_sp)
+        threads.push_back(thread_sp);
+    }
+  }
+
+  if (threads.size() < 2)
+    return;
+
+  Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_THREAD));
+  if (log)
+    log->Printf("ThreadList::%s unwinding %" PRIu64 " threads", __FUNCTION__,
+                (uint64_t)threads.size());
+
+  TaskMapOverInt(0, threads.size(), [&threads, end_idx](size_t idx) {
+    Thread *thread = threads[idx].get();
+    if (end_idx == UINT32_MAX)
+      thread->GetStackFrameCount();
+    else
+      thread->GetStackFrameAtIndex(end_idx);
+  });
+}
+
 uint32_t ThreadList::GetStopID() const { return m_stop_id; }
 
 void ThreadList::SetStopID(uint32_t stop_id) { m_stop_id = stop_id; }
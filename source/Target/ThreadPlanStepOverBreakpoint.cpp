@@ -13,6 +13,7 @@
 // C++ Includes
 // Other libraries and framework includes
 // Project includes
+#include "lldb/Breakpoint/BreakpointSite.h"
 #include "lldb/Target/Process.h"
 #include "lldb/Target/RegisterContext.h"
 #include "lldb/Utility/Log.h"
@@ -24,6 +25,11 @@ using namespace lldb_private;
 //----------------------------------------------------------------------
 // ThreadPlanStepOverBreakpoint: Single steps over a breakpoint bp_site_sp at
 // the pc.
+//
+// When the instruction at the breakpoint doesn't depend on its address, the
+// thread steps a copy of it made by Process::GetDisplacedStepCopy instead.
+// That leaves the breakpoint trap in place, so the other threads don't have
+// to be stopped while this one steps.
 //----------------------------------------------------------------------
 
 ThreadPlanStepOverBreakpoint::ThreadPlanStepOverBreakpoint(Thread &thread)
@@ -34,7 +40,8 @@ ThreadPlanStepOverBreakpoint::ThreadPlanStepOverBreakpoint(Thread &thread)
                            // first in the thread plan stack when stepping
                            // over a breakpoint
       m_breakpoint_addr(LLDB_INVALID_ADDRESS),
-      m_auto_continue(false), m_reenabled_breakpoint_site(false)
+      m_auto_continue(false), m_reenabled_breakpoint_site(false),
+      m_displaced_addr(LLDB_INVALID_ADDRESS), m_displaced_size(0)
 
 {
   m_breakpoint_addr = m_thread.GetRegisterContext()->GetPC();
@@ -49,11 +56,15 @@ void ThreadPlanStepOverBreakpoint::GetDescription(
     Stream *s, lldb::DescriptionLevel level) {
   s->Printf("Single stepping past breakpoint site %" PRIu64 " at 0x%" PRIx64,
             m_breakpoint_site_id, (uint64_t)m_breakpoint_addr);
+  if (m_displaced_addr != LLDB_INVALID_ADDRESS)
+    s->Printf(" using the copy at 0x%" PRIx64, (uint64_t)m_displaced_addr);
 }
 
 bool ThreadPlanStepOverBreakpoint::ValidatePlan(Stream *error) { return true; }
 
 bool ThreadPlanStepOverBreakpoint::DoPlanExplainsStop(Event *event_ptr) {
+  MoveOutOfDisplacedStepCopy();
+
   StopInfoSP stop_info_sp = GetPrivateStopInfo();
   if (stop_info_sp) {
     // It's a little surprising that we stop here for a breakpoint hit.
@@ -102,7 +113,11 @@ bool ThreadPlanStepOverBreakpoint::ShouldStop(Event *event_ptr) {
   return !ShouldAutoContinue(event_ptr);
 }
 
-bool ThreadPlanStepOverBreakpoint::StopOthers() { return true; }
+bool ThreadPlanStepOverBreakpoint::StopOthers() {
+  lldb::addr_t copy_addr;
+  uint32_t copy_size;
+  return !GetDisplacedStepCopy(copy_addr, copy_size);
+}
 
 StateType ThreadPlanStepOverBreakpoint::GetPlanRunState() {
   return eStateStepping;
@@ -111,6 +126,31 @@ StateType ThreadPlanStepOverBreakpoint::GetPlanRunState() {
 bool ThreadPlanStepOverBreakpoint::DoWillResume(StateType resume_state,
                                                 bool current_plan) {
   if (current_plan) {
+    lldb::addr_t copy_addr;
+    uint32_t copy_size;
+    if (GetDisplacedStepCopy(copy_addr, copy_size)) {
+      // If the process stopped before the thread got to step the copy, and
+      // nobody looked at the thread, it is still at the start of the copy.
+      if (copy_addr == m_displaced_addr)
+        return true;
+      MoveOutOfDisplacedStepCopy();
+      Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_STEP));
+      if (m_thread.GetRegisterContext()->SetPC(copy_addr)) {
+        m_displaced_addr = copy_addr;
+        m_displaced_size = copy_size;
+        if (log)
+          log->Printf("Stepping over the breakpoint at 0x%" PRIx64
+                      " using the copy at 0x%" PRIx64 ".",
+                      m_breakpoint_addr, copy_addr);
+        return true;
+      }
+      if (log)
+        log->Printf("Couldn't move the pc to the copy at 0x%" PRIx64
+                    ", stepping over the breakpoint in place.",
+                    copy_addr);
+    }
+
+    MoveOutOfDisplacedStepCopy();
     BreakpointSiteSP bp_site_sp(
         m_thread.GetProcess()->GetBreakpointSiteList().FindByAddress(
             m_breakpoint_addr));
@@ -121,11 +161,14 @@ bool ThreadPlanStepOverBreakpoint::DoWillResume(StateType resume_state,
 }
 
 bool ThreadPlanStepOverBreakpoint::WillStop() {
+  MoveOutOfDisplacedStepCopy();
   ReenableBreakpointSite();
   return true;
 }
 
 bool ThreadPlanStepOverBreakpoint::MischiefManaged() {
+  MoveOutOfDisplacedStepCopy();
+
   lldb::addr_t pc_addr = m_thread.GetRegisterContext()->GetPC();
 
   if (pc_addr == m_breakpoint_addr) {
@@ -156,6 +199,48 @@ void ThreadPlanStepOverBreakpoint::ReenableBreakpointSite() {
     }
   }
 }
+
+bool ThreadPlanStepOverBreakpoint::GetDisplacedStepCopy(lldb::addr_t &copy_addr,
+                                                        uint32_t &copy_size) {
+  // Stepping a copy lets the other threads run, so don't use one if a plan
+  // below this one wants them stopped.
+  ThreadPlan *prev_plan = GetPreviousPlan();
+  if (prev_plan && prev_plan->StopOthers())
+    return false;
+
+  ProcessSP process_sp(m_thread.GetProcess());
+  BreakpointSiteList &bp_site_list = process_sp->GetBreakpointSiteList();
+  BreakpointSiteSP bp_site_sp(bp_site_list.FindByAddress(m_breakpoint_addr));
+  if (!bp_site_sp || !bp_site_sp->IsEnabled())
+    return false;
+
+  copy_addr = process_sp->GetDisplacedStepCopy(m_breakpoint_addr, copy_size);
+  if (copy_addr == LLDB_INVALID_ADDRESS)
+    return false;
+
+  // Stepping onto a breakpoint counts as hitting it, which the lower levels
+  // only notice when the step ends on the breakpoint's address.  So step in
+  // place if the next instruction has a breakpoint too.
+  return !bp_site_list.FindByAddress(m_breakpoint_addr + copy_size);
+}
+
+void ThreadPlanStepOverBreakpoint::MoveOutOfDisplacedStepCopy() {
+  if (m_displaced_addr == LLDB_INVALID_ADDRESS)
+    return;
+
+  // The thread is just past the end of the copy if it stepped it, and at
+  // its start if it didn't get to or the instruction faulted.  Either way,
+  // put it at the same place in the original.
+  RegisterContextSP reg_ctx_sp(m_thread.GetRegisterContext());
+  const lldb::addr_t pc_addr = reg_ctx_sp->GetPC();
+  if (pc_addr >= m_displaced_addr &&
+      pc_addr <= m_displaced_addr + m_displaced_size)
+    reg_ctx_sp->SetPC(m_breakpoint_addr + (pc_addr - m_displaced_addr));
+
+  m_displaced_addr = LLDB_INVALID_ADDRESS;
+  m_displaced_size = 0;
+}
+
 void ThreadPlanStepOverBreakpoint::ThreadDestroyed() {
   ReenableBreakpointSite();
 }
@@ -169,5 +254,6 @@ bool ThreadPlanStepOverBreakpoint::ShouldAutoContinue(Event *event_ptr) {
 }
 
 bool ThreadPlanStepOverBreakpoint::IsPlanStale() {
-  return m_thread.GetRegisterContext()->GetPC() != m_breakpoint_addr;
+  const lldb::addr_t pc_addr = m_thread.GetRegisterContext()->GetPC();
+  return pc_addr != m_breakpoint_addr && pc_addr != m_displaced_addr;
 }
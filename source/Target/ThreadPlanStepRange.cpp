@@ -412,6 +412,27 @@ StateType ThreadPlanStepRange::GetPlanRunState() {
     return eStateStepping;
 }
 
+bool ThreadPlanStepRange::GetStepRange(lldb::addr_t &start,
+                                       lldb::addr_t &end) {
+  // Only single steps are worth handing off, a run to the next branch
+  // already stops just once.
+  if (m_next_branch_bp_sp)
+    return false;
+
+  Target *target = m_thread.CalculateTarget().get();
+  lldb::addr_t pc = m_thread.GetRegisterContext()->GetPC();
+  for (const AddressRange &range : m_address_ranges) {
+    if (!range.ContainsLoadAddress(pc, target))
+      continue;
+    start = range.GetBaseAddress().GetLoadAddress(target);
+    if (start == LLDB_INVALID_ADDRESS)
+      return false;
+    end = start + range.GetByteSize();
+    return true;
+  }
+  return false;
+}
+
 bool ThreadPlanStepRange::MischiefManaged() {
   bool done = true;
   if (!IsPlanComplete()) {
@@ -0,0 +1,437 @@
+//===-- AgentExpression.cpp -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Utility/AgentExpression.h"
+
+#include "llvm/ADT/DenseSet.h"
+
+#include <limits>
+
+using namespace lldb;
+using namespace lldb_private;
+
+// Conditions run every time their breakpoint is hit, so keep runaway
+// expressions from wedging the stub.
+static const size_t g_max_stack_depth = 1024;
+static const size_t g_max_steps = 64 * 1024;
+
+// Returns the size of the operands that follow op, or -1 if op isn't
+// supported.
+static int GetOperandSize(uint8_t op) {
+  switch (op) {
+  case AgentExpression::eOpAdd:
+  case AgentExpression::eOpSub:
+  case AgentExpression::eOpMul:
+  case AgentExpression::eOpDivSigned:
+  case AgentExpression::eOpDivUnsigned:
+  case AgentExpression::eOpRemSigned:
+  case AgentExpression::eOpRemUnsigned:
+  case AgentExpression::eOpLsh:
+  case AgentExpression::eOpRshSigned:
+  case AgentExpression::eOpRshUnsigned:
+  case AgentExpression::eOpTrace:
+  case AgentExpression::eOpLogNot:
+  case AgentExpression::eOpBitAnd:
+  case AgentExpression::eOpBitOr:
+  case AgentExpression::eOpBitXor:
+  case AgentExpression::eOpBitNot:
+  case AgentExpression::eOpEqual:
+  case AgentExpression::eOpLessSigned:
+  case AgentExpression::eOpLessUnsigned:
+  case AgentExpression::eOpRef8:
+  case AgentExpression::eOpRef16:
+  case AgentExpression::eOpRef32:
+  case AgentExpression::eOpRef64:
+  case AgentExpression::eOpEnd:
+  case AgentExpression::eOpDup:
+  case AgentExpression::eOpPop:
+  case AgentExpression::eOpSwap:
+  case AgentExpression::eOpTraceNZ:
+  case AgentExpression::eOpRot:
+    return 0;
+  case AgentExpression::eOpTraceQuick:
+  case AgentExpression::eOpExt:
+  case AgentExpression::eOpZeroExt:
+  case AgentExpression::eOpPick:
+  case AgentExpression::eOpConst8:
+    return 1;
+  case AgentExpression::eOpIfGoto:
+  case AgentExpression::eOpGoto:
+  case AgentExpression::eOpConst16:
+  case AgentExpression::eOpReg:
+  case AgentExpression::eOpTrace16:
+    return 2;
+  case AgentExpression::eOpConst32:
+    return 4;
+  case AgentExpression::eOpConst64:
+    return 8;
+  default:
+    return -1;
+  }
+}
+
+// Operands are stored most significant byte first.
+static uint64_t ReadOperand(llvm::ArrayRef<uint8_t> bytes, size_t offset,
+                            size_t byte_size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < byte_size; ++i)
+    value = (value << 8) | bytes[offset + i];
+  return value;
+}
+
+static uint64_t SignExtend(uint64_t value, uint8_t bits) {
+  if (bits == 0 || bits >= 64)
+    return value;
+  const uint64_t sign_bit = 1ULL << (bits - 1);
+  value &= (1ULL << bits) - 1;
+  return (value ^ sign_bit) - sign_bit;
+}
+
+static uint64_t ZeroExtend(uint64_t value, uint8_t bits) {
+  if (bits == 0 || bits >= 64)
+    return value;
+  return value & ((1ULL << bits) - 1);
+}
+
+void AgentExpression::AppendBigEndian(uint64_t value, size_t byte_size) {
+  for (size_t i = byte_size; i > 0; --i)
+    m_bytes.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+}
+
+void AgentExpression::AppendConstant(uint64_t value) {
+  // The constN opcodes don't sign extend, so negative values take all eight
+  // bytes.
+  if (value <= std::numeric_limits<uint8_t>::max()) {
+    AppendOpcode(eOpConst8);
+    AppendBigEndian(value, 1);
+  } else if (value <= std::numeric_limits<uint16_t>::max()) {
+    AppendOpcode(eOpConst16);
+    AppendBigEndian(value, 2);
+  } else if (value <= std::numeric_limits<uint32_t>::max()) {
+    AppendOpcode(eOpConst32);
+    AppendBigEndian(value, 4);
+  } else {
+    AppendOpcode(eOpConst64);
+    AppendBigEndian(value, 8);
+  }
+}
+
+void AgentExpression::AppendRegister(uint16_t reg_num) {
+  AppendOpcode(eOpReg);
+  AppendBigEndian(reg_num, 2);
+}
+
+bool AgentExpression::AppendReference(size_t byte_size) {
+  switch (byte_size) {
+  case 1:
+    AppendOpcode(eOpRef8);
+    return true;
+  case 2:
+    AppendOpcode(eOpRef16);
+    return true;
+  case 4:
+    AppendOpcode(eOpRef32);
+    return true;
+  case 8:
+    AppendOpcode(eOpRef64);
+    return true;
+  default:
+    return false;
+  }
+}
+
+void AgentExpression::AppendExtend(uint8_t bits, bool is_signed) {
+  AppendOpcode(is_signed ? eOpExt : eOpZeroExt);
+  m_bytes.push_back(bits);
+}
+
+size_t AgentExpression::AppendGoto(Opcode op) {
+  AppendOpcode(op);
+  const size_t patch_offset = m_bytes.size();
+  AppendBigEndian(0, 2);
+  return patch_offset;
+}
+
+void AgentExpression::PatchGoto(size_t patch_offset, size_t target) {
+  m_bytes[patch_offset] = static_cast<uint8_t>(target >> 8);
+  m_bytes[patch_offset + 1] = static_cast<uint8_t>(target);
+}
+
+Status AgentExpression::Validate() const {
+  if (m_bytes.empty())
+    return Status("empty agent expression");
+
+  llvm::DenseSet<size_t> instruction_offsets;
+  std::vector<size_t> jump_targets;
+  size_t offset = 0;
+  while (offset < m_bytes.size()) {
+    const uint8_t op = m_bytes[offset];
+    const int operand_size = GetOperandSize(op);
+    if (operand_size < 0)
+      return Status("unsupported agent expression opcode 0x%2.2x at offset %zu",
+                    op, offset);
+    if (offset + 1 + operand_size > m_bytes.size())
+      return Status("truncated agent expression opcode 0x%2.2x at offset %zu",
+                    op, offset);
+
+    instruction_offsets.insert(offset);
+    if (op == eOpIfGoto || op == eOpGoto)
+      jump_targets.push_back(ReadOperand(m_bytes, offset + 1, 2));
+    offset += 1 + operand_size;
+  }
+
+  for (size_t target : jump_targets) {
+    if (instruction_offsets.count(target) == 0)
+      return Status("agent expression jumps to invalid offset %zu", target);
+  }
+  return Status();
+}
+
+Status AgentExpression::Evaluate(const ReadRegisterCallback &read_register,
+                                 const ReadMemoryCallback &read_memory,
+                                 uint64_t &result) const {
+  std::vector<uint64_t> stack;
+  size_t pc = 0;
+
+  for (size_t steps = 0; steps < g_max_steps; ++steps) {
+    if (pc >= m_bytes.size())
+      return Status("agent expression ran past its end");
+
+    const uint8_t op = m_bytes[pc];
+    const int operand_size = GetOperandSize(op);
+    if (operand_size < 0)
+      return Status("unsupported agent expression opcode 0x%2.2x", op);
+    if (pc + 1 + operand_size > m_bytes.size())
+      return Status("truncated agent expression opcode 0x%2.2x", op);
+    const uint64_t operand = ReadOperand(m_bytes, pc + 1, operand_size);
+    size_t next_pc = pc + 1 + operand_size;
+
+    // Make sure the stack holds enough values for the opcode.
+    size_t num_inputs = 0;
+    switch (op) {
+    case eOpConst8:
+    case eOpConst16:
+    case eOpConst32:
+    case eOpConst64:
+    case eOpReg:
+    case eOpGoto:
+    case eOpEnd:
+      break;
+    case eOpRot:
+      num_inputs = 3;
+      break;
+    case eOpAdd:
+    case eOpSub:
+    case eOpMul:
+    case eOpDivSigned:
+    case eOpDivUnsigned:
+    case eOpRemSigned:
+    case eOpRemUnsigned:
+    case eOpLsh:
+    case eOpRshSigned:
+    case eOpRshUnsigned:
+    case eOpBitAnd:
+    case eOpBitOr:
+    case eOpBitXor:
+    case eOpEqual:
+    case eOpLessSigned:
+    case eOpLessUnsigned:
+    case eOpSwap:
+    case eOpTrace:
+    case eOpTraceNZ:
+      num_inputs = 2;
+      break;
+    case eOpPick:
+      num_inputs = operand + 1;
+      break;
+    default:
+      num_inputs = 1;
+      break;
+    }
+    if (stack.size() < num_inputs)
+      return Status("agent expression stack underflow at offset %zu", pc);
+
+    switch (op) {
+    case eOpEnd:
+      if (stack.empty())
+        return Status("agent expression ended with an empty stack");
+      result = stack.back();
+      return Status();
+
+    case eOpConst8:
+    case eOpConst16:
+    case eOpConst32:
+    case eOpConst64:
+      stack.push_back(operand);
+      break;
+
+    case eOpReg: {
+      uint64_t value = 0;
+      if (!read_register || !read_register(operand, value))
+        return Status("agent expression failed to read register %" PRIu64,
+                      operand);
+      stack.push_back(value);
+      break;
+    }
+
+    case eOpRef8:
+    case eOpRef16:
+    case eOpRef32:
+    case eOpRef64: {
+      const size_t byte_size = 1u << (op - eOpRef8);
+      const addr_t addr = stack.back();
+      uint64_t value = 0;
+      if (!read_memory || !read_memory(addr, byte_size, value))
+        return Status("agent expression failed to read %zu bytes at 0x%" PRIx64,
+                      byte_size, addr);
+      stack.back() = value;
+      break;
+    }
+
+    case eOpIfGoto: {
+      const uint64_t value = stack.back();
+      stack.pop_back();
+      if (value != 0)
+        next_pc = operand;
+      break;
+    }
+
+    case eOpGoto:
+      next_pc = operand;
+      break;
+
+    case eOpExt:
+      stack.back() = SignExtend(stack.back(), operand);
+      break;
+
+    case eOpZeroExt:
+      stack.back() = ZeroExtend(stack.back(), operand);
+      break;
+
+    case eOpLogNot:
+      stack.back() = stack.back() == 0;
+      break;
+
+    case eOpBitNot:
+      stack.back() = ~stack.back();
+      break;
+
+    case eOpDup:
+      stack.push_back(stack.back());
+      break;
+
+    case eOpPop:
+      stack.pop_back();
+      break;
+
+    case eOpSwap:
+      std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+      break;
+
+    case eOpPick:
+      stack.push_back(stack[stack.size() - 1 - operand]);
+      break;
+
+    case eOpRot: {
+      // a b c => c a b
+      const uint64_t c = stack.back();
+      stack[stack.size() - 1] = stack[stack.size() - 2];
+      stack[stack.size() - 2] = stack[stack.size() - 3];
+      stack[stack.size() - 3] = c;
+      break;
+    }
+
+    case eOpTrace:
+    case eOpTraceNZ:
+      // addr size =>
+      stack.pop_back();
+      stack.pop_back();
+      break;
+
+    case eOpTraceQuick:
+    case eOpTrace16:
+      // addr => addr
+      break;
+
+    default: {
+      // The remaining opcodes are binary operators: a b => a op b.
+      const uint64_t b = stack.back();
+      stack.pop_back();
+      const uint64_t a = stack.back();
+      const int64_t sa = static_cast<int64_t>(a);
+      const int64_t sb = static_cast<int64_t>(b);
+      uint64_t value = 0;
+      switch (op) {
+      case eOpAdd:
+        value = a + b;
+        break;
+      case eOpSub:
+        value = a - b;
+        break;
+      case eOpMul:
+        value = a * b;
+        break;
+      case eOpDivSigned:
+      case eOpRemSigned:
+        if (b == 0)
+          return Status("agent expression divided by zero");
+        // INT64_MIN / -1 overflows, the wrapped result is INT64_MIN.
+        if (sb == -1)
+          value = op == eOpDivSigned ? 0 - a : 0;
+        else
+          value = op == eOpDivSigned ? sa / sb : sa % sb;
+        break;
+      case eOpDivUnsigned:
+      case eOpRemUnsigned:
+        if (b == 0)
+          return Status("agent expression divided by zero");
+        value = op == eOpDivUnsigned ? a / b : a % b;
+        break;
+      case eOpLsh:
+        value = b < 64 ? a << b : 0;
+        break;
+      case eOpRshSigned:
+        value = static_cast<uint64_t>(sa >> (b < 64 ? b : 63));
+        break;
+      case eOpRshUnsigned:
+        value = b < 64 ? a >> b : 0;
+        break;
+      case eOpBitAnd:
+        value = a & b;
+        break;
+      case eOpBitOr:
+        value = a | b;
+        break;
+      case eOpBitXor:
+        value = a ^ b;
+        break;
+      case eOpEqual:
+        value = a == b;
+        break;
+      case eOpLessSigned:
+        value = sa < sb;
+        break;
+      case eOpLessUnsigned:
+        value = a < b;
+        break;
+      default:
+        return Status("unsupported agent expression opcode 0x%2.2x", op);
+      }
+      stack.back() = value;
+      break;
+    }
+    }
+
+    if (stack.size() > g_max_stack_depth)
+      return Status("agent expression stack overflow at offset %zu", pc);
+    pc = next_pc;
+  }
+
+  return Status("agent expression exceeded %zu steps", g_max_steps);
+}
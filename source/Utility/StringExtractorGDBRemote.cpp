@@ -169,6 +169,11 @@ StringExtractorGDBRemote::GetServerPacketType() const {
         return eServerPacketType_qfThreadInfo;
       break;
 
+    case 'B':
+      if (PACKET_STARTS_WITH("qBreakpointHitCount:"))
+        return eServerPacketType_qBreakpointHitCount;
+      break;
+
     case 'C':
       if (packet_size == 2)
         return eServerPacketType_qC;
@@ -358,6 +363,12 @@ StringExtractorGDBRemote::GetServerPacketType() const {
 
     case 'm':
       return eServerPacketType__m;
+
+    case 'Z':
+      return eServerPacketType__Z;
+
+    case 'z':
+      return eServerPacketType__z;
     }
     break;
 
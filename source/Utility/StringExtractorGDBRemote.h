@@ -110,6 +110,7 @@ public:
     eServerPacketType_QThreadSuffixSupported,
 
     eServerPacketType_jThreadsInfo,
+    eServerPacketType_qBreakpointHitCount,
     eServerPacketType_qsThreadInfo,
     eServerPacketType_qfThreadInfo,
     eServerPacketType_qGetPid,
@@ -165,6 +166,8 @@ public:
 
     eServerPacketType__M,
     eServerPacketType__m,
+    eServerPacketType__Z,
+    eServerPacketType__z,
     eServerPacketType_notify, // '%' notification
 
     eServerPacketType_jTraceStart,
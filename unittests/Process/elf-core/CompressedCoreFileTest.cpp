@@ -0,0 +1,134 @@
+//===-- CompressedCoreFileTest.cpp ------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if defined(HAVE_LIBZ)
+#include <zlib.h>
+#endif
+
+#include "Plugins/Process/elf-core/CompressedCoreFile.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace lldb_private;
+
+#if defined(HAVE_LIBZ)
+
+namespace {
+class CompressedCoreFileTest : public testing::Test {
+public:
+  void SetUp() override {
+    // A pattern that doesn't repeat at block boundaries, so a read from the
+    // wrong block is noticed.
+    m_data.resize(10000);
+    for (size_t i = 0; i < m_data.size(); ++i)
+      m_data[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+  }
+
+  void TearDown() override {
+    if (!m_path.empty())
+      llvm::sys::fs::remove(m_path);
+  }
+
+  void WriteFile(llvm::StringRef contents) {
+    int fd;
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("lldb-bgzf", "gz", fd,
+                                                    m_path));
+    llvm::raw_fd_ostream os(fd, /*shouldClose*/ true);
+    os << contents;
+  }
+
+  // Compress m_data the way bgzip does, block_size bytes per gzip member,
+  // followed by the empty end of file block.
+  std::string CompressBGZF(size_t block_size) {
+    std::string contents;
+    llvm::raw_string_ostream os(contents);
+    for (size_t offset = 0; offset < m_data.size(); offset += block_size)
+      WriteBlock(os, m_data.data() + offset,
+                 std::min(block_size, m_data.size() - offset));
+    WriteBlock(os, nullptr, 0);
+    return os.str();
+  }
+
+  void WriteBlock(llvm::raw_ostream &os, const uint8_t *data, size_t size) {
+    std::vector<uint8_t> deflated(compressBound(size) + 16);
+    z_stream stream = {};
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = size;
+    stream.next_out = deflated.data();
+    stream.avail_out = deflated.size();
+    ASSERT_EQ(Z_OK, deflateInit2(&stream, 6, Z_DEFLATED, -15, 8,
+                                 Z_DEFAULT_STRATEGY));
+    ASSERT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+    deflateEnd(&stream);
+    deflated.resize(stream.total_out);
+
+    const uint16_t bsize = 18 + deflated.size() + 8 - 1;
+    const uint8_t header[] = {0x1f, 0x8b, 8,   4,   0, 0, 0,
+                              0,    0,    0xff, 6,  0, 'B', 'C',
+                              2,    0,    uint8_t(bsize & 0xff),
+                              uint8_t(bsize >> 8)};
+    os.write(reinterpret_cast<const char *>(header), sizeof(header));
+    os.write(reinterpret_cast<const char *>(deflated.data()),
+             deflated.size());
+    const uint32_t trailer[] = {
+        static_cast<uint32_t>(crc32(0, data, size)),
+        static_cast<uint32_t>(size)};
+    os.write(reinterpret_cast<const char *>(trailer), sizeof(trailer));
+  }
+
+  std::vector<uint8_t> m_data;
+  llvm::SmallString<128> m_path;
+};
+} // namespace
+
+TEST_F(CompressedCoreFileTest, ReadsAcrossBlocks) {
+  WriteFile(CompressBGZF(1000));
+  auto file_up = CompressedCoreFile::Open(m_path);
+  ASSERT_NE(nullptr, file_up);
+  EXPECT_EQ(m_data.size(), file_up->GetByteSize());
+
+  std::vector<uint8_t> buf(2100);
+  ASSERT_EQ(buf.size(), file_up->Read(950, buf.data(), buf.size()));
+  EXPECT_TRUE(std::equal(buf.begin(), buf.end(), m_data.begin() + 950));
+
+  // Reading the same blocks again is served from the cache.
+  ASSERT_EQ(10u, file_up->Read(1995, buf.data(), 10));
+  EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + 10, m_data.begin() + 1995));
+}
+
+TEST_F(CompressedCoreFileTest, ReadPastEnd) {
+  WriteFile(CompressBGZF(4096));
+  auto file_up = CompressedCoreFile::Open(m_path);
+  ASSERT_NE(nullptr, file_up);
+
+  std::vector<uint8_t> buf(100);
+  EXPECT_EQ(40u, file_up->Read(m_data.size() - 40, buf.data(), buf.size()));
+  EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + 40, m_data.end() - 40));
+  EXPECT_EQ(0u, file_up->Read(m_data.size(), buf.data(), buf.size()));
+}
+
+TEST_F(CompressedCoreFileTest, RejectsOtherFiles) {
+  WriteFile(llvm::StringRef(reinterpret_cast<const char *>(m_data.data()),
+                            m_data.size()));
+  EXPECT_EQ(nullptr, CompressedCoreFile::Open(m_path));
+}
+
+TEST_F(CompressedCoreFileTest, RejectsTruncatedFiles) {
+  std::string contents = CompressBGZF(1000);
+  WriteFile(llvm::StringRef(contents).drop_back(30));
+  EXPECT_EQ(nullptr, CompressedCoreFile::Open(m_path));
+}
+
+#endif // HAVE_LIBZ
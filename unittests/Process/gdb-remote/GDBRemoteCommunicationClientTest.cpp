@@ -506,3 +506,77 @@ TEST_F(GDBRemoteCommunicationClientTest, SendGetTraceConfigPacket) {
       incorrect_custom_params2);
   ASSERT_FALSE(result4.get().Success());
 }
+
+TEST_F(GDBRemoteCommunicationClientTest, SendBreakpointStopOptions) {
+  GDBStoppointStopOptions options;
+  AgentExpression condition;
+  condition.AppendConstant(1);
+  condition.AppendOpcode(AgentExpression::eOpEnd);
+  options.conditions.push_back(condition);
+  options.ignore_count = 0x10;
+  options.auto_continue = true;
+
+  std::future<uint8_t> result = std::async(std::launch::async, [&] {
+    return client.SendGDBStoppointTypePacket(eBreakpointSoftware, true, 0x1000,
+                                             1, options);
+  });
+  HandlePacket(server, "Z0,1000,1;X3,220127;ignore:10;auto-continue", "OK");
+  EXPECT_EQ(0u, result.get());
+}
+
+TEST_F(GDBRemoteCommunicationClientTest, SendSoftwareBreakpointPackets) {
+  const lldb::addr_t addrs[] = {0x1000, 0x1004, 0x2000};
+  std::vector<uint8_t> error_nos;
+  std::future<void> result = std::async(std::launch::async, [&] {
+    client.SendSoftwareBreakpointPackets(true, addrs, 1, error_nos);
+  });
+  HandlePacket(server, "qSupported:xmlRegisters=i386,arm,mips",
+               "MultiBreakpoints+");
+  HandlePacket(server, "_Z0,1:1000;1004;2000", "OK;OK;E09");
+  result.get();
+  EXPECT_EQ((std::vector<uint8_t>{0, 0, 9}), error_nos);
+
+  result = std::async(std::launch::async, [&] {
+    client.SendSoftwareBreakpointPackets(false, addrs, 1, error_nos);
+  });
+  HandlePacket(server, "_z0,1:1000;1004;2000", "OK;E09");
+  result.get();
+  EXPECT_EQ((std::vector<uint8_t>{UINT8_MAX, UINT8_MAX, UINT8_MAX}),
+            error_nos);
+}
+
+TEST_F(GDBRemoteCommunicationClientTest, GetBreakpointHitCount) {
+  uint64_t skipped_hits = 0;
+  uint32_t ignore_count = 0;
+  std::future<bool> result = std::async(std::launch::async, [&] {
+    return client.GetBreakpointHitCount(0x1000, skipped_hits, ignore_count);
+  });
+  HandlePacket(server, "qSupported:xmlRegisters=i386,arm,mips",
+               "BreakpointHitCounts+");
+  HandlePacket(server, "qBreakpointHitCount:1000", "hits:2a;ignore:3;");
+  EXPECT_TRUE(result.get());
+  EXPECT_EQ(42u, skipped_hits);
+  EXPECT_EQ(3u, ignore_count);
+
+  result = std::async(std::launch::async, [&] {
+    return client.GetBreakpointHitCount(0x2000, skipped_hits, ignore_count);
+  });
+  HandlePacket(server, "qBreakpointHitCount:2000", "E09");
+  EXPECT_FALSE(result.get());
+}
+
+TEST_F(GDBRemoteCommunicationClientTest, GetVContSupportedRangeStep) {
+  std::future<bool> result = std::async(std::launch::async, [&] {
+    return client.GetVContSupported('r');
+  });
+  HandlePacket(server, "vCont?", "vCont;c;C;s;S;r");
+  EXPECT_TRUE(result.get());
+  EXPECT_TRUE(client.GetVContSupported('s'));
+
+  client.ResetDiscoverableSettings(false);
+  result = std::async(std::launch::async, [&] {
+    return client.GetVContSupported('r');
+  });
+  HandlePacket(server, "vCont?", "vCont;c;C;s;S");
+  EXPECT_FALSE(result.get());
+}
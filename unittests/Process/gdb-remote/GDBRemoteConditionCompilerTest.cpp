@@ -0,0 +1,125 @@
+//===-- GDBRemoteConditionCompilerTest.cpp ----------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Plugins/Process/gdb-remote/GDBRemoteConditionCompiler.h"
+#include "gtest/gtest.h"
+
+#include <map>
+
+using namespace lldb_private::process_gdb_remote;
+using namespace lldb_private;
+using namespace lldb;
+typedef GDBRemoteConditionCompiler::Operand Operand;
+
+namespace {
+
+Operand MakeMemory(addr_t addr) {
+  Operand operand;
+  operand.kind = Operand::eMemory;
+  operand.bits = 32;
+  operand.is_signed = true;
+  operand.value = addr;
+  return operand;
+}
+
+struct FakeScope : public GDBRemoteConditionCompiler::Scope {
+  std::map<std::string, Operand> locals;
+  std::map<std::string, Operand> globals;
+  bool has_implicit_scope = false;
+  std::map<addr_t, uint64_t> memory;
+
+  bool FindLocal(llvm::StringRef name, Operand &operand) override {
+    auto pos = locals.find(name.str());
+    if (pos == locals.end())
+      return false;
+    operand = pos->second;
+    return true;
+  }
+
+  bool HasImplicitScope() override { return has_implicit_scope; }
+
+  bool FindGlobal(llvm::StringRef name, Operand &operand) override {
+    auto pos = globals.find(name.str());
+    if (pos == globals.end())
+      return false;
+    operand = pos->second;
+    return true;
+  }
+
+  bool FindRegister(llvm::StringRef name, Operand &operand) override {
+    return false;
+  }
+
+  bool Evaluate(const AgentExpression &expr, uint64_t &result) {
+    return expr
+        .Evaluate([](uint32_t reg_num, uint64_t &value) { return false; },
+                  [this](addr_t addr, size_t size, uint64_t &value) {
+                    auto pos = memory.find(addr);
+                    if (pos == memory.end())
+                      return false;
+                    value = pos->second;
+                    return true;
+                  },
+                  result)
+        .Success();
+  }
+};
+} // namespace
+
+TEST(GDBRemoteConditionCompilerTest, Global) {
+  FakeScope scope;
+  scope.globals["count"] = MakeMemory(0x1000);
+  scope.memory[0x1000] = 5;
+
+  AgentExpression expr;
+  ASSERT_TRUE(GDBRemoteConditionCompiler::Compile("count == 5", scope, expr));
+  uint64_t result = 0;
+  ASSERT_TRUE(scope.Evaluate(expr, result));
+  EXPECT_EQ(1u, result);
+}
+
+TEST(GDBRemoteConditionCompilerTest, LocalShadowsGlobal) {
+  FakeScope scope;
+  scope.has_implicit_scope = true;
+  scope.locals["count"] = MakeMemory(0x2000);
+  scope.globals["count"] = MakeMemory(0x1000);
+  scope.memory[0x1000] = 5;
+  scope.memory[0x2000] = 7;
+
+  AgentExpression expr;
+  ASSERT_TRUE(GDBRemoteConditionCompiler::Compile("count == 7", scope, expr));
+  uint64_t result = 0;
+  ASSERT_TRUE(scope.Evaluate(expr, result));
+  EXPECT_EQ(1u, result);
+}
+
+TEST(GDBRemoteConditionCompilerTest, MemberMayShadowGlobal) {
+  // In a method "count" could be this->count, which we can't see, so the
+  // global must not be used.
+  FakeScope scope;
+  scope.has_implicit_scope = true;
+  scope.globals["count"] = MakeMemory(0x1000);
+  scope.locals["index"] = MakeMemory(0x2000);
+
+  AgentExpression expr;
+  EXPECT_FALSE(GDBRemoteConditionCompiler::Compile("count == 5", scope, expr));
+  EXPECT_FALSE(
+      GDBRemoteConditionCompiler::Compile("index == 1 && count", scope, expr));
+  EXPECT_TRUE(GDBRemoteConditionCompiler::Compile("index == 1", scope, expr));
+}
+
+TEST(GDBRemoteConditionCompilerTest, InvalidLocalIsNotGlobal) {
+  // A local we can't read must not fall back to a global of the same name.
+  FakeScope scope;
+  scope.locals["count"] = Operand();
+  scope.globals["count"] = MakeMemory(0x1000);
+
+  AgentExpression expr;
+  EXPECT_FALSE(GDBRemoteConditionCompiler::Compile("count == 5", scope, expr));
+}
@@ -20,6 +20,7 @@
 
 #include "lldb/Core/ArchSpec.h"
 #include "lldb/Target/MemoryRegionInfo.h"
+#include "lldb/Utility/DataBufferHeap.h"
 #include "lldb/Utility/DataBufferLLVM.h"
 #include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/FileSpec.h"
@@ -52,6 +53,15 @@ public:
     ASSERT_GT(parser->GetData().size(), 0UL);
   }
 
+  void SetUpBytes(const std::vector<uint8_t> &bytes) {
+    lldb::DataBufferSP data_sp(
+        new DataBufferHeap(bytes.data(), bytes.size()));
+    llvm::Optional<MinidumpParser> optional_parser =
+        MinidumpParser::Create(data_sp);
+    ASSERT_TRUE(optional_parser.hasValue());
+    parser.reset(new MinidumpParser(optional_parser.getValue()));
+  }
+
   std::unique_ptr<MinidumpParser> parser;
 };
 
@@ -210,6 +220,64 @@ TEST_F(MinidumpParserTest, FindMemoryRangeWithFullMemoryMinidump) {
   EXPECT_FALSE(parser->FindMemoryRange(0x7ffe0000 + 4096).hasValue());
 }
 
+static void append_le(std::vector<uint8_t> &bytes, uint64_t value,
+                      size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+TEST_F(MinidumpParserTest, FindMemoryRangeOverlapping) {
+  // A Memory64List range 0x1000-0x3000, and a MemoryList copy of
+  // 0x2100-0x2200 inside it.
+  const uint32_t directory_rva = 32;
+  const uint32_t memory_list_rva = directory_rva + 2 * 12;
+  const uint32_t memory64_list_rva = memory_list_rva + 4 + 16;
+  const uint32_t memory64_data_rva = memory64_list_rva + 8 + 8 + 16;
+  const uint32_t memory_data_rva = memory64_data_rva + 0x2000;
+
+  std::vector<uint8_t> bytes;
+  append_le(bytes, 0x504d444d, 4); // signature
+  append_le(bytes, 0xa793, 4);     // version
+  append_le(bytes, 2, 4);          // streams_count
+  append_le(bytes, directory_rva, 4);
+  append_le(bytes, 0, 4);          // checksum
+  append_le(bytes, 0, 4);          // time_date_stamp
+  append_le(bytes, 0, 8);          // flags
+
+  append_le(bytes, 5, 4); // MemoryList
+  append_le(bytes, 4 + 16, 4);
+  append_le(bytes, memory_list_rva, 4);
+  append_le(bytes, 9, 4); // Memory64List
+  append_le(bytes, 8 + 8 + 16, 4);
+  append_le(bytes, memory64_list_rva, 4);
+
+  append_le(bytes, 1, 4);
+  append_le(bytes, 0x2100, 8);
+  append_le(bytes, 0x100, 4);
+  append_le(bytes, memory_data_rva, 4);
+
+  append_le(bytes, 1, 8);
+  append_le(bytes, memory64_data_rva, 8);
+  append_le(bytes, 0x1000, 8);
+  append_le(bytes, 0x2000, 8);
+
+  bytes.resize(memory_data_rva + 0x100);
+  SetUpBytes(bytes);
+
+  check_mem_range_exists(parser, 0x1000, 0x2000);
+  // The smaller range starts between 0x1000 and these addresses, but they
+  // are still inside the large one.
+  llvm::Optional<minidump::Range> range = parser->FindMemoryRange(0x2800);
+  ASSERT_TRUE(range.hasValue());
+  EXPECT_EQ(0x1000u, range->start);
+  range = parser->FindMemoryRange(0x2150);
+  ASSERT_TRUE(range.hasValue());
+  EXPECT_EQ(0x1000u, range->start);
+  EXPECT_EQ(0x2000UL, parser->GetMemory(0x1000, 0x2000).size());
+  EXPECT_EQ(0xe00UL, parser->GetMemory(0x2200, 0x1000).size());
+  EXPECT_FALSE(parser->FindMemoryRange(0x3000).hasValue());
+}
+
 void check_region_info(std::unique_ptr<MinidumpParser> &parser,
                        const uint64_t addr, MemoryRegionInfo::OptionalBool read,
                        MemoryRegionInfo::OptionalBool write,
@@ -235,6 +303,28 @@ TEST_F(MinidumpParserTest, GetMemoryRegionInfo) {
   check_region_info(parser, 0x40000, yes, no, no);
 }
 
+TEST_F(MinidumpParserTest, GetMemoryRegionInfoFromMemoryList) {
+  SetUpData("linux-x86_64.dmp");
+
+  const auto yes = MemoryRegionInfo::eYes;
+  const auto dont_know = MemoryRegionInfo::eDontKnow;
+
+  // There is no MemoryInfoList stream, so the regions come from the captured
+  // memory ranges. Code pages are usually not captured, so nothing is known
+  // about the gaps between the ranges.
+  check_region_info(parser, 0x401d46, yes, dont_know, dont_know);
+  check_region_info(parser, 0x401d46 + 0x100, dont_know, dont_know,
+                    dont_know);
+  check_region_info(parser, 0x7ffceb34a000, yes, dont_know, dont_know);
+  check_region_info(parser, 0x7ffceb34a000 + 12288, dont_know, dont_know,
+                    dont_know);
+
+  auto range_info = parser->GetMemoryRegionInfo(0x401d46 + 0x100);
+  ASSERT_TRUE(range_info.hasValue());
+  EXPECT_EQ(dont_know, range_info->GetMapped());
+  EXPECT_EQ(0x7ffceb34a000u, range_info->GetRange().GetRangeEnd());
+}
+
 // Windows Minidump tests
 // fizzbuzz_no_heap.dmp is copied from the WinMiniDump tests
 TEST_F(MinidumpParserTest, GetArchitectureWindows) {
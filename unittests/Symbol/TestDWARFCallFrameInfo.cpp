@@ -39,7 +39,8 @@ public:
   }
 
 protected:
-  void TestBasic(DWARFCallFrameInfo::Type type, llvm::StringRef symbol);
+  void TestBasic(DWARFCallFrameInfo::Type type, llvm::StringRef symbol,
+                 bool use_eh_frame_hdr = false);
 };
 
 #define ASSERT_NO_ERROR(x)                                                     \
@@ -88,7 +89,8 @@ static UnwindPlan::Row GetExpectedRow2() {
 }
 
 void DWARFCallFrameInfoTest::TestBasic(DWARFCallFrameInfo::Type type,
-                                       llvm::StringRef symbol) {
+                                       llvm::StringRef symbol,
+                                       bool use_eh_frame_hdr) {
   std::string yaml = GetInputFilePath("basic-call-frame-info.yaml");
   llvm::SmallString<128> obj;
 
@@ -116,6 +118,11 @@ void DWARFCallFrameInfoTest::TestBasic(DWARFCallFrameInfo::Type type,
   ASSERT_NE(nullptr, section_sp);
 
   DWARFCallFrameInfo cfi(*module_sp->GetObjectFile(), section_sp, type);
+  if (use_eh_frame_hdr) {
+    auto hdr_section_sp = list->FindSectionByName(ConstString(".eh_frame_hdr"));
+    ASSERT_NE(nullptr, hdr_section_sp);
+    cfi.SetEHFrameHdrSection(hdr_section_sp);
+  }
 
   const Symbol *sym = module_sp->FindFirstSymbolWithNameAndType(
       ConstString(symbol), eSymbolTypeAny);
@@ -127,6 +134,12 @@ void DWARFCallFrameInfoTest::TestBasic(DWARFCallFrameInfo::Type type,
   EXPECT_EQ(GetExpectedRow0(), *plan.GetRowAtIndex(0));
   EXPECT_EQ(GetExpectedRow1(), *plan.GetRowAtIndex(1));
   EXPECT_EQ(GetExpectedRow2(), *plan.GetRowAtIndex(2));
+
+  AddressRange range;
+  ASSERT_TRUE(cfi.GetAddressRange(sym->GetAddress(), range));
+  EXPECT_EQ(sym->GetAddressRef().GetFileAddress(),
+            range.GetBaseAddress().GetFileAddress());
+  EXPECT_EQ(0xcu, range.GetByteSize());
 }
 
 TEST_F(DWARFCallFrameInfoTest, Basic_dwarf3) {
@@ -140,3 +153,7 @@ TEST_F(DWARFCallFrameInfoTest, Basic_dwarf4) {
 TEST_F(DWARFCallFrameInfoTest, Basic_eh) {
   TestBasic(DWARFCallFrameInfo::EH, "eh_frame");
 }
+
+TEST_F(DWARFCallFrameInfoTest, Basic_eh_frame_hdr) {
+  TestBasic(DWARFCallFrameInfo::EH, "eh_frame", /*use_eh_frame_hdr*/ true);
+}
@@ -0,0 +1,178 @@
+//===-- AgentExpressionTest.cpp ---------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Utility/AgentExpression.h"
+#include "gtest/gtest.h"
+
+#include <map>
+
+using namespace lldb_private;
+using namespace lldb;
+
+namespace {
+struct FakeTarget {
+  std::map<uint32_t, uint64_t> registers;
+  std::map<addr_t, uint64_t> memory;
+
+  Status Evaluate(const AgentExpression &expr, uint64_t &result) {
+    return expr.Evaluate(
+        [this](uint32_t reg_num, uint64_t &value) {
+          auto pos = registers.find(reg_num);
+          if (pos == registers.end())
+            return false;
+          value = pos->second;
+          return true;
+        },
+        [this](addr_t addr, size_t size, uint64_t &value) {
+          auto pos = memory.find(addr);
+          if (pos == memory.end())
+            return false;
+          value = size < 8 ? pos->second & ((1ULL << (size * 8)) - 1)
+                           : pos->second;
+          return true;
+        },
+        result);
+  }
+};
+} // namespace
+
+TEST(AgentExpressionTest, Constants) {
+  FakeTarget target;
+  for (uint64_t value : {0ULL, 0xffULL, 0x1234ULL, 0x12345678ULL,
+                         0x123456789abcdef0ULL, ~0ULL}) {
+    AgentExpression expr;
+    expr.AppendConstant(value);
+    expr.AppendOpcode(AgentExpression::eOpEnd);
+    ASSERT_TRUE(expr.Validate().Success());
+
+    uint64_t result = 0;
+    ASSERT_TRUE(target.Evaluate(expr, result).Success());
+    EXPECT_EQ(value, result);
+  }
+}
+
+TEST(AgentExpressionTest, RegisterAndMemory) {
+  FakeTarget target;
+  target.registers[6] = 0x1000;
+  target.memory[0x0ff8] = 0xfffffff6; // -10 as an int32_t
+
+  // *(int32_t *)($reg6 - 8) < 0
+  AgentExpression expr;
+  expr.AppendRegister(6);
+  expr.AppendConstant(8);
+  expr.AppendOpcode(AgentExpression::eOpSub);
+  ASSERT_TRUE(expr.AppendReference(4));
+  expr.AppendExtend(32, true);
+  expr.AppendConstant(0);
+  expr.AppendOpcode(AgentExpression::eOpLessSigned);
+  expr.AppendOpcode(AgentExpression::eOpEnd);
+  ASSERT_TRUE(expr.Validate().Success());
+
+  uint64_t result = 0;
+  ASSERT_TRUE(target.Evaluate(expr, result).Success());
+  EXPECT_EQ(1u, result);
+
+  target.memory[0x0ff8] = 10;
+  ASSERT_TRUE(target.Evaluate(expr, result).Success());
+  EXPECT_EQ(0u, result);
+
+  target.memory.clear();
+  EXPECT_TRUE(target.Evaluate(expr, result).Fail());
+}
+
+TEST(AgentExpressionTest, Goto) {
+  FakeTarget target;
+  target.registers[0] = 0;
+
+  // $reg0 ? 1 : 2
+  AgentExpression expr;
+  expr.AppendRegister(0);
+  const size_t true_patch = expr.AppendGoto(AgentExpression::eOpIfGoto);
+  expr.AppendConstant(2);
+  const size_t end_patch = expr.AppendGoto(AgentExpression::eOpGoto);
+  expr.PatchGoto(true_patch, expr.GetSize());
+  expr.AppendConstant(1);
+  expr.PatchGoto(end_patch, expr.GetSize());
+  expr.AppendOpcode(AgentExpression::eOpEnd);
+  ASSERT_TRUE(expr.Validate().Success());
+
+  uint64_t result = 0;
+  ASSERT_TRUE(target.Evaluate(expr, result).Success());
+  EXPECT_EQ(2u, result);
+
+  target.registers[0] = 5;
+  ASSERT_TRUE(target.Evaluate(expr, result).Success());
+  EXPECT_EQ(1u, result);
+}
+
+TEST(AgentExpressionTest, Arithmetic) {
+  FakeTarget target;
+  auto evaluate = [&target](uint64_t a, uint64_t b,
+                            AgentExpression::Opcode op) {
+    AgentExpression expr;
+    expr.AppendConstant(a);
+    expr.AppendConstant(b);
+    expr.AppendOpcode(op);
+    expr.AppendOpcode(AgentExpression::eOpEnd);
+    uint64_t result = 0;
+    EXPECT_TRUE(target.Evaluate(expr, result).Success());
+    return result;
+  };
+
+  EXPECT_EQ(7u, evaluate(3, 4, AgentExpression::eOpAdd));
+  EXPECT_EQ(~0ULL, evaluate(3, 4, AgentExpression::eOpSub));
+  EXPECT_EQ(12u, evaluate(3, 4, AgentExpression::eOpMul));
+  EXPECT_EQ(~0ULL, evaluate(-7, 4, AgentExpression::eOpDivSigned));
+  EXPECT_EQ(~2ULL, evaluate(-7, 4, AgentExpression::eOpRemSigned));
+  EXPECT_EQ(1ULL << 63,
+            evaluate(1ULL << 63, -1, AgentExpression::eOpDivSigned));
+  EXPECT_EQ(1u, evaluate(-1, 0, AgentExpression::eOpLessSigned));
+  EXPECT_EQ(0u, evaluate(-1, 0, AgentExpression::eOpLessUnsigned));
+  EXPECT_EQ(~0ULL, evaluate(-8, 3, AgentExpression::eOpRshSigned));
+  EXPECT_EQ(0u, evaluate(1, 64, AgentExpression::eOpLsh));
+  EXPECT_EQ(1u, evaluate(5, 5, AgentExpression::eOpEqual));
+}
+
+TEST(AgentExpressionTest, Errors) {
+  FakeTarget target;
+  uint64_t result = 0;
+
+  // Division by zero.
+  AgentExpression div_zero;
+  div_zero.AppendConstant(1);
+  div_zero.AppendConstant(0);
+  div_zero.AppendOpcode(AgentExpression::eOpDivUnsigned);
+  div_zero.AppendOpcode(AgentExpression::eOpEnd);
+  EXPECT_TRUE(div_zero.Validate().Success());
+  EXPECT_TRUE(target.Evaluate(div_zero, result).Fail());
+
+  // Stack underflow.
+  AgentExpression underflow;
+  underflow.AppendOpcode(AgentExpression::eOpAdd);
+  underflow.AppendOpcode(AgentExpression::eOpEnd);
+  EXPECT_TRUE(target.Evaluate(underflow, result).Fail());
+
+  // Infinite loop.
+  AgentExpression loop;
+  loop.PatchGoto(loop.AppendGoto(AgentExpression::eOpGoto), 0);
+  EXPECT_TRUE(loop.Validate().Success());
+  EXPECT_TRUE(target.Evaluate(loop, result).Fail());
+
+  // Unsupported opcode (float) and a truncated constant.
+  const uint8_t float_op[] = {0x01, AgentExpression::eOpEnd};
+  EXPECT_TRUE(AgentExpression(float_op).Validate().Fail());
+  const uint8_t truncated[] = {AgentExpression::eOpConst32, 0x00, 0x01};
+  EXPECT_TRUE(AgentExpression(truncated).Validate().Fail());
+
+  // Jump into the middle of an instruction.
+  AgentExpression bad_jump;
+  bad_jump.AppendConstant(0x1234);
+  bad_jump.PatchGoto(bad_jump.AppendGoto(AgentExpression::eOpGoto), 1);
+  EXPECT_TRUE(bad_jump.Validate().Fail());
+}